@@ -0,0 +1,446 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+
+
+namespace bcpp::benchmark
+{
+
+    //=========================================================================
+    // state
+    //
+    // passed to each benchmark function.  the function runs the measured
+    // code once per iteration of the range based for loop:
+    //
+    //      for (auto _ : state)
+    //          do_work();
+    //
+    // in the style of google benchmark.  setup inside the loop can be
+    // excluded with pause_timing()/resume_timing() and benchmarks which
+    // measure themselves can report the time with set_iteration_time().
+    //=========================================================================
+    class state
+    {
+    public:
+
+        struct value
+        {
+            ~value() {}     // non trivial so that unused loop variables do not warn
+        };
+
+        struct iterator
+        {
+            std::int64_t remaining_;
+            state * state_;
+
+            value operator * () const {return {};}
+            iterator & operator ++ () {--remaining_; return *this;}
+            bool operator != (iterator const &)
+            {
+                if (remaining_ > 0)
+                    return true;
+                state_->finish();
+                return false;
+            }
+        };
+
+        state
+        (
+            std::int64_t iterations,
+            std::vector<std::int64_t> arguments
+        ):
+            iterations_(iterations),
+            arguments_(std::move(arguments))
+        {
+        }
+
+        iterator begin()
+        {
+            start();
+            return {iterations_, this};
+        }
+
+        iterator end()
+        {
+            return {0, this};
+        }
+
+        std::int64_t range
+        (
+            std::size_t index
+        ) const
+        {
+            return arguments_.at(index);
+        }
+
+        std::int64_t iterations() const {return iterations_;}
+
+        void pause_timing()
+        {
+            realElapsed_ += (std::chrono::steady_clock::now() - realStart_);
+            cpuElapsed_ += (cpu_now() - cpuStart_);
+        }
+
+        void resume_timing()
+        {
+            start();
+        }
+
+        void set_iteration_time
+        (
+            // manual timing: elapsed time of one iteration
+            std::chrono::nanoseconds elapsed
+        )
+        {
+            manualTime_ += elapsed;
+            useManualTime_ = true;
+        }
+
+        void set_label
+        (
+            std::string label
+        )
+        {
+            label_ = std::move(label);
+        }
+
+        void skip_with_error
+        (
+            std::string error
+        )
+        {
+            error_ = std::move(error);
+            iterations_ = 0;
+        }
+
+        void set_bytes_processed
+        (
+            std::int64_t bytes
+        )
+        {
+            bytesProcessed_ = bytes;
+        }
+
+        double & counter
+        (
+            std::string const & name
+        )
+        {
+            return counters_[name];
+        }
+
+    private:
+
+        friend class registry;
+
+        static std::chrono::nanoseconds cpu_now()
+        {
+            timespec ts;
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+        }
+
+        void start()
+        {
+            cpuStart_ = cpu_now();
+            realStart_ = std::chrono::steady_clock::now();
+        }
+
+        void finish()
+        {
+            if (!finished_)
+                pause_timing();
+            finished_ = true;
+        }
+
+        std::int64_t                                iterations_;
+        std::vector<std::int64_t>                   arguments_;
+        std::chrono::steady_clock::time_point       realStart_;
+        std::chrono::nanoseconds                    cpuStart_{0};
+        std::chrono::nanoseconds                    realElapsed_{0};
+        std::chrono::nanoseconds                    cpuElapsed_{0};
+        std::chrono::nanoseconds                    manualTime_{0};
+        bool                                        useManualTime_{false};
+        bool                                        finished_{false};
+        std::string                                 label_;
+        std::string                                 error_;
+        std::int64_t                                bytesProcessed_{0};
+        std::map<std::string, double>               counters_;
+    }; // class state
+
+
+    //=========================================================================
+    // registry
+    //
+    // holds the registered benchmarks, runs them (scaling the iteration
+    // count until each run lasts at least the minimum time) and reports the
+    // results either as a console table or as google benchmark compatible
+    // json so results can be compared across releases with existing tools.
+    //=========================================================================
+    class registry
+    {
+    public:
+
+        using function = std::function<void(state &)>;
+
+        enum class output_format
+        {
+            console,
+            json
+        };
+
+        struct configuration
+        {
+            std::string                 filter_{".*"};
+            std::chrono::nanoseconds    minimumTime_{std::chrono::milliseconds(200)};
+            std::int64_t                maximumIterations_{1'000'000'000};
+            output_format               outputFormat_{output_format::console};
+        };
+
+        static registry & instance()
+        {
+            static registry instance;
+            return instance;
+        }
+
+        void add
+        (
+            std::string name,
+            function benchmark,
+            std::vector<std::vector<std::int64_t>> argumentSets = {{}},
+            std::int64_t fixedIterations = 0
+        )
+        {
+            for (auto & arguments : argumentSets)
+            {
+                auto fullName = name;
+                for (auto argument : arguments)
+                {
+                    fullName += '/';
+                    fullName += std::to_string(argument);
+                }
+                benchmarks_.push_back({fullName, benchmark, arguments, fixedIterations});
+            }
+        }
+
+        int run
+        (
+            configuration const & config,
+            std::ostream & stream
+        )
+        {
+            std::regex filter(config.filter_);
+            std::vector<result> results;
+            for (auto const & benchmark : benchmarks_)
+            {
+                if (!std::regex_search(benchmark.name_, filter))
+                    continue;
+                auto r = run(benchmark, config);
+                if (config.outputFormat_ == output_format::console)
+                    print_console(stream, r, results.empty());
+                else
+                    std::cerr << "ran " << r.name_ << "\n";
+                results.push_back(std::move(r));
+            }
+            if (config.outputFormat_ == output_format::json)
+                print_json(stream, results);
+            return 0;
+        }
+
+    private:
+
+        struct entry
+        {
+            std::string                 name_;
+            function                    function_;
+            std::vector<std::int64_t>   arguments_;
+            std::int64_t                fixedIterations_;
+        };
+
+        struct result
+        {
+            std::string                     name_;
+            std::int64_t                    iterations_;
+            double                          realTime_;      // nanoseconds per iteration
+            double                          cpuTime_;       // nanoseconds per iteration
+            double                          bytesPerSecond_;
+            std::string                     label_;
+            std::string                     error_;
+            std::map<std::string, double>   counters_;
+        };
+
+        result run
+        (
+            entry const & benchmark,
+            configuration const & config
+        )
+        {
+            std::int64_t iterations = (benchmark.fixedIterations_ > 0) ? benchmark.fixedIterations_ : 1;
+            while (true)
+            {
+                state s(iterations, benchmark.arguments_);
+                benchmark.function_(s);
+                auto elapsed = s.useManualTime_ ? s.manualTime_ : s.realElapsed_;
+                if ((!s.error_.empty()) || (benchmark.fixedIterations_ > 0) || (elapsed >= config.minimumTime_) || (iterations >= config.maximumIterations_))
+                {
+                    result r{benchmark.name_, iterations, 0, 0, 0, s.label_, s.error_, s.counters_};
+                    if (iterations > 0)
+                    {
+                        r.realTime_ = static_cast<double>(elapsed.count()) / iterations;
+                        r.cpuTime_ = static_cast<double>(s.cpuElapsed_.count()) / iterations;
+                        if ((s.bytesProcessed_ > 0) && (elapsed.count() > 0))
+                            r.bytesPerSecond_ = (s.bytesProcessed_ * 1e9) / elapsed.count();
+                    }
+                    return r;
+                }
+                // grow towards the minimum time, at most 10x per step
+                auto ratio = (elapsed.count() > 0) ? (1.4 * config.minimumTime_.count() / elapsed.count()) : 10.0;
+                iterations = std::min<std::int64_t>(config.maximumIterations_, std::max<std::int64_t>(iterations + 1, iterations * std::min(ratio, 10.0)));
+            }
+        }
+
+        static void print_console
+        (
+            std::ostream & stream,
+            result const & r,
+            bool printHeader
+        )
+        {
+            if (printHeader)
+                stream << std::left << std::setw(64) << "Benchmark" << std::right << std::setw(16) << "Time" << std::setw(16) << "CPU" << std::setw(14) << "Iterations" << "\n"
+                        << std::string(110, '-') << "\n";
+            stream << std::left << std::setw(64) << r.name_ << std::right;
+            if (!r.error_.empty())
+            {
+                stream << " ERROR: " << r.error_ << "\n";
+                return;
+            }
+            stream << std::fixed << std::setprecision(1)
+                    << std::setw(13) << r.realTime_ << " ns" << std::setw(13) << r.cpuTime_ << " ns" << std::setw(14) << r.iterations_;
+            if (r.bytesPerSecond_ > 0)
+                stream << " " << std::setprecision(2) << (r.bytesPerSecond_ / (1ull << 30)) << "GiB/s";
+            for (auto const & [name, value] : r.counters_)
+                stream << " " << name << "=" << value;
+            if (!r.label_.empty())
+                stream << " " << r.label_;
+            stream << "\n";
+        }
+
+        static std::string escape
+        (
+            std::string const & value
+        )
+        {
+            std::string escaped;
+            for (auto c : value)
+            {
+                if ((c == '"') || (c == '\\'))
+                    escaped += '\\';
+                escaped += c;
+            }
+            return escaped;
+        }
+
+        static void print_json
+        (
+            std::ostream & stream,
+            std::vector<result> const & results
+        )
+        {
+            char hostName[256] = {};
+            ::gethostname(hostName, sizeof(hostName) - 1);
+            auto now = std::time(nullptr);
+            char date[64] = {};
+            std::strftime(date, sizeof(date), "%FT%T%z", std::localtime(&now));
+
+            stream << "{\n  \"context\": {\n"
+                    << "    \"date\": \"" << date << "\",\n"
+                    << "    \"host_name\": \"" << escape(hostName) << "\",\n"
+                    << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+                    #ifdef NDEBUG
+                    << "    \"library_build_type\": \"release\"\n"
+                    #else
+                    << "    \"library_build_type\": \"debug\"\n"
+                    #endif
+                    << "  },\n  \"benchmarks\": [";
+            auto first = true;
+            for (auto const & r : results)
+            {
+                stream << (first ? "\n" : ",\n") << "    {\n"
+                        << "      \"name\": \"" << escape(r.name_) << "\",\n"
+                        << "      \"run_name\": \"" << escape(r.name_) << "\",\n"
+                        << "      \"run_type\": \"iteration\",\n";
+                if (!r.error_.empty())
+                    stream << "      \"error_occurred\": true,\n"
+                            << "      \"error_message\": \"" << escape(r.error_) << "\",\n";
+                stream << std::setprecision(17)
+                        << "      \"iterations\": " << r.iterations_ << ",\n"
+                        << "      \"real_time\": " << r.realTime_ << ",\n"
+                        << "      \"cpu_time\": " << r.cpuTime_ << ",\n";
+                if (r.bytesPerSecond_ > 0)
+                    stream << "      \"bytes_per_second\": " << r.bytesPerSecond_ << ",\n";
+                for (auto const & [name, value] : r.counters_)
+                    stream << "      \"" << escape(name) << "\": " << value << ",\n";
+                if (!r.label_.empty())
+                    stream << "      \"label\": \"" << escape(r.label_) << "\",\n";
+                stream << "      \"time_unit\": \"ns\"\n    }";
+                first = false;
+            }
+            stream << "\n  ]\n}\n";
+        }
+
+        std::vector<entry> benchmarks_;
+    }; // class registry
+
+
+    //=========================================================================
+    // static registration helper
+    //=========================================================================
+    struct registrar
+    {
+        registrar
+        (
+            std::string name,
+            registry::function benchmark,
+            std::vector<std::vector<std::int64_t>> argumentSets = {{}},
+            std::int64_t fixedIterations = 0
+        )
+        {
+            registry::instance().add(std::move(name), std::move(benchmark), std::move(argumentSets), fixedIterations);
+        }
+    };
+
+
+    //=========================================================================
+    template <typename T>
+    inline void do_not_optimize
+    (
+        T const & value
+    )
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+
+    //=========================================================================
+    inline void clobber_memory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+} // namespace bcpp::benchmark
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <library/system.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+
+namespace bcpp::benchmark
+{
+
+    //=========================================================================
+    // restores the calling thread's affinity mask on destruction
+    //=========================================================================
+    class affinity_guard
+    {
+    public:
+
+        affinity_guard()
+        {
+            CPU_ZERO(&cpuSet_);
+            ::pthread_getaffinity_np(::pthread_self(), sizeof(cpuSet_), &cpuSet_);
+        }
+
+        ~affinity_guard()
+        {
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuSet_), &cpuSet_);
+        }
+
+        affinity_guard(affinity_guard const &) = delete;
+        affinity_guard & operator = (affinity_guard const &) = delete;
+
+    private:
+
+        cpu_set_t cpuSet_;
+    };
+
+
+    //=========================================================================
+    inline std::vector<std::vector<std::int64_t>> cpu_pairs
+    (
+        // the first available cpu paired with every other available cpu
+        // (or with itself when only one cpu is available)
+    )
+    {
+        auto cpus = system::get_available_cpus();
+        std::vector<std::vector<std::int64_t>> pairs;
+        if (cpus.empty())
+            return {{0, 0}};
+        for (std::size_t i = 1; i < cpus.size(); ++i)
+            pairs.push_back({static_cast<std::int64_t>(cpus[0]), static_cast<std::int64_t>(cpus[i])});
+        if (pairs.empty())
+            pairs.push_back({static_cast<std::int64_t>(cpus[0]), static_cast<std::int64_t>(cpus[0])});
+        return pairs;
+    }
+
+} // namespace bcpp::benchmark
@@ -0,0 +1,59 @@
+#include "./benchmark.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    using bcpp::benchmark::registry;
+
+    registry::configuration config;
+    std::string outputPath;
+    auto outputFormat = registry::output_format::json;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        std::string arg = args[i];
+        auto value = arg.substr(arg.find('=') + 1);
+        if (arg.starts_with("--benchmark_filter="))
+            config.filter_ = value;
+        else if (arg.starts_with("--benchmark_min_time="))
+            config.minimumTime_ = std::chrono::nanoseconds(static_cast<std::int64_t>(std::stod(value) * 1e9));
+        else if (arg.starts_with("--benchmark_format="))
+            config.outputFormat_ = (value == "json") ? registry::output_format::json : registry::output_format::console;
+        else if (arg.starts_with("--benchmark_out="))
+            outputPath = value;
+        else if (arg.starts_with("--benchmark_out_format="))
+            outputFormat = (value == "json") ? registry::output_format::json : registry::output_format::console;
+        else
+        {
+            std::cout << "usage: " << args[0] << "\n"
+                    << "  [--benchmark_filter=<regex>]\n"
+                    << "  [--benchmark_min_time=<seconds>]\n"
+                    << "  [--benchmark_format=<console|json>]\n"
+                    << "  [--benchmark_out=<file>]\n"
+                    << "  [--benchmark_out_format=<console|json>]\n";
+            return (arg == "--help") ? 0 : 1;
+        }
+    }
+
+    if (outputPath.empty())
+        return registry::instance().run(config, std::cout);
+
+    // results to file (json by default) and progress to the console
+    std::ofstream outputFile(outputPath);
+    if (!outputFile)
+    {
+        std::cerr << "failed to open " << outputPath << "\n";
+        return 1;
+    }
+    config.outputFormat_ = outputFormat;
+    return registry::instance().run(config, outputFile);
+}
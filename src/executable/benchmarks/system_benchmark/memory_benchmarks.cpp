@@ -0,0 +1,223 @@
+#include "./benchmark.h"
+#include "./benchmark_utility.h"
+
+#include <library/system.h>
+#include <library/system/memory/anonymous_mapping.h>
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    using namespace bcpp::system;
+    using bcpp::benchmark::state;
+    using bcpp::benchmark::registrar;
+
+    std::size_t constexpr page_size = 4096;
+
+    std::vector<std::vector<std::int64_t>> const mapping_arguments
+    {
+        // size, alignment
+        {4 << 10, 0}, {4 << 10, 1024}, {4 << 10, 2 << 20},
+        {64 << 10, 0}, {64 << 10, 1024}, {64 << 10, 2 << 20},
+        {2 << 20, 0}, {2 << 20, 1024}, {2 << 20, 2 << 20},
+        {64 << 20, 0}, {64 << 20, 1024}, {64 << 20, 2 << 20}
+    };
+
+
+    //=========================================================================
+    void anonymous_mapping_create_destroy
+    (
+        state & s,
+        std::size_t mmapFlags,
+        bool touch
+    )
+    {
+        auto size = static_cast<std::size_t>(s.range(0));
+        auto alignment = static_cast<std::size_t>(s.range(1));
+        for (auto _ : s)
+        {
+            anonymous_mapping mapping({.size_ = size, .mmapFlags_ = (MAP_PRIVATE | MAP_ANONYMOUS | mmapFlags), .alignment_ = alignment}, {});
+            if (!mapping.is_valid())
+            {
+                s.skip_with_error((mmapFlags & MAP_HUGETLB) ? "mmap(MAP_HUGETLB) failed - are huge pages reserved?" : "mmap failed");
+                return;
+            }
+            if (touch)
+                for (std::size_t offset = 0; offset < size; offset += page_size)
+                    mapping.data()[offset] = std::byte{1};
+            bcpp::benchmark::do_not_optimize(mapping.data());
+        }
+        if (touch)
+            s.set_bytes_processed(s.iterations() * size);
+    }
+
+    registrar r0("anonymous_mapping/create_destroy", [](auto & s){anonymous_mapping_create_destroy(s, 0, false);}, mapping_arguments);
+    registrar r1("anonymous_mapping/create_touch_destroy", [](auto & s){anonymous_mapping_create_destroy(s, 0, true);}, mapping_arguments);
+    registrar r2("anonymous_mapping/prefault_create_destroy", [](auto & s){anonymous_mapping_create_destroy(s, MAP_POPULATE, false);}, mapping_arguments);
+    registrar r3("anonymous_mapping/prefault_create_touch_destroy", [](auto & s){anonymous_mapping_create_destroy(s, MAP_POPULATE, true);}, mapping_arguments);
+    registrar r4("anonymous_mapping/huge_page_create_touch_destroy", [](auto & s){anonymous_mapping_create_destroy(s, MAP_HUGETLB, true);},
+            {{2 << 20, 0}, {2 << 20, 2 << 20}, {64 << 20, 0}, {64 << 20, 2 << 20}});
+    registrar r5("anonymous_mapping/huge_page_prefault_create_touch_destroy", [](auto & s){anonymous_mapping_create_destroy(s, MAP_HUGETLB | MAP_POPULATE, true);},
+            {{2 << 20, 0}, {2 << 20, 2 << 20}, {64 << 20, 0}, {64 << 20, 2 << 20}});
+
+
+    //=========================================================================
+    void shared_memory_create_destroy
+    (
+        state & s
+    )
+    {
+        auto size = static_cast<std::size_t>(s.range(0));
+        for (auto _ : s)
+        {
+            auto sharedMemory = shared_memory::create({.path_ = "", .size_ = size, .ioMode_ = io_mode::read_write, .unlinkPolicy_ = shared_memory::unlink_policy::on_detach}, {});
+            if (!sharedMemory.is_valid())
+            {
+                s.skip_with_error("shared_memory::create failed");
+                return;
+            }
+            bcpp::benchmark::do_not_optimize(sharedMemory.data());
+        }
+    }
+
+    registrar r6("shared_memory/create_destroy", shared_memory_create_destroy, {{4 << 10}, {2 << 20}, {64 << 20}});
+
+
+    //=========================================================================
+    void shared_memory_ping_pong
+    (
+        // round trip latency between this process (pinned to the first cpu)
+        // and a child process (pinned to the second cpu) over two cache lines
+        // of a shared_memory segment which the child joins by path.
+        state & s
+    )
+    {
+        struct alignas(cache_line_size) line
+        {
+            std::atomic<std::uint64_t> value_;
+        };
+        static std::uint64_t constexpr stop = ~0ull;
+
+        auto pingCpu = static_cast<cpu_id>(s.range(0));
+        auto pongCpu = static_cast<cpu_id>(s.range(1));
+        auto sharedMemory = shared_memory::create({.path_ = "", .size_ = 4096, .ioMode_ = io_mode::read_write, .unlinkPolicy_ = shared_memory::unlink_policy::on_detach}, {});
+        if (!sharedMemory.is_valid())
+        {
+            s.skip_with_error("shared_memory::create failed");
+            return;
+        }
+        auto & ping = *new (sharedMemory.data()) line{0};
+        auto & pong = *new (sharedMemory.data() + (2 * cache_line_size)) line{0};
+        auto spinWithYield = (pingCpu == pongCpu);
+
+        auto childProcessId = ::fork();
+        if (childProcessId == 0)
+        {
+            set_cpu_affinity(pongCpu);
+            auto joined = shared_memory::join({.path_ = sharedMemory.path(), .ioMode_ = io_mode::read_write}, {});
+            auto & childPing = *reinterpret_cast<line *>(joined.data());
+            auto & childPong = *reinterpret_cast<line *>(joined.data() + (2 * cache_line_size));
+            std::uint64_t expected = 1;
+            while (true)
+            {
+                auto value = childPing.value_.load(std::memory_order_acquire);
+                if (value == stop)
+                    break;
+                if (value == expected)
+                {
+                    childPong.value_.store(value, std::memory_order_release);
+                    ++expected;
+                }
+                else if (spinWithYield)
+                    ::sched_yield();
+            }
+            ::_exit(0);
+        }
+
+        bcpp::benchmark::affinity_guard affinityGuard;
+        set_cpu_affinity(pingCpu);
+        std::uint64_t sequence = 0;
+        for (auto _ : s)
+        {
+            ping.value_.store(++sequence, std::memory_order_release);
+            while (pong.value_.load(std::memory_order_acquire) != sequence)
+                if (spinWithYield)
+                    ::sched_yield();
+        }
+        ping.value_.store(stop, std::memory_order_release);
+        ::waitpid(childProcessId, nullptr, 0);
+    }
+
+    registrar r7("shared_memory/ping_pong", shared_memory_ping_pong, bcpp::benchmark::cpu_pairs());
+
+
+    std::vector<std::vector<std::int64_t>> const copy_arguments
+    {
+        // size, simd_level
+        {256, 0}, {256, 1}, {256, 2},
+        {4 << 10, 0}, {4 << 10, 1}, {4 << 10, 2},
+        {64 << 10, 0}, {64 << 10, 1}, {64 << 10, 2},
+        {1 << 20, 0}, {1 << 20, 1}, {1 << 20, 2},
+        {16 << 20, 0}, {16 << 20, 1}, {16 << 20, 2},
+        {64 << 20, 0}, {64 << 20, 1}, {64 << 20, 2}
+    };
+
+
+    //=========================================================================
+    template <typename F>
+    void copy_benchmark
+    (
+        // copy between two prefaulted anonymous_mappings using the kernels of
+        // the simd_level argument (if usesKernels)
+        state & s,
+        bool usesKernels,
+        F && copyFunction
+    )
+    {
+        auto size = static_cast<std::size_t>(s.range(0));
+        auto simdLevel = static_cast<simd_level>(s.range(1));
+        if (get_copy_kernels(simdLevel).simdLevel_ != simdLevel)
+        {
+            s.skip_with_error(std::string(to_string(simdLevel)) + " is not supported by this cpu");
+            return;
+        }
+        anonymous_mapping source({.size_ = size, .mmapFlags_ = (MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE), .alignment_ = cache_line_size}, {});
+        anonymous_mapping destination({.size_ = size, .mmapFlags_ = (MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE), .alignment_ = cache_line_size}, {});
+        if ((!source.is_valid()) || (!destination.is_valid()))
+        {
+            s.skip_with_error("mmap failed");
+            return;
+        }
+        std::memset(source.data(), 1, size);
+        for (auto _ : s)
+        {
+            copyFunction(destination.data(), source.data(), size, get_copy_kernels(simdLevel));
+            bcpp::benchmark::clobber_memory();
+        }
+        s.set_bytes_processed(s.iterations() * size);
+        if (usesKernels)
+            s.set_label(std::string(to_string(simdLevel)));
+    }
+
+    registrar r8("copy/memcpy", [](auto & s){copy_benchmark(s, false, [](auto * out, auto const * in, auto size, auto const &){std::memcpy(out, in, size);});},
+            {{256, 0}, {4 << 10, 0}, {64 << 10, 0}, {1 << 20, 0}, {16 << 20, 0}, {64 << 20, 0}});
+    registrar r9("copy/stream_copy", [](auto & s){copy_benchmark(s, true, [](auto * out, auto const * in, auto size, auto const & kernels){kernels.streamCopy_(out, in, size);});},
+            copy_arguments);
+    registrar r10("copy/copy_cache_lines", [](auto & s){copy_benchmark(s, true, [](auto * out, auto const * in, auto size, auto const & kernels){kernels.copyCacheLines_(out, in, size / cache_line_size);});},
+            {{256, 0}, {256, 1}, {256, 2}, {4 << 10, 0}, {4 << 10, 1}, {4 << 10, 2}});
+    registrar r11("copy/copy", [](auto & s){copy_benchmark(s, false, [](auto * out, auto const * in, auto size, auto const &){bcpp::system::copy(out, in, size);});},
+            {{256, 0}, {4 << 10, 0}, {64 << 10, 0}, {1 << 20, 0}, {16 << 20, 0}, {64 << 20, 0}});
+    registrar r12("fill/memset", [](auto & s){copy_benchmark(s, false, [](auto * out, auto const *, auto size, auto const &){std::memset(out, 2, size);});},
+            {{4 << 10, 0}, {1 << 20, 0}, {64 << 20, 0}});
+    registrar r13("fill/stream_fill", [](auto & s){copy_benchmark(s, true, [](auto * out, auto const *, auto size, auto const & kernels){kernels.streamFill_(out, 2, size);});},
+            {{4 << 10, 0}, {4 << 10, 1}, {4 << 10, 2}, {1 << 20, 0}, {1 << 20, 1}, {1 << 20, 2}, {64 << 20, 0}, {64 << 20, 1}, {64 << 20, 2}});
+
+} // namespace
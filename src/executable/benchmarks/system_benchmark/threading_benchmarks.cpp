@@ -0,0 +1,170 @@
+#include "./benchmark.h"
+#include "./benchmark_utility.h"
+
+#include <library/system.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+
+namespace
+{
+
+    using namespace bcpp::system;
+    using bcpp::benchmark::state;
+    using bcpp::benchmark::registrar;
+
+
+    //=========================================================================
+    std::vector<thread_pool::thread_configuration> make_idle_threads
+    (
+        // threads which block until stop is requested
+        std::size_t count,
+        std::atomic<std::size_t> & started
+    )
+    {
+        return std::vector<thread_pool::thread_configuration>(count,
+                {
+                    .initializeHandler_ = [&](){++started;},
+                    .function_ = [](std::stop_token const & stopToken)
+                            {
+                                std::mutex mutex;
+                                std::condition_variable_any conditionVariable;
+                                std::unique_lock uniqueLock(mutex);
+                                conditionVariable.wait(uniqueLock, stopToken, [](){return false;});
+                            }
+                });
+    }
+
+
+    //=========================================================================
+    void thread_pool_start
+    (
+        // time from construction until every worker is running
+        state & s
+    )
+    {
+        auto threadCount = static_cast<std::size_t>(s.range(0));
+        std::atomic<std::size_t> started;
+        auto configurations = make_idle_threads(threadCount, started);
+        for (auto _ : s)
+        {
+            started = 0;
+            auto start = std::chrono::steady_clock::now();
+            thread_pool threadPool(configurations);
+            while (started != threadCount)
+                std::this_thread::yield();
+            s.set_iteration_time(std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    registrar r0("thread_pool/start", thread_pool_start, {{1}, {2}, {4}, {8}, {16}});
+
+
+    //=========================================================================
+    void thread_pool_stop
+    (
+        // time for stop() to signal and join every (running) worker
+        state & s
+    )
+    {
+        auto threadCount = static_cast<std::size_t>(s.range(0));
+        std::atomic<std::size_t> started;
+        auto configurations = make_idle_threads(threadCount, started);
+        for (auto _ : s)
+        {
+            started = 0;
+            thread_pool threadPool(configurations);
+            while (started != threadCount)
+                std::this_thread::yield();
+            auto start = std::chrono::steady_clock::now();
+            threadPool.stop(bcpp::synchronization_mode::blocking);
+            s.set_iteration_time(std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    registrar r1("thread_pool/stop", thread_pool_stop, {{1}, {2}, {4}, {8}, {16}});
+
+
+    //=========================================================================
+    void thread_pool_start_stop
+    (
+        state & s
+    )
+    {
+        auto threadCount = static_cast<std::size_t>(s.range(0));
+        std::atomic<std::size_t> started;
+        auto configurations = make_idle_threads(threadCount, started);
+        for (auto _ : s)
+        {
+            thread_pool threadPool(configurations);
+            threadPool.stop(bcpp::synchronization_mode::blocking);
+        }
+    }
+
+    registrar r2("thread_pool/start_stop", thread_pool_start_stop, {{1}, {2}, {4}, {8}, {16}});
+
+
+    //=========================================================================
+    void set_cpu_affinity_switch
+    (
+        // cost of moving the calling thread between two cpus
+        state & s
+    )
+    {
+        cpu_id cpus[2] = {static_cast<cpu_id>(s.range(0)), static_cast<cpu_id>(s.range(1))};
+        bcpp::benchmark::affinity_guard affinityGuard;
+        std::size_t index = 0;
+        for (auto _ : s)
+        {
+            if (!set_cpu_affinity(cpus[index ^= 1]))
+            {
+                s.skip_with_error("set_cpu_affinity failed");
+                return;
+            }
+        }
+    }
+
+    registrar r3("set_cpu_affinity/switch", set_cpu_affinity_switch, bcpp::benchmark::cpu_pairs());
+
+
+    //=========================================================================
+    void get_cpu_affinity_query
+    (
+        state & s
+    )
+    {
+        for (auto _ : s)
+            bcpp::benchmark::do_not_optimize(get_cpu_affinity());
+    }
+
+    registrar r4("get_cpu_affinity", get_cpu_affinity_query);
+
+
+    //=========================================================================
+    void tsc_clock_now
+    (
+        state & s
+    )
+    {
+        for (auto _ : s)
+            bcpp::benchmark::do_not_optimize(tsc_clock::now());
+    }
+
+    registrar r5("tsc_clock/now", tsc_clock_now);
+
+
+    //=========================================================================
+    void system_clock_now
+    (
+        state & s
+    )
+    {
+        for (auto _ : s)
+            bcpp::benchmark::do_not_optimize(std::chrono::system_clock::now());
+    }
+
+    registrar r6("system_clock/now", system_clock_now);
+
+} // namespace
@@ -0,0 +1,138 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+
+namespace
+{
+
+    struct command :
+        bcpp::system::mpsc_queue_node
+    {
+        std::uint64_t   orderId_;
+        std::int64_t    price_;
+    };
+
+    static std::size_t constexpr producer_count = 64;
+    static std::size_t constexpr commands_per_producer = 20'000;
+    static std::size_t constexpr total_commands = (producer_count * commands_per_producer);
+
+
+    //=========================================================================
+    template <typename P, typename C>
+    void measure
+    (
+        // many producers feed one owner thread which applies every command
+        std::string const & name,
+        P && produce,
+        C && consume
+    )
+    {
+        using namespace bcpp::system;
+
+        std::uint64_t applied = 0;
+        std::int64_t book = 0;
+        auto start = std::chrono::steady_clock::now();
+        {
+            auto cpus = get_available_cpus();
+            thread_pool owner({{.function_ = [&](std::stop_token const & stopToken)
+                    {
+                        while (applied < total_commands)
+                            applied += consume(stopToken, [&](command const & c){book += c.price_;});
+                    }, .cpuId_ = cpus.back(), .name_ = "owner"}});
+            std::vector<std::jthread> producers;
+            for (std::size_t p = 0; p < producer_count; ++p)
+                producers.emplace_back([&, p](){produce(p);});
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": commands/s = " << (applied / elapsed) << ", book = " << book << "\n";
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    int,
+    char **
+)
+{
+    using namespace bcpp::system;
+
+    std::vector<std::vector<command>> commands(producer_count, std::vector<command>(commands_per_producer));
+    for (auto & producerCommands : commands)
+        for (std::size_t i = 0; i < commands_per_producer; ++i)
+        {
+            producerCommands[i].orderId_ = i;
+            producerCommands[i].price_ = 1;
+        }
+
+    // the baseline: a mutex guarded deque
+    std::mutex mutex;
+    std::condition_variable conditionVariable;
+    std::deque<command *> deque;
+    measure("mutex + deque", [&](std::size_t p)
+            {
+                for (auto & c : commands[p])
+                {
+                    {
+                        std::lock_guard lockGuard(mutex);
+                        deque.push_back(&c);
+                    }
+                    conditionVariable.notify_one();
+                }
+            },
+            [&](std::stop_token const &, auto && apply)
+            {
+                std::unique_lock uniqueLock(mutex);
+                conditionVariable.wait(uniqueLock, [&](){return !deque.empty();});
+                std::size_t count = 0;
+                for (; !deque.empty(); ++count)
+                {
+                    apply(*deque.front());
+                    deque.pop_front();
+                }
+                return count;
+            });
+
+    intrusive_mpsc_queue<command> intrusiveQueue;
+    measure("intrusive_mpsc_queue", [&](std::size_t p)
+            {
+                for (auto & c : commands[p])
+                    intrusiveQueue.push(&c);
+            },
+            [&](std::stop_token const & stopToken, auto && apply)
+            {
+                intrusiveQueue.wait(stopToken);
+                return intrusiveQueue.consume([&](command * c){apply(*c);}, 256);
+            });
+
+    bounded_mpsc_queue<command> boundedQueue(1 << 14);
+    measure("bounded_mpsc_queue (batches of 16)", [&](std::size_t p)
+            {
+                for (std::size_t i = 0; i < commands_per_producer; )
+                {
+                    auto first = commands[p].begin() + i;
+                    auto pushed = boundedQueue.push(first, first + std::min<std::size_t>(16, commands_per_producer - i));
+                    if (pushed == 0)
+                        std::this_thread::yield();   // full
+                    i += pushed;
+                }
+            },
+            [&](std::stop_token const & stopToken, auto && apply)
+            {
+                boundedQueue.wait(stopToken);
+                return boundedQueue.consume(apply, 256);
+            });
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+
+//=============================================================================
+int main
+(
+    int,
+    char **
+)
+{
+    using namespace bcpp::system;
+
+    // a standby process keeps a copy of the primary's state current while
+    // the primary writes a few pages of it between each cycle
+    static std::size_t constexpr state_size = (64 << 20);
+    static std::size_t constexpr cycles = 100;
+    static std::size_t constexpr writes_per_cycle = 64;
+
+    std::int32_t sockets[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+    {
+        std::cerr << "failed to create socket pair\n";
+        return 1;
+    }
+    file_descriptor primarySocket(sockets[0]);
+    file_descriptor standbySocket(sockets[1]);
+
+    auto checksum = [](std::span<std::byte const> region)
+            {
+                auto const * values = reinterpret_cast<std::uint64_t const *>(region.data());
+                return std::accumulate(values, values + (region.size() / sizeof(std::uint64_t)), std::uint64_t{0},
+                        [](auto sum, auto value){return ((sum * 31) + value);});
+            };
+
+    if (auto processId = ::fork(); processId == 0)
+    {
+        // standby
+        primarySocket.close();
+        anonymous_mapping state({.size_ = state_size, .tag_ = "standby"}, {});
+        replication_receiver replicationReceiver({state.data(), state.size()}, standbySocket);
+        while (replicationReceiver.receive().has_value())
+            ;
+        auto const & statistics = replicationReceiver.get_statistics();
+        std::cout << "standby: " << statistics.cycles_ << " cycles, " << statistics.pagesReceived_ << " pages received, checksum = " <<
+                checksum({state.data(), state.size()}) << "\n";
+        return 0;
+    }
+    else if (processId < 0)
+    {
+        std::cerr << "failed to fork standby\n";
+        return 1;
+    }
+
+    // primary
+    standbySocket.close();
+    anonymous_mapping state({.size_ = state_size, .tag_ = "primary"}, {});
+    auto trackingMethod = dirty_page_tracker::is_soft_dirty_supported() ? dirty_page_tracker::tracking_method::soft_dirty :
+            dirty_page_tracker::tracking_method::bitmap;
+    dirty_page_tracker dirtyPageTracker({state.data(), state.size()}, {.trackingMethod_ = trackingMethod});
+    replication_sender replicationSender({state.data(), state.size()}, dirtyPageTracker, primarySocket);
+
+    std::mt19937_64 random(1);
+    auto * values = reinterpret_cast<std::uint64_t *>(state.data());
+    for (std::size_t cycle = 0; cycle < cycles; ++cycle)
+    {
+        for (std::size_t i = 0; i < writes_per_cycle; ++i)
+        {
+            auto index = (random() % (state_size / sizeof(std::uint64_t)));
+            values[index] = random();
+            dirtyPageTracker.mark_dirty(index * sizeof(std::uint64_t), sizeof(std::uint64_t));   // only needed for the bitmap
+        }
+        if (!replicationSender.replicate().has_value())
+        {
+            std::cerr << "replication failed\n";
+            return 1;
+        }
+    }
+    primarySocket.close();
+    ::waitpid(-1, nullptr, 0);
+
+    auto const & statistics = replicationSender.get_statistics();
+    std::cout << "primary (" << ((trackingMethod == dirty_page_tracker::tracking_method::soft_dirty) ? "soft dirty" : "bitmap") << "): " <<
+            statistics.cycles_ << " cycles, " << statistics.pagesSent_ << " pages sent (" << dirtyPageTracker.page_count() <<
+            " pages in the region), checksum = " << checksum({state.data(), state.size()}) << "\n";
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <random>
+
+
+
+//=============================================================================
+int main
+(
+    int,
+    char **
+)
+{
+    using namespace bcpp::system;
+
+    // a large dataset of which this process reads a small slice.  the loader
+    // stands in for reading and decompressing the dataset from a file
+    static std::size_t constexpr dataset_size = (4ull << 30);
+    static std::size_t constexpr slice_size = (32 << 20);
+
+    auto resident = []()
+            {
+                std::ifstream statm("/proc/self/statm");
+                std::size_t size = 0;
+                std::size_t pages = 0;
+                statm >> size >> pages;
+                return ((pages * ::getpagesize()) >> 20);
+            };
+
+    auto start = std::chrono::steady_clock::now();
+    lazy_mapping dataset({.size_ = dataset_size, .prefetchPages_ = 15, .tag_ = "dataset"}, [](auto offset, auto destination)
+            {
+                auto * values = reinterpret_cast<std::uint64_t *>(destination.data());
+                for (std::size_t i = 0; i < (destination.size() / sizeof(std::uint64_t)); ++i)
+                    values[i] = ((offset / sizeof(std::uint64_t)) + i);
+                return true;
+            });
+    if (!dataset.is_valid())
+    {
+        std::cerr << "userfaultfd is not available (see vm.unprivileged_userfaultfd)\n";
+        return 1;
+    }
+    thread_pool pool({dataset.handler()});
+    auto mapped = std::chrono::steady_clock::now();
+
+    // a sequential scan of one slice and random reads from another
+    auto const * values = reinterpret_cast<std::uint64_t const *>(dataset.data());
+    std::uint64_t errors = 0;
+    auto first = (dataset_size / 2) / sizeof(std::uint64_t);
+    for (auto i = first; i < (first + (slice_size / sizeof(std::uint64_t))); ++i)
+        errors += (values[i] != i);
+    std::mt19937_64 random(1);
+    for (std::size_t i = 0; i < 1'000; ++i)
+    {
+        auto index = (random() % (slice_size / sizeof(std::uint64_t)));
+        errors += (values[index] != index);
+    }
+    auto read = std::chrono::steady_clock::now();
+
+    auto statistics = dataset.get_statistics();
+    std::cout << (dataset_size >> 30) << "GB dataset mapped in " << std::chrono::duration_cast<std::chrono::microseconds>(mapped - start).count() <<
+            "us, slices read in " << std::chrono::duration_cast<std::chrono::milliseconds>(read - mapped).count() << "ms (" << errors << " errors)\n" <<
+            statistics.faults_ << " faults, " << statistics.pagesLoaded_ << " pages loaded (" << statistics.pagesPrefetched_ << " prefetched), " <<
+            resident() << "MB resident\n";
+    pool.stop();
+    return 0;
+}
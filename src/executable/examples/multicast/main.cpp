@@ -0,0 +1,109 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    using namespace bcpp::system;
+
+    // a sender publishes to a multicast group which a receiver on a reactor
+    // has joined.  where the interface does not support multicast (ie: the
+    // loopback interface of a container) the example falls back to unicast
+    static std::size_t constexpr datagram_count = 100'000;
+    static std::size_t constexpr datagram_size = 256;
+    std::string group = (argc > 1) ? args[1] : "239.255.0.1";
+    std::string interface = (argc > 2) ? args[2] : "127.0.0.1";
+
+    // configured member by member as gcc 12 reports (falsely) that the
+    // strings of a designated initializer may be destroyed uninitialized
+    datagram_socket::configuration receiverConfiguration;
+    receiverConfiguration.multicastGroup_ = group;
+    receiverConfiguration.multicastInterface_ = interface;
+    receiverConfiguration.receiveBufferSize_ = (8 << 20);
+    datagram_socket receiver(receiverConfiguration);
+    auto unicast = (!receiver.is_valid());
+    if (unicast)
+    {
+        std::cerr << "warning: unable to join " << group << " on " << interface << ".  using unicast\n";
+        receiverConfiguration.local_.address_ = interface;
+        receiverConfiguration.multicastGroup_.reset();
+        receiver = datagram_socket(receiverConfiguration);
+        if (!receiver.is_valid())
+        {
+            std::cerr << "failed to create receiver\n";
+            return 1;
+        }
+    }
+    auto port = receiver.local_endpoint()->port_;
+    datagram_socket::configuration senderConfiguration;
+    senderConfiguration.multicastInterface_ = interface;
+    senderConfiguration.destination_ = datagram_socket::endpoint{unicast ? interface : group, port};
+    senderConfiguration.sendBufferSize_ = (8 << 20);
+    datagram_socket sender(senderConfiguration);
+
+    // the payload carries the send time so that the kernel receive timestamp
+    // measures the time spent in the network stack
+    latency_histogram latency;
+    std::atomic<std::uint64_t> received = 0;
+    reactor reactor;
+    reactor.add(receiver.get_file_descriptor(), reactor::readable, [&](auto)
+            {
+                // edge triggered so receive until the socket is drained
+                for (auto datagrams = receiver.receive(); !datagrams.empty(); datagrams = receiver.receive())
+                {
+                    for (auto const & datagram : datagrams)
+                    {
+                        std::int64_t sent;
+                        std::memcpy(&sent, datagram.data_.data(), sizeof(sent));
+                        auto inStack = (datagram.timestamp_.time_since_epoch().count() - sent);
+                        latency.record(static_cast<std::uint64_t>(std::max<std::int64_t>(inStack, 0)));
+                    }
+                    received.fetch_add(datagrams.size(), std::memory_order_relaxed);
+                }
+            });
+    thread_pool pool({reactor.worker()});
+
+    // one batch (one sendmmsg) at a time
+    std::vector<std::vector<std::byte>> buffers(datagram_socket::configuration{}.batchSize_, std::vector<std::byte>(datagram_size));
+    std::vector<std::span<std::byte const>> payloads(buffers.begin(), buffers.end());
+    auto start = std::chrono::steady_clock::now();
+    std::size_t sent = 0;
+    while (sent < datagram_count)
+    {
+        auto now = std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::system_clock::now().time_since_epoch()).count();
+        for (auto & buffer : buffers)
+            std::memcpy(buffer.data(), &now, sizeof(now));
+        auto count = sender.send(payloads);
+        sent += count;
+        if (count < payloads.size())
+            std::this_thread::yield();    // the socket buffer is full
+    }
+    // allow the receiver to drain (datagrams dropped by the kernel never arrive)
+    for (auto i = 0; (i < 100) && (received < sent); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    pool.stop();
+
+    auto const & sendStatistics = sender.get_statistics();
+    auto const & receiveStatistics = receiver.get_statistics();
+    std::cout << (unicast ? "unicast" : "multicast") << ": sent = " << sent << ", received = " << received << ", datagrams/s = " << (received / elapsed) <<
+            "\ndatagrams per sendmmsg = " << (static_cast<double>(sendStatistics.datagramsSent_) / sendStatistics.sendCalls_) <<
+            ", datagrams per recvmmsg = " << (static_cast<double>(receiveStatistics.datagramsReceived_) / receiveStatistics.receiveCalls_) <<
+            "\nsend to kernel receive p50 = " << latency.percentile(50.0) << "ns, p99 = " << latency.percentile(99.0) << "ns, max = " << latency.maximum() << "ns\n";
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+
+//=============================================================================
+int main
+(
+    int,
+    char **
+)
+{
+    using namespace bcpp::system;
+
+    // each worker counts its own events.  the hot scope of each is recorded
+    // separately and every worker reports its totals when it exits
+    static std::size_t constexpr worker_count = 2;
+    static std::size_t constexpr iterations = 100'000;
+    static std::size_t constexpr table_size = (16 << 20);
+
+    std::vector<std::uint64_t> table(table_size / sizeof(std::uint64_t), 1);
+    perf_scope_stats scopeStats[worker_count];
+    std::mutex outputMutex;
+    auto report = [&](auto name, auto const & sample)
+            {
+                std::lock_guard lockGuard(outputMutex);
+                std::cout << name << " totals:";
+                for (std::size_t i = 0; i < perf_counters::counter_count; ++i)
+                    std::cout << " " << perf_counters::name(static_cast<perf_counters::counter>(i)) << "=" << sample.values_[i];
+                std::cout << "\n";
+            };
+
+    std::vector<thread_pool::thread_configuration> workers;
+    for (std::size_t w = 0; w < worker_count; ++w)
+        workers.push_back(perf_counters::instrument({
+                .function_ = [&, w](auto const &)
+                        {
+                            std::uint64_t sum = 0;
+                            std::uint64_t index = w;
+                            for (std::size_t i = 0; i < iterations; ++i)
+                            {
+                                BCPP_PERF_SCOPE(scopeStats[w]);
+                                // a dependent random walk through a table larger than the cache
+                                index = ((index * 6'364'136'223'846'793'005ull) + 1'442'695'040'888'963'407ull);
+                                sum += table[(index >> 20) % table.size()];
+                            }
+                            std::lock_guard lockGuard(outputMutex);
+                            auto * counters = perf_counters::current();
+                            std::cout << "worker " << w << " (sum " << sum << ") counters " << (counters && counters->is_valid() ?
+                                    (counters->is_user_read() ? "read with rdpmc" : "read with system calls") : "not available") << "\n";
+                        },
+                .name_ = "worker " + std::to_string(w)
+            }, perf_counters::configuration{}, report));
+    thread_pool pool(workers);
+    pool.stop();
+
+    for (std::size_t w = 0; w < worker_count; ++w)
+    {
+        auto total = scopeStats[w].total();
+        std::cout << "worker " << w << " hot scope, per iteration:";
+        for (std::size_t i = 0; i < perf_counters::counter_count; ++i)
+            std::cout << " " << perf_counters::name(static_cast<perf_counters::counter>(i)) << "=" <<
+                    (static_cast<double>(total.values_[i]) / scopeStats[w].count());
+        std::cout << "\n";
+    }
+    return 0;
+}
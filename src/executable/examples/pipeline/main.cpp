@@ -0,0 +1,71 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    using namespace bcpp::system;
+
+    struct message
+    {
+        std::uint64_t   sequence_;
+        std::int64_t    timestamp_;
+    };
+
+    static std::uint64_t constexpr message_count = 10'000'000;
+    auto cpus = get_available_cpus();
+    auto cpu = [&](std::size_t index){return cpus[index % cpus.size()];};
+
+    // decode -> normalize -> strategy -> gateway.  decode and normalize are fused on one cpu
+    pipeline pipeline({.idleSpinCount_ = (cpus.size() < 3) ? 1024ull : 0ull});
+    std::uint64_t sequence = 0;
+    auto decode = pipeline.add_source<message>({.name_ = "decode", .cpuId_ = cpu(0)}, [&](auto & output)
+            {
+                for (auto i = 0; (i < 64) && (sequence < message_count); ++i)
+                    output.push({sequence++, tsc_clock::now().time_since_epoch().count()});
+            });
+    auto normalize = pipeline.add_stage<message, message>(decode, {.name_ = "normalize", .cpuId_ = cpu(0)}, [](auto input, auto & output)
+            {
+                for (auto & m : input)
+                    output.push(m);
+            });
+    auto strategy = pipeline.add_stage<message, message>(normalize, {.name_ = "strategy", .cpuId_ = cpu(1)}, [](auto input, auto & output)
+            {
+                for (auto & m : input)
+                    if ((m.sequence_ % 4) == 0)
+                        output.push(m);
+            });
+    latency_histogram latency;
+    std::atomic<std::uint64_t> received = 0;
+    pipeline.add_sink<message>(strategy, {.name_ = "gateway", .cpuId_ = cpu(2)}, [&](auto input)
+            {
+                auto now = tsc_clock::now().time_since_epoch().count();
+                for (auto & m : input)
+                    latency.record(static_cast<std::uint64_t>(now - m.timestamp_));
+                received.store(received.load(std::memory_order_relaxed) + input.size(), std::memory_order_release);
+            });
+
+    auto start = std::chrono::steady_clock::now();
+    pipeline.start();
+    while (received.load(std::memory_order_acquire) < (message_count / 4))
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto const & stats : pipeline.get_stage_stats())
+        std::cout << stats.name_ << ": cpu = " << stats.cpuId_.value_or(-1) << ", processed = " << stats.processed_ << 
+                ", batches = " << stats.batches_ << ", blocked = " << stats.blocked_ << "\n";
+    pipeline.stop();
+
+    std::cout << "messages/s = " << (message_count / elapsed) << ", latency p50 = " << latency.percentile(50.0) << 
+            "ns, p99 = " << latency.percentile(99.0) << "ns, max = " << latency.maximum() << "ns\n";
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    using namespace bcpp::system;
+
+    // one pinned reactor worker echoes on the far end of many socket pairs
+    static std::size_t constexpr connection_count = 2'000;
+    static std::size_t constexpr round_count = 100;
+    auto busyPoll = ((argc > 1) && (std::string(args[1]) == "--busy-poll"));
+    auto cpus = get_available_cpus();
+    if ((busyPoll) && (cpus.size() < 2))
+        std::cerr << "warning: a busy polling reactor needs a cpu of its own\n";
+
+    std::vector<file_descriptor> near;
+    std::vector<file_descriptor> far;
+    for (std::size_t i = 0; i < connection_count; ++i)
+    {
+        std::int32_t pair[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair) != 0)
+        {
+            std::cerr << "socketpair failed.  raise the open file limit (ulimit -n)\n";
+            return 1;
+        }
+        near.emplace_back(pair[0]);
+        far.emplace_back(pair[1]);
+    }
+
+    reactor reactor({.busyPoll_ = busyPoll});
+    std::atomic<std::uint64_t> echoed = 0;
+    for (auto & fileDescriptor : far)
+        reactor.add(fileDescriptor, reactor::readable, [&, fd = fileDescriptor.get()](auto)
+                {
+                    // edge triggered so read until the socket is drained
+                    char buffer[256];
+                    ssize_t received;
+                    while ((received = ::read(fd, buffer, sizeof(buffer))) > 0)
+                    {
+                        [[maybe_unused]] auto _ = ::write(fd, buffer, received);
+                        echoed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+
+    thread_pool pool({reactor.worker(cpus.back())});
+
+    latency_histogram latency;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < round_count; ++round)
+    {
+        for (std::size_t i = 0; i < connection_count; ++i)
+        {
+            auto sent = std::chrono::steady_clock::now().time_since_epoch().count();
+            [[maybe_unused]] auto _ = ::write(near[i].get(), &sent, sizeof(sent));
+            std::int64_t reply;
+            while (::read(near[i].get(), &reply, sizeof(reply)) != sizeof(reply))
+                std::this_thread::yield();
+            latency.record(static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count() - reply));
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // posted tasks run on the reactor's thread
+    std::atomic<bool> posted = false;
+    reactor.post([&](){posted = true;});
+    while (!posted)
+        std::this_thread::yield();
+    pool.stop();
+
+    std::cout << "connections = " << reactor.size() << ", echoed = " << echoed << ", round trips/s = " << ((connection_count * round_count) / elapsed) <<
+            ", latency p50 = " << latency.percentile(50.0) << "ns, p99 = " << latency.percentile(99.0) << "ns, max = " << latency.maximum() << "ns\n";
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+
+
+namespace
+{
+
+    using namespace bcpp::system;
+
+    static std::size_t constexpr message_count = 10'000'000;
+
+
+    //=========================================================================
+    struct producer
+    {
+        explicit producer
+        (
+            spsc_queue<std::uint64_t> & queue
+        ):
+            queue_(&queue)
+        {
+        }
+
+        void operator()
+        (
+            std::stop_token const & stopToken
+        )
+        {
+            for (std::uint64_t i = 0; (i < message_count) && (!stopToken.stop_requested()); )
+            {
+                if (queue_->try_push(i))
+                    ++i;
+                else
+                    std::this_thread::yield();  // in case the consumer shares the cpu
+            }
+        }
+
+        spsc_queue<std::uint64_t> * queue_;
+    };
+
+
+    //=========================================================================
+    struct consumer
+    {
+        explicit consumer
+        (
+            spsc_queue<std::uint64_t> & queue
+        ):
+            queue_(&queue)
+        {
+        }
+
+        void initialize()
+        {
+            start_ = std::chrono::steady_clock::now();
+        }
+
+        void operator()
+        (
+            std::stop_token const & stopToken
+        )
+        {
+            while ((received_ < message_count) && (!stopToken.stop_requested()))
+            {
+                if (auto consumed = queue_->consume([this](auto value){sum_ += value;}); consumed > 0)
+                    received_ += consumed;
+                else
+                    std::this_thread::yield();
+            }
+        }
+
+        void terminate()
+        {
+            elapsed_ = (std::chrono::steady_clock::now() - start_);
+            done_ = true;
+            done_.notify_all();
+        }
+
+        spsc_queue<std::uint64_t> *             queue_;
+        std::uint64_t                           received_{0};
+        std::uint64_t                           sum_{0};
+        std::chrono::steady_clock::time_point   start_;
+        std::chrono::nanoseconds                elapsed_{0};
+        std::atomic<bool>                       done_{false};
+    };
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    int,
+    char **
+)
+{
+    // the topology (which workers, their hooks and their cpus) is fixed at
+    // compile time.  pinning to a cpu which is not available is ignored
+    using pool_type = static_thread_pool<
+            static_worker<producer, {.cpuId_ = 0, .name_ = "producer"}>,
+            static_worker<consumer, {.cpuId_ = 1, .name_ = "consumer"}>>;
+    static_assert(pool_type::cpu_ids[1] == 1);
+
+    spsc_queue<std::uint64_t> queue(1 << 12);
+    pool_type pool(queue, queue);
+
+    auto & c = pool.get<1>();
+    c.done_.wait(false);
+    std::cout << c.received_ << " messages (sum " << c.sum_ << ") in " <<
+            std::chrono::duration_cast<std::chrono::milliseconds>(c.elapsed_).count() << "ms\n";
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    using namespace bcpp::system;
+
+    // the first run builds its state and snapshots it.  a second run maps
+    // the snapshot back and touches only the part of the state it uses
+    static std::size_t constexpr state_size = (256 << 20);
+    static std::size_t constexpr working_set = (16 << 20);
+    std::string path = (argc > 1) ? args[1] : "/tmp/warm_restart.snapshot";
+
+    auto start = std::chrono::steady_clock::now();
+    if (auto info = get_snapshot_info(path); info.has_value())
+    {
+        auto state = map_snapshot(path, "state");
+        auto mapped = std::chrono::steady_clock::now();
+        auto const * values = reinterpret_cast<std::uint64_t const *>(state.data());
+        std::uint64_t sum = 0;
+        for (std::size_t i = 0; i < (working_set / sizeof(std::uint64_t)); i += 512)
+            sum += values[i];
+        auto touched = std::chrono::steady_clock::now();
+        std::cout << "restored '" << info->tag_ << "' (" << (info->size_ >> 20) << "MB): mapped in " <<
+                std::chrono::duration_cast<std::chrono::microseconds>(mapped - start).count() << "us, working set read in " <<
+                std::chrono::duration_cast<std::chrono::microseconds>(touched - mapped).count() << "us, sum = " << sum << "\n";
+        return 0;
+    }
+
+    anonymous_mapping state({.size_ = state_size, .tag_ = "state"}, {});
+    if (!state.is_valid())
+    {
+        std::cerr << "failed to map state\n";
+        return 1;
+    }
+    // stands in for an expensive rebuild
+    auto * values = reinterpret_cast<std::uint64_t *>(state.data());
+    for (std::size_t i = 0; i < (state_size / sizeof(std::uint64_t)); ++i)
+        values[i] = (i * 2'654'435'761ull);
+    auto built = std::chrono::steady_clock::now();
+
+    // the state keeps changing while the snapshot of it is written
+    snapshot_writer snapshotWriter({state.data(), state.size()}, {.path_ = path, .tag_ = "state"});
+    for (std::size_t i = 0; !snapshotWriter.is_complete(); i = ((i + 1) % (state_size / sizeof(std::uint64_t))))
+        ++values[i];
+    std::cout << "built in " << std::chrono::duration_cast<std::chrono::milliseconds>(built - start).count() << "ms, snapshot " <<
+            (snapshotWriter.wait() ? "written to " : "failed: ") << path << " (held for " <<
+            std::chrono::duration_cast<std::chrono::microseconds>(snapshotWriter.capture_duration()).count() << "us).  run again to restore\n";
+    return 0;
+}
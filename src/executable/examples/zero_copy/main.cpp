@@ -0,0 +1,123 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    //=========================================================================
+    double thread_cpu_seconds
+    (
+    )
+    {
+        timespec ts;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return (ts.tv_sec + (ts.tv_nsec / 1e9));
+    }
+
+
+    //=========================================================================
+    void measure
+    (
+        // report throughput and the cpu time of the sending thread
+        std::string const & name,
+        std::size_t bytes,
+        std::function<std::size_t()> const & function
+    )
+    {
+        auto cpuStart = thread_cpu_seconds();
+        auto start = std::chrono::steady_clock::now();
+        auto moved = function();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto cpu = (thread_cpu_seconds() - cpuStart);
+        std::cout << name << ": " << ((moved == bytes) ? "" : "incomplete ") << (moved / elapsed / (1 << 30)) << " GB/s, cpu = " <<
+                (cpu * 1e3) << "ms\n";
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    using namespace bcpp::system;
+
+    // a recorder moves a shared memory buffer to a file and to a consumer
+    // on a socket with write() and then with zero_copy_transfer
+    static std::size_t constexpr buffer_size = (64 << 20);
+    static std::size_t constexpr round_count = 8;
+    std::string path = (argc > 1) ? args[1] : "/tmp/zero_copy_example";
+
+    auto sharedMemory = shared_memory::create(
+            {
+                .path_ = "",
+                .size_ = buffer_size,
+                .ioMode_ = io_mode::read_write,
+                .unlinkPolicy_ = shared_memory::unlink_policy::on_detach
+            }, {});
+    file_descriptor file(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    std::int32_t pair[2];
+    if ((!sharedMemory.is_valid()) || (!file.is_valid()) || (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0))
+    {
+        std::cerr << "failed to create shared memory, " << path << " or socket pair\n";
+        return 1;
+    }
+    file_descriptor producer(pair[0]);
+    file_descriptor consumer(pair[1]);
+    std::memset(sharedMemory.data(), 0x5a, buffer_size);
+    std::span<std::byte const> buffer(sharedMemory.data(), buffer_size);
+
+    // the consumer discards what it receives
+    std::jthread consumerThread([&](std::stop_token const &)
+            {
+                std::vector<char> discard(1 << 20);
+                while (::read(consumer.get(), discard.data(), discard.size()) > 0)
+                    ;
+            });
+
+    auto totalBytes = (buffer_size * round_count);
+    auto repeat = [&](auto && move)
+            {
+                std::size_t moved = 0;
+                for (std::size_t round = 0; round < round_count; ++round)
+                    moved += move();
+                return moved;
+            };
+    auto writeAll = [&](file_descriptor const & destination)
+            {
+                std::size_t written = 0;
+                ssize_t result;
+                while ((written < buffer.size()) && ((result = ::write(destination.get(), buffer.data() + written, buffer.size() - written)) > 0))
+                    written += result;
+                return written;
+            };
+
+    zero_copy_transfer transfer;
+    measure("file write()", totalBytes, [&](){return repeat([&](){::lseek(file.get(), 0, SEEK_SET); return writeAll(file);});});
+    measure("file vmsplice/splice", totalBytes, [&](){return repeat([&](){::lseek(file.get(), 0, SEEK_SET); return transfer.write(buffer, file);});});
+    measure("socket write()", totalBytes, [&](){return repeat([&](){return writeAll(producer);});});
+    measure("socket vmsplice/splice", totalBytes, [&](){return repeat([&](){return transfer.write(buffer, producer);});});
+    measure("file to socket sendfile", totalBytes, [&](){return repeat([&](){return transfer.transfer(file, producer, buffer_size, 0);});});
+
+    producer.close();
+    consumerThread.join();
+    ::unlink(path.c_str());
+    return 0;
+}
@@ -0,0 +1,555 @@
+#include <library/system.h>
+#include <library/system/memory/anonymous_mapping.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+extern char ** environ;
+
+
+namespace
+{
+
+    using namespace bcpp::system;
+
+    struct alignas(cache_line_size) cache_line
+    {
+        std::atomic<std::uint64_t> value_;
+    };
+
+
+    //=========================================================================
+    // the memory shared by the two cpus under test.  for the in process test
+    // it lives in an anonymous_mapping and for the cross process test in a
+    // shared_memory segment joined by a child process.
+    //=========================================================================
+    struct channel
+    {
+        cache_line  latency_;
+        cache_line  ready_;
+        cache_line  produced_;
+        cache_line  consumed_;
+        // followed by the bandwidth block
+    };
+
+
+    struct options
+    {
+        std::vector<cpu_id>     cpus_;
+        std::size_t             roundTrips_{100'000};
+        std::size_t             transfers_{2'000};
+        std::size_t             blockSize_{64 << 10};
+        bool                    threadMode_{true};
+        bool                    processMode_{true};
+        bool                    includeDiagonal_{false};
+        bool                    json_{false};
+    };
+
+
+    struct result
+    {
+        double  latency_{std::numeric_limits<double>::quiet_NaN()};     // one way, nanoseconds
+        double  bandwidth_{std::numeric_limits<double>::quiet_NaN()};   // bytes per second
+    };
+
+    using matrix = std::vector<std::vector<result>>;
+
+
+    //=========================================================================
+    std::size_t channel_size
+    (
+        std::size_t blockSize
+    )
+    {
+        return (sizeof(channel) + blockSize);
+    }
+
+
+    //=========================================================================
+    std::byte * get_block
+    (
+        channel & c
+    )
+    {
+        return (reinterpret_cast<std::byte *>(&c) + sizeof(channel));
+    }
+
+
+    //=========================================================================
+    bool wait_for
+    (
+        // spin until the value is reached.  yield if both sides share a cpu.
+        // returns false if the other side is abandoned (ie: it has died)
+        // before reaching the value
+        cache_line const & line,
+        std::uint64_t value,
+        bool yield,
+        std::atomic<bool> const * abandoned = nullptr
+    )
+    {
+        while (line.value_.load(std::memory_order_acquire) != value)
+        {
+            // the other side may have reached the value just before exiting
+            if ((abandoned != nullptr) && (abandoned->load(std::memory_order_acquire)))
+                return (line.value_.load(std::memory_order_acquire) == value);
+            if (yield)
+                ::sched_yield();
+        }
+        return true;
+    }
+
+
+    //=========================================================================
+    void respond
+    (
+        // the passive side of both tests.  bounces the latency cache line back
+        // and then consumes every block the initiator produces.
+        channel & c,
+        std::size_t roundTrips,
+        std::size_t transfers,
+        std::size_t blockSize,
+        bool yield
+    )
+    {
+        c.ready_.value_.store(1, std::memory_order_release);
+        for (std::uint64_t i = 0; i < roundTrips; ++i)
+        {
+            wait_for(c.latency_, (2 * i) + 1, yield);
+            c.latency_.value_.store((2 * i) + 2, std::memory_order_release);
+        }
+
+        auto const * block = reinterpret_cast<std::uint64_t const *>(get_block(c));
+        std::uint64_t sum = 0;
+        for (std::uint64_t i = 0; i < transfers; ++i)
+        {
+            wait_for(c.produced_, i + 1, yield);
+            for (std::size_t j = 0; j < (blockSize / sizeof(std::uint64_t)); j += (cache_line_size / sizeof(std::uint64_t)))
+                sum += block[j];
+            c.consumed_.value_.store(i + 1, std::memory_order_release);
+        }
+        asm volatile("" : : "r"(sum));
+    }
+
+
+    //=========================================================================
+    result initiate
+    (
+        // the active side.  measures round trips on one cache line and then
+        // the rate at which blocks can be handed over to the responder.  the
+        // result is empty if the responder is abandoned
+        channel & c,
+        std::size_t roundTrips,
+        std::size_t transfers,
+        std::size_t blockSize,
+        bool yield,
+        std::atomic<bool> const * abandoned
+    )
+    {
+        if (!wait_for(c.ready_, 1, yield, abandoned))
+            return {};
+
+        auto start = tsc_clock::now();
+        for (std::uint64_t i = 0; i < roundTrips; ++i)
+        {
+            c.latency_.value_.store((2 * i) + 1, std::memory_order_release);
+            if (!wait_for(c.latency_, (2 * i) + 2, yield, abandoned))
+                return {};
+        }
+        auto latencyElapsed = tsc_clock::now() - start;
+
+        auto * block = reinterpret_cast<std::uint64_t *>(get_block(c));
+        start = tsc_clock::now();
+        for (std::uint64_t i = 0; i < transfers; ++i)
+        {
+            if (!wait_for(c.consumed_, i, yield, abandoned))
+                return {};
+            for (std::size_t j = 0; j < (blockSize / sizeof(std::uint64_t)); ++j)
+                block[j] = i;
+            c.produced_.value_.store(i + 1, std::memory_order_release);
+        }
+        if (!wait_for(c.consumed_, transfers, yield, abandoned))
+            return {};
+        auto bandwidthElapsed = tsc_clock::now() - start;
+
+        result r;
+        if (roundTrips > 0)
+            r.latency_ = static_cast<double>(latencyElapsed.count()) / (2.0 * roundTrips);
+        if ((transfers > 0) && (bandwidthElapsed.count() > 0))
+            r.bandwidth_ = (static_cast<double>(transfers) * blockSize * 1e9) / bandwidthElapsed.count();
+        return r;
+    }
+
+
+    //=========================================================================
+    result measure_threads
+    (
+        // both sides run as pinned thread_pool workers of this process
+        cpu_id initiatorCpu,
+        cpu_id responderCpu,
+        options const & opts
+    )
+    {
+        anonymous_mapping mapping({.size_ = channel_size(opts.blockSize_), .alignment_ = cache_line_size}, {});
+        if (!mapping.is_valid())
+            return {};
+        auto & c = *new (mapping.data()) channel{};
+        auto yield = (initiatorCpu == responderCpu);
+        result r;
+        {
+            thread_pool threadPool(
+                    {
+                        {
+                            .function_ = [&](auto const &){respond(c, opts.roundTrips_, opts.transfers_, opts.blockSize_, yield);},
+                            .cpuId_ = responderCpu
+                        },
+                        {
+                            .function_ = [&](auto const &){r = initiate(c, opts.roundTrips_, opts.transfers_, opts.blockSize_, yield, nullptr);},
+                            .cpuId_ = initiatorCpu
+                        }
+                    });
+            threadPool.wait_stop_complete();
+        }
+        return r;
+    }
+
+
+    //=========================================================================
+    result measure_processes
+    (
+        // the responder runs in a child process (this executable re-spawned
+        // in responder mode) which joins a shared_memory segment by path
+        char const * executable,
+        cpu_id initiatorCpu,
+        cpu_id responderCpu,
+        options const & opts
+    )
+    {
+        auto sharedMemory = shared_memory::create(
+                {
+                    .size_ = channel_size(opts.blockSize_),
+                    .ioMode_ = io_mode::read_write,
+                    .unlinkPolicy_ = shared_memory::unlink_policy::on_detach
+                },
+                {});
+        if (!sharedMemory.is_valid())
+            return {};
+        auto & c = *new (sharedMemory.data()) channel{};
+
+        std::ostringstream responderArgument;
+        responderArgument << "--responder=" << sharedMemory.path() << "," << responderCpu << "," << opts.roundTrips_ << ","
+                << opts.transfers_ << "," << opts.blockSize_ << "," << (initiatorCpu == responderCpu);
+        auto argument = responderArgument.str();
+        char * childArgs[] = {const_cast<char *>(executable), argument.data(), nullptr};
+        pid_t childProcessId;
+        if (::posix_spawn(&childProcessId, "/proc/self/exe", nullptr, nullptr, childArgs, environ) != 0)
+            return {};
+
+        // the responder may fail to start or die part way so rather than
+        // wait on the initiator indefinitely watch the child and abandon the
+        // measurement if it exits early or is not ready in time
+        static auto constexpr responder_ready_timeout = std::chrono::seconds(10);
+        static auto constexpr responder_poll_interval = std::chrono::milliseconds(1);
+
+        result r;
+        std::atomic<bool> abandoned{false};
+        std::atomic<bool> initiated{false};
+        std::int32_t status = 0;
+        auto reaped = false;
+        {
+            thread_pool threadPool(
+                    {
+                        {
+                            .function_ = [&](auto const &)
+                                    {
+                                        r = initiate(c, opts.roundTrips_, opts.transfers_, opts.blockSize_, (initiatorCpu == responderCpu), &abandoned);
+                                        initiated.store(true, std::memory_order_release);
+                                    },
+                            .cpuId_ = initiatorCpu
+                        }
+                    });
+            auto deadline = (std::chrono::steady_clock::now() + responder_ready_timeout);
+            while (!initiated.load(std::memory_order_acquire))
+            {
+                if (::waitpid(childProcessId, &status, WNOHANG) == childProcessId)
+                {
+                    reaped = true;
+                    abandoned.store(true, std::memory_order_release);
+                    break;
+                }
+                if ((c.ready_.value_.load(std::memory_order_acquire) == 0) && (std::chrono::steady_clock::now() > deadline))
+                {
+                    ::kill(childProcessId, SIGKILL);
+                    abandoned.store(true, std::memory_order_release);
+                    break;
+                }
+                std::this_thread::sleep_for(responder_poll_interval);
+            }
+            threadPool.wait_stop_complete();
+        }
+        if (!reaped)
+            ::waitpid(childProcessId, &status, 0);
+        return r;
+    }
+
+
+    //=========================================================================
+    int run_responder
+    (
+        // child process entry: --responder=path,cpu,roundTrips,transfers,blockSize,yield
+        std::string const & argument
+    )
+    {
+        std::vector<std::string> fields;
+        std::istringstream stream(argument);
+        for (std::string field; std::getline(stream, field, ','); )
+            fields.push_back(field);
+        if (fields.size() != 6)
+            return 1;
+
+        auto sharedMemory = shared_memory::join({.path_ = fields[0], .ioMode_ = io_mode::read_write}, {});
+        if (!sharedMemory.is_valid())
+            return 1;
+        auto & c = sharedMemory.as<channel>();
+        thread_pool threadPool(
+                {
+                    {
+                        .function_ = [&](auto const &){respond(c, std::stoull(fields[2]), std::stoull(fields[3]), std::stoull(fields[4]), (fields[5] == "1"));},
+                        .cpuId_ = static_cast<cpu_id>(std::stoull(fields[1]))
+                    }
+                });
+        threadPool.wait_stop_complete();
+        return 0;
+    }
+
+
+    //=========================================================================
+    void print_matrix
+    (
+        std::string const & title,
+        std::vector<cpu_id> const & cpus,
+        matrix const & m,
+        bool latency
+    )
+    {
+        std::cout << "\n" << title << "\n" << std::setw(6) << "";
+        for (auto cpu : cpus)
+            std::cout << std::setw(9) << cpu;
+        std::cout << "\n";
+        for (std::size_t i = 0; i < cpus.size(); ++i)
+        {
+            std::cout << std::setw(6) << cpus[i];
+            for (std::size_t j = 0; j < cpus.size(); ++j)
+            {
+                auto value = latency ? m[i][j].latency_ : (m[i][j].bandwidth_ / (1ull << 30));
+                if (std::isnan(value))
+                    std::cout << std::setw(9) << "-";
+                else
+                    std::cout << std::setw(9) << std::fixed << std::setprecision(1) << value;
+            }
+            std::cout << "\n";
+        }
+    }
+
+
+    //=========================================================================
+    void print_json_matrix
+    (
+        std::string const & name,
+        matrix const & m,
+        bool latency
+    )
+    {
+        std::cout << "    \"" << name << "\": [";
+        for (std::size_t i = 0; i < m.size(); ++i)
+        {
+            std::cout << (i ? ", [" : "[");
+            for (std::size_t j = 0; j < m[i].size(); ++j)
+            {
+                auto value = latency ? m[i][j].latency_ : m[i][j].bandwidth_;
+                std::cout << (j ? ", " : "");
+                if (std::isnan(value))
+                    std::cout << "null";
+                else
+                    std::cout << std::fixed << std::setprecision(2) << value;
+            }
+            std::cout << "]";
+        }
+        std::cout << "]";
+    }
+
+
+    struct placement
+    {
+        cpu_id  producer_;
+        cpu_id  consumer_;
+        double  latency_;
+        double  bandwidth_;
+        bool    threadSiblings_;
+    };
+
+
+    //=========================================================================
+    std::vector<placement> suggest_placement
+    (
+        // rank the off diagonal pairs by latency, using bandwidth to break ties
+        std::vector<cpu_id> const & cpus,
+        matrix const & m
+    )
+    {
+        std::vector<placement> placements;
+        auto const & topology = cpu_topology::get();
+        for (std::size_t i = 0; i < cpus.size(); ++i)
+            for (std::size_t j = 0; j < cpus.size(); ++j)
+                if ((i != j) && (!std::isnan(m[i][j].latency_)))
+                    placements.push_back({cpus[i], cpus[j], m[i][j].latency_, m[i][j].bandwidth_, topology.are_thread_siblings(cpus[i], cpus[j])});
+        std::sort(placements.begin(), placements.end(), [](auto const & a, auto const & b)
+                {
+                    if (a.latency_ != b.latency_)
+                        return (a.latency_ < b.latency_);
+                    return (a.bandwidth_ > b.bandwidth_);
+                });
+        return placements;
+    }
+
+
+    //=========================================================================
+    void print_usage
+    (
+        char const * name
+    )
+    {
+        std::cout << "usage: " << name << " [options]\n"
+                << "  --cpus=<list>          cpus to test (ie: 0-3,8).  default: all available\n"
+                << "  --round-trips=<n>      latency round trips per pair (default 100000)\n"
+                << "  --transfers=<n>        bandwidth blocks per pair (default 2000)\n"
+                << "  --block=<bytes>        bandwidth block size (default 65536)\n"
+                << "  --mode=<thread|process|both>\n"
+                << "  --include-diagonal     also measure each cpu against itself\n"
+                << "  --format=<text|json>\n";
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    options opts;
+    opts.cpus_ = get_available_cpus();
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        std::string arg = args[i];
+        auto value = arg.substr(arg.find('=') + 1);
+        if (arg.starts_with("--responder="))
+            return run_responder(value);
+        if (arg.starts_with("--cpus="))
+            opts.cpus_ = cpu_topology::parse_cpu_list(value);
+        else if (arg.starts_with("--round-trips="))
+            opts.roundTrips_ = std::stoull(value);
+        else if (arg.starts_with("--transfers="))
+            opts.transfers_ = std::stoull(value);
+        else if (arg.starts_with("--block="))
+            opts.blockSize_ = std::max<std::size_t>(cache_line_size, (std::stoull(value) / cache_line_size) * cache_line_size);
+        else if (arg.starts_with("--mode="))
+        {
+            opts.threadMode_ = ((value == "thread") || (value == "both"));
+            opts.processMode_ = ((value == "process") || (value == "both"));
+        }
+        else if (arg == "--include-diagonal")
+            opts.includeDiagonal_ = true;
+        else if (arg.starts_with("--format="))
+            opts.json_ = (value == "json");
+        else
+        {
+            print_usage(args[0]);
+            return (arg == "--help") ? 0 : 1;
+        }
+    }
+
+    auto const & cpus = opts.cpus_;
+    auto size = cpus.size();
+    matrix threadMatrix(size, std::vector<result>(size));
+    matrix processMatrix(size, std::vector<result>(size));
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        for (std::size_t j = 0; j < size; ++j)
+        {
+            if ((i == j) && (!opts.includeDiagonal_))
+                continue;
+            if (!opts.json_)
+                std::cerr << "\rmeasuring " << cpus[i] << " -> " << cpus[j] << "        " << std::flush;
+            if (opts.threadMode_)
+                threadMatrix[i][j] = measure_threads(cpus[i], cpus[j], opts);
+            if (opts.processMode_)
+                processMatrix[i][j] = measure_processes(args[0], cpus[i], cpus[j], opts);
+        }
+    }
+
+    auto placements = suggest_placement(cpus, opts.processMode_ ? processMatrix : threadMatrix);
+
+    if (opts.json_)
+    {
+        std::cout << "{\n  \"cpus\": [";
+        for (std::size_t i = 0; i < size; ++i)
+            std::cout << (i ? ", " : "") << cpus[i];
+        std::cout << "],\n  \"block_size\": " << opts.blockSize_ << ",\n  \"thread\": {\n";
+        print_json_matrix("latency_ns", threadMatrix, true);
+        std::cout << ",\n";
+        print_json_matrix("bandwidth_bytes_per_second", threadMatrix, false);
+        std::cout << "\n  },\n  \"process\": {\n";
+        print_json_matrix("latency_ns", processMatrix, true);
+        std::cout << ",\n";
+        print_json_matrix("bandwidth_bytes_per_second", processMatrix, false);
+        std::cout << "\n  },\n  \"suggested_placement\": [";
+        for (std::size_t i = 0; i < placements.size(); ++i)
+            std::cout << (i ? ",\n    " : "\n    ") << "{\"producer\": " << placements[i].producer_ << ", \"consumer\": " << placements[i].consumer_
+                    << ", \"latency_ns\": " << placements[i].latency_ << ", \"smt_siblings\": " << (placements[i].threadSiblings_ ? "true" : "false") << "}";
+        std::cout << "\n  ]\n}\n";
+        return 0;
+    }
+
+    std::cerr << "\r" << std::string(40, ' ') << "\r";
+    if (opts.threadMode_)
+    {
+        print_matrix("in process one way latency (ns) [row = initiator, column = responder]", cpus, threadMatrix, true);
+        print_matrix("in process bandwidth (GiB/s)", cpus, threadMatrix, false);
+    }
+    if (opts.processMode_)
+    {
+        print_matrix("cross process (shared_memory) one way latency (ns)", cpus, processMatrix, true);
+        print_matrix("cross process (shared_memory) bandwidth (GiB/s)", cpus, processMatrix, false);
+    }
+
+    std::cout << "\nsuggested producer/consumer placement (lowest latency first):\n";
+    for (std::size_t i = 0; i < std::min<std::size_t>(placements.size(), 8); ++i)
+        std::cout << "  producer cpu " << std::setw(4) << placements[i].producer_ << "  consumer cpu " << std::setw(4) << placements[i].consumer_
+                << std::fixed << std::setprecision(1) << "  " << placements[i].latency_ << "ns  " << (placements[i].bandwidth_ / (1ull << 30)) << "GiB/s"
+                << (placements[i].threadSiblings_ ? "  (smt siblings - shares a physical core)" : "") << "\n";
+    if (placements.empty())
+        std::cout << "  (need at least two cpus)\n";
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+
+namespace
+{
+
+    //=========================================================================
+    void print_usage
+    (
+        char const * name
+    )
+    {
+        std::cout << "usage: " << name << " [options] [list|reap]\n"
+                << "  --registry=<path>      registry segment (default " << bcpp::system::segment_registry::default_path << ")\n"
+                << "  --purpose=<purpose>    only list segments with this purpose\n"
+                << "  --dry-run              report what reap would unlink without unlinking\n"
+                << "  --dead-only            reap only segments whose owner has died\n";
+    }
+
+
+    //=========================================================================
+    void print_segments
+    (
+        std::vector<bcpp::system::segment_registry::segment_info> const & segments
+    )
+    {
+        auto now = std::chrono::system_clock::now();
+        std::cout << std::left << std::setw(32) << "NAME" << std::setw(20) << "PURPOSE"
+                << std::right << std::setw(8) << "PID" << std::setw(14) << "SIZE"
+                << std::setw(10) << "AGE(s)" << std::setw(12) << "LEASE(s)" << "  STATE\n";
+        for (auto const & segment : segments)
+        {
+            auto age = std::chrono::duration<double>(now - segment.createTime_).count();
+            auto leaseRemaining = std::chrono::duration<double>(segment.heartbeat_ + segment.leaseDuration_ - now).count();
+            std::cout << std::left << std::setw(32) << segment.name_ << std::setw(20) << segment.purpose_
+                    << std::right << std::setw(8) << segment.ownerProcessId_ << std::setw(14) << segment.size_
+                    << std::fixed << std::setprecision(1) << std::setw(10) << age << std::setw(12) << leaseRemaining
+                    << "  " << ((!segment.ownerAlive_) ? "dead" : (segment.leaseExpired_ ? "expired" : "live")) << "\n";
+        }
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    using namespace bcpp::system;
+
+    segment_registry::configuration config;
+    segment_registry::reap_configuration reapConfig;
+    std::string purpose;
+    std::string command = "list";
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        std::string arg = args[i];
+        auto value = arg.substr(arg.find('=') + 1);
+        if (arg.starts_with("--registry="))
+            config.path_ = value;
+        else if (arg.starts_with("--purpose="))
+            purpose = value;
+        else if (arg == "--dry-run")
+            reapConfig.dryRun_ = true;
+        else if (arg == "--dead-only")
+            reapConfig.reapExpiredLeases_ = false;
+        else if ((arg == "list") || (arg == "reap"))
+            command = arg;
+        else
+        {
+            print_usage(args[0]);
+            return (arg == "--help") ? 0 : 1;
+        }
+    }
+
+    auto registry = segment_registry::open(config);
+    if (!registry.is_valid())
+    {
+        std::cerr << "failed to open registry " << config.path_ << "\n";
+        return 1;
+    }
+
+    if (command == "reap")
+    {
+        auto reaped = registry.reap(reapConfig);
+        std::cout << (reapConfig.dryRun_ ? "would reap " : "reaped ") << reaped.size() << " segment(s)\n";
+        print_segments(reaped);
+    }
+    else
+    {
+        print_segments(purpose.empty() ? registry.list() : registry.find_by_purpose(purpose));
+    }
+    return 0;
+}
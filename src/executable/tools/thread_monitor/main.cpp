@@ -0,0 +1,285 @@
+#include <library/system.h>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <map>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+
+namespace
+{
+
+    struct kernel_thread_stats
+    {
+        std::int32_t    processor_{-1};
+        std::uint64_t   minorFaults_{0};
+        std::uint64_t   majorFaults_{0};
+        std::uint64_t   voluntarySwitches_{0};
+        std::uint64_t   involuntarySwitches_{0};
+    };
+
+
+    struct previous_sample
+    {
+        std::uint64_t   tasksRun_{0};
+        std::uint64_t   busyNanoseconds_{0};
+        std::uint64_t   idleNanoseconds_{0};
+        std::uint64_t   minorFaults_{0};
+        std::uint64_t   majorFaults_{0};
+        std::uint64_t   voluntarySwitches_{0};
+        std::uint64_t   involuntarySwitches_{0};
+    };
+
+
+    //=========================================================================
+    kernel_thread_stats read_kernel_thread_stats
+    (
+        // getrusage(RUSAGE_THREAD) only reports on the calling thread so the
+        // observed threads' fault and context switch counts come from /proc
+        std::int32_t processId,
+        std::int32_t threadId
+    )
+    {
+        kernel_thread_stats result;
+        auto taskPath = std::filesystem::path("/proc") / std::to_string(processId) / "task" / std::to_string(threadId);
+
+        if (std::ifstream statFile(taskPath / "stat"); statFile)
+        {
+            std::string line;
+            std::getline(statFile, line);
+            // the command name may contain spaces so parse from the closing parenthesis
+            if (auto pos = line.rfind(')'); pos != std::string::npos)
+            {
+                std::istringstream stream(line.substr(pos + 2));
+                std::vector<std::string> fields;
+                for (std::string field; stream >> field; )
+                    fields.push_back(field);
+                // fields[0] is field 3 (state) in proc(5)
+                if (fields.size() > 36)
+                {
+                    result.minorFaults_ = std::stoull(fields[7]);
+                    result.majorFaults_ = std::stoull(fields[9]);
+                    result.processor_ = std::stoi(fields[36]);
+                }
+            }
+        }
+
+        if (std::ifstream statusFile(taskPath / "status"); statusFile)
+        {
+            for (std::string line; std::getline(statusFile, line); )
+            {
+                if (line.starts_with("voluntary_ctxt_switches:"))
+                    result.voluntarySwitches_ = std::stoull(line.substr(line.find(':') + 1));
+                else if (line.starts_with("nonvoluntary_ctxt_switches:"))
+                    result.involuntarySwitches_ = std::stoull(line.substr(line.find(':') + 1));
+            }
+        }
+        return result;
+    }
+
+
+    //=========================================================================
+    void refresh_segments
+    (
+        // (re)join the requested segments.  with no explicit segments every
+        // file in /dev/shm named with the stats segment prefix is joined and
+        // segments which have since been unlinked are dropped.  segments are
+        // joined read only, never unlinked, and kept mapped between refreshes.
+        // paths which are not valid stats segments are remembered and only
+        // probed again after the retry interval (ie: a segment which was
+        // still being initialized).
+        std::vector<std::string> const & paths,
+        std::map<std::string, bcpp::system::stats_segment> & segments,
+        std::map<std::string, std::chrono::steady_clock::time_point> & rejected
+    )
+    {
+        static auto constexpr retry_interval = std::chrono::seconds(5);
+
+        std::vector<std::string> candidates = paths;
+        if (paths.empty())
+        {
+            std::error_code errorCode;
+            for (auto const & entry : std::filesystem::directory_iterator("/dev/shm", errorCode))
+                if (auto name = entry.path().filename().string(); name.starts_with(bcpp::system::stats_segment::path_prefix))
+                    candidates.push_back(name);
+            auto absent = [&](auto const & value)
+                    {
+                        return (std::find(candidates.begin(), candidates.end(), value.first) == candidates.end());
+                    };
+            std::erase_if(segments, absent);
+            std::erase_if(rejected, absent);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (auto const & path : candidates)
+        {
+            if (auto iter = segments.find(path); (iter != segments.end()) && (iter->second.is_valid()))
+                continue;
+            if (auto iter = rejected.find(path); (iter != rejected.end()) && ((now - iter->second) < retry_interval))
+                continue;
+            if (auto statsSegment = bcpp::system::stats_segment::join({.path_ = path}); statsSegment.is_valid())
+            {
+                segments[path] = std::move(statsSegment);
+                rejected.erase(path);
+            }
+            else
+            {
+                segments.erase(path);
+                rejected[path] = now;
+            }
+        }
+    }
+
+
+    //=========================================================================
+    std::string format_nanoseconds
+    (
+        std::uint64_t nanoseconds
+    )
+    {
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(1);
+        if (nanoseconds < 10'000)
+            stream << nanoseconds << "ns";
+        else if (nanoseconds < 10'000'000)
+            stream << (nanoseconds / 1'000.0) << "us";
+        else
+            stream << (nanoseconds / 1'000'000.0) << "ms";
+        return stream.str();
+    }
+
+
+    //=========================================================================
+    void print_usage
+    (
+        char const * name
+    )
+    {
+        std::cout << "usage: " << name << " [-i interval_ms] [-n iterations] [segment ...]\n"
+                << "  displays per thread statistics published through stats segments.\n"
+                << "  with no segments given every stats segment in /dev/shm (named "
+                << bcpp::system::stats_segment::path_prefix << "*) is shown.\n";
+    }
+
+} // namespace
+
+
+//=============================================================================
+int main
+(
+    int argc,
+    char ** args
+)
+{
+    using namespace bcpp::system;
+
+    auto interval = std::chrono::milliseconds(100);
+    std::int64_t iterations = -1;
+    std::vector<std::string> paths;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        std::string arg = args[i];
+        if ((arg == "-i") && ((i + 1) < argc))
+            interval = std::chrono::milliseconds(std::stoll(args[++i]));
+        else if ((arg == "-n") && ((i + 1) < argc))
+            iterations = std::stoll(args[++i]);
+        else if ((arg == "-h") || (arg == "--help"))
+        {
+            print_usage(args[0]);
+            return 0;
+        }
+        else
+            paths.push_back(arg);
+    }
+
+    std::map<std::string, stats_segment> segments;
+    std::map<std::string, std::chrono::steady_clock::time_point> rejected;
+    std::map<std::pair<std::int32_t, std::int32_t>, previous_sample> previousSamples;
+    auto previousTime = std::chrono::steady_clock::now();
+
+    for (std::int64_t iteration = 0; (iterations < 0) || (iteration < iterations); ++iteration)
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsedSeconds = std::max(std::chrono::duration<double>(now - previousTime).count(), 1e-9);
+        previousTime = now;
+
+        refresh_segments(paths, segments, rejected);
+
+        std::ostringstream out;
+        out << "\033[H\033[2J";
+        out << "thread_monitor - " << segments.size() << " segment(s), refresh " << interval.count() << "ms\n\n";
+        out << std::left
+                << std::setw(8) << "PID" << std::setw(8) << "TID" << std::setw(16) << "NAME"
+                << std::right
+                << std::setw(5) << "PIN" << std::setw(5) << "CPU" << std::setw(7) << "RUN%"
+                << std::setw(10) << "TASKS/s" << std::setw(8) << "QUEUE"
+                << std::setw(10) << "P50" << std::setw(10) << "P99" << std::setw(10) << "P99.9" << std::setw(10) << "MAX"
+                << std::setw(8) << "MINFLT" << std::setw(8) << "MAJFLT" << std::setw(8) << "VCSW" << std::setw(8) << "ICSW"
+                << "\n";
+
+        std::map<std::pair<std::int32_t, std::int32_t>, previous_sample> currentSamples;
+        for (auto const & [path, statsSegment] : segments)
+        {
+            auto const & header = statsSegment.get_header();
+            out << "[" << path << "] " << header.processName_ << "\n";
+            for (auto const & threadStats : statsSegment.threads())
+            {
+                if (threadStats.state_.load(std::memory_order_acquire) != thread_stats::slot_state::active)
+                    continue;
+
+                auto key = std::make_pair(threadStats.processId_, threadStats.threadId_);
+                auto kernelStats = read_kernel_thread_stats(threadStats.processId_, threadStats.threadId_);
+                previous_sample current
+                {
+                    .tasksRun_ = threadStats.tasksRun_.load(std::memory_order_relaxed),
+                    .busyNanoseconds_ = threadStats.busyNanoseconds_.load(std::memory_order_relaxed),
+                    .idleNanoseconds_ = threadStats.idleNanoseconds_.load(std::memory_order_relaxed),
+                    .minorFaults_ = kernelStats.minorFaults_,
+                    .majorFaults_ = kernelStats.majorFaults_,
+                    .voluntarySwitches_ = kernelStats.voluntarySwitches_,
+                    .involuntarySwitches_ = kernelStats.involuntarySwitches_
+                };
+                auto previous = previousSamples.contains(key) ? previousSamples[key] : current;
+                currentSamples[key] = current;
+
+                auto busy = current.busyNanoseconds_ - previous.busyNanoseconds_;
+                auto idle = current.idleNanoseconds_ - previous.idleNanoseconds_;
+                auto runRatio = ((busy + idle) > 0) ? ((100.0 * busy) / (busy + idle)) : 0.0;
+                auto cpuId = threadStats.cpuId_.load(std::memory_order_relaxed);
+                auto const & latency = threadStats.latency_;
+
+                out << std::left
+                        << std::setw(8) << threadStats.processId_ << std::setw(8) << threadStats.threadId_
+                        << std::setw(16) << std::string(threadStats.name_, strnlen(threadStats.name_, thread_stats::max_name_length))
+                        << std::right
+                        << std::setw(5) << ((cpuId >= 0) ? std::to_string(cpuId) : "-")
+                        << std::setw(5) << kernelStats.processor_
+                        << std::setw(7) << std::fixed << std::setprecision(1) << runRatio
+                        << std::setw(10) << std::setprecision(0) << ((current.tasksRun_ - previous.tasksRun_) / elapsedSeconds)
+                        << std::setw(8) << threadStats.queueDepth_.load(std::memory_order_relaxed)
+                        << std::setw(10) << format_nanoseconds(latency.percentile(50.0))
+                        << std::setw(10) << format_nanoseconds(latency.percentile(99.0))
+                        << std::setw(10) << format_nanoseconds(latency.percentile(99.9))
+                        << std::setw(10) << format_nanoseconds(latency.maximum())
+                        << std::setw(8) << (current.minorFaults_ - previous.minorFaults_)
+                        << std::setw(8) << (current.majorFaults_ - previous.majorFaults_)
+                        << std::setw(8) << (current.voluntarySwitches_ - previous.voluntarySwitches_)
+                        << std::setw(8) << (current.involuntarySwitches_ - previous.involuntarySwitches_)
+                        << "\n";
+            }
+        }
+        previousSamples = std::move(currentSamples);
+        std::cout << out.str() << std::flush;
+        std::this_thread::sleep_for(interval);
+    }
+    return 0;
+}
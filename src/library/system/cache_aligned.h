@@ -0,0 +1,71 @@
+#pragma once
+
+#include "./cache_line.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // cache_aligned
+    //
+    // T aligned to (and padded out to a multiple of) a cache line so that it
+    // never shares a line with a neighbour.  use an alignment of two cache
+    // lines for values written by different cpus on hardware whose adjacent
+    // line prefetcher fetches lines in pairs.
+    //
+    //      cache_aligned<std::atomic<std::size_t>> counter_;
+    //      std::vector<cache_aligned<std::uint64_t>> perWorkerTotals_;
+    //=========================================================================
+    template <typename T, std::size_t N = cache_line_size>
+    class alignas(N) cache_aligned
+    {
+    public:
+
+        static_assert((N >= cache_line_size) && ((N & (N - 1)) == 0), "cache_aligned alignment must be a power of two of at least a cache line");
+
+        using value_type = T;
+
+        cache_aligned() = default;
+
+        template <typename ... Args>
+        requires std::is_constructible_v<T, Args ...>
+        explicit cache_aligned
+        (
+            std::in_place_t,
+            Args && ... args
+        ):
+            value_(std::forward<Args>(args) ...)
+        {
+        }
+
+        template <typename U>
+        requires (std::is_constructible_v<T, U> && (!std::is_same_v<std::remove_cvref_t<U>, cache_aligned>))
+        cache_aligned
+        (
+            U && value
+        ):
+            value_(std::forward<U>(value))
+        {
+        }
+
+        T & get() noexcept {return value_;}
+        T const & get() const noexcept {return value_;}
+
+        T & operator * () noexcept {return value_;}
+        T const & operator * () const noexcept {return value_;}
+
+        T * operator -> () noexcept {return &value_;}
+        T const * operator -> () const noexcept {return &value_;}
+
+    private:
+
+        T   value_{};
+
+    }; // class cache_aligned
+
+} // namespace bcpp::system
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+
+namespace bcpp::system
+{
+
+    static std::size_t constexpr cache_line_size = 64;
+
+} // namespace bcpp::system
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // latency_histogram
+    //
+    // log-linear (hdr style) histogram of nanosecond values with 32 linear
+    // sub buckets per power of two (~3% relative precision) up to ~18 minutes.
+    // it is written by a single owner thread without read-modify-write
+    // instructions and can be read concurrently by any number of readers,
+    // including readers in other processes when placed in shared memory.
+    //=========================================================================
+    class latency_histogram
+    {
+    public:
+
+        static std::size_t constexpr sub_bucket_bits = 5;
+        static std::size_t constexpr sub_bucket_count = (1ull << sub_bucket_bits);
+        static std::size_t constexpr maximum_exponent = 40;
+        static std::size_t constexpr bucket_count = sub_bucket_count + ((maximum_exponent - sub_bucket_bits + 1) * sub_bucket_count);
+
+        void record
+        (
+            std::uint64_t
+        ) noexcept;
+
+        template <typename R, typename P>
+        void record
+        (
+            std::chrono::duration<R, P>
+        ) noexcept;
+
+        std::uint64_t count() const noexcept;
+
+        std::uint64_t minimum() const noexcept;
+
+        std::uint64_t maximum() const noexcept;
+
+        double mean() const noexcept;
+
+        std::uint64_t percentile
+        (
+            double
+        ) const noexcept;
+
+        void reset() noexcept;
+
+        static std::size_t constexpr to_bucket
+        (
+            std::uint64_t
+        ) noexcept;
+
+        static std::uint64_t constexpr from_bucket
+        (
+            std::size_t
+        ) noexcept;
+
+    private:
+
+        static void add
+        (
+            std::atomic<std::uint64_t> &,
+            std::uint64_t
+        ) noexcept;
+
+        std::atomic<std::uint64_t>                          count_{0};
+        std::atomic<std::uint64_t>                          sum_{0};
+        std::atomic<std::uint64_t>                          minimum_{std::numeric_limits<std::uint64_t>::max()};
+        std::atomic<std::uint64_t>                          maximum_{0};
+        std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+
+    }; // class latency_histogram
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+inline void bcpp::system::latency_histogram::add
+(
+    // single writer increment.  avoids the locked instruction of fetch_add
+    std::atomic<std::uint64_t> & value,
+    std::uint64_t amount
+) noexcept
+{
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+constexpr std::size_t bcpp::system::latency_histogram::to_bucket
+(
+    std::uint64_t value
+) noexcept
+{
+    if (value < sub_bucket_count)
+        return static_cast<std::size_t>(value);
+    auto exponent = static_cast<std::size_t>(std::bit_width(value) - 1);
+    if (exponent > maximum_exponent)
+        return (bucket_count - 1);
+    auto subBucket = static_cast<std::size_t>(value >> (exponent - sub_bucket_bits)) - sub_bucket_count;
+    return (sub_bucket_count + ((exponent - sub_bucket_bits) * sub_bucket_count) + subBucket);
+}
+
+
+//=============================================================================
+constexpr std::uint64_t bcpp::system::latency_histogram::from_bucket
+(
+    // lowest value which maps to the bucket
+    std::size_t bucket
+) noexcept
+{
+    if (bucket < sub_bucket_count)
+        return bucket;
+    auto exponent = ((bucket - sub_bucket_count) / sub_bucket_count) + sub_bucket_bits;
+    auto subBucket = (bucket - sub_bucket_count) % sub_bucket_count;
+    return ((sub_bucket_count + subBucket) << (exponent - sub_bucket_bits));
+}
+
+
+//=============================================================================
+inline void bcpp::system::latency_histogram::record
+(
+    std::uint64_t value
+) noexcept
+{
+    add(buckets_[to_bucket(value)], 1);
+    add(sum_, value);
+    if (value < minimum_.load(std::memory_order_relaxed))
+        minimum_.store(value, std::memory_order_relaxed);
+    if (value > maximum_.load(std::memory_order_relaxed))
+        maximum_.store(value, std::memory_order_relaxed);
+    // count is published last so that readers never see more samples than buckets hold
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+
+//=============================================================================
+template <typename R, typename P>
+inline void bcpp::system::latency_histogram::record
+(
+    std::chrono::duration<R, P> duration
+) noexcept
+{
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    record(static_cast<std::uint64_t>(std::max<decltype(nanoseconds)>(nanoseconds, 0)));
+}
+
+
+//=============================================================================
+inline std::uint64_t bcpp::system::latency_histogram::count
+(
+) const noexcept
+{
+    return count_.load(std::memory_order_acquire);
+}
+
+
+//=============================================================================
+inline std::uint64_t bcpp::system::latency_histogram::minimum
+(
+) const noexcept
+{
+    return (count() ? minimum_.load(std::memory_order_relaxed) : 0);
+}
+
+
+//=============================================================================
+inline std::uint64_t bcpp::system::latency_histogram::maximum
+(
+) const noexcept
+{
+    return maximum_.load(std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+inline double bcpp::system::latency_histogram::mean
+(
+) const noexcept
+{
+    auto count = this->count();
+    return (count ? (static_cast<double>(sum_.load(std::memory_order_relaxed)) / count) : 0.0);
+}
+
+
+//=============================================================================
+inline std::uint64_t bcpp::system::latency_histogram::percentile
+(
+    // percentile in range [0.0, 100.0]
+    double percentile
+) const noexcept
+{
+    std::uint64_t total = 0;
+    for (auto const & bucket : buckets_)
+        total += bucket.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+    auto target = static_cast<std::uint64_t>((std::clamp(percentile, 0.0, 100.0) / 100.0) * total);
+    target = std::max<std::uint64_t>(target, 1);
+    std::uint64_t accumulated = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i)
+    {
+        accumulated += buckets_[i].load(std::memory_order_relaxed);
+        if (accumulated >= target)
+            return std::min(from_bucket(i), maximum());
+    }
+    return maximum();
+}
+
+
+//=============================================================================
+inline void bcpp::system::latency_histogram::reset
+(
+    // owner thread only
+) noexcept
+{
+    count_.store(0, std::memory_order_release);
+    sum_.store(0, std::memory_order_relaxed);
+    minimum_.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    maximum_.store(0, std::memory_order_relaxed);
+    for (auto & bucket : buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+}
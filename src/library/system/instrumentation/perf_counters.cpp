@@ -0,0 +1,212 @@
+#include "./perf_counters.h"
+
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    //=========================================================================
+    std::int32_t open_event
+    (
+        // count events of the calling thread on any cpu
+        std::uint32_t type,
+        std::uint64_t config,
+        std::int32_t groupFileDescriptor,
+        bool excludeKernel
+    )
+    {
+        perf_event_attr attributes{};
+        attributes.type = type;
+        attributes.size = sizeof(attributes);
+        attributes.config = config;
+        attributes.read_format = PERF_FORMAT_GROUP;
+        attributes.exclude_kernel = excludeKernel;
+        attributes.exclude_hv = 1;
+        return static_cast<std::int32_t>(::syscall(SYS_perf_event_open, &attributes, 0, -1, groupFileDescriptor, PERF_FLAG_FD_CLOEXEC));
+    }
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::perf_counters::perf_counters
+(
+):
+    perf_counters(configuration{})
+{
+}
+
+
+//=============================================================================
+bcpp::system::perf_counters::perf_counters
+(
+    configuration const & config
+)
+{
+    if (config.hardware_)
+        open_group(hardwareEvents_, PERF_TYPE_HARDWARE, {
+                {counter::cycles, PERF_COUNT_HW_CPU_CYCLES},
+                {counter::instructions, PERF_COUNT_HW_INSTRUCTIONS},
+                {counter::cache_misses, PERF_COUNT_HW_CACHE_MISSES},
+                {counter::branch_misses, PERF_COUNT_HW_BRANCH_MISSES}});
+    if (config.software_)
+        open_group(softwareEvents_, PERF_TYPE_SOFTWARE, {
+                {counter::task_clock, PERF_COUNT_SW_TASK_CLOCK},
+                {counter::page_faults, PERF_COUNT_SW_PAGE_FAULTS},
+                {counter::context_switches, PERF_COUNT_SW_CONTEXT_SWITCHES}});
+
+    #if defined(__x86_64__) || defined(__i386__)
+        if ((!config.userRead_) || (hardwareEvents_.empty()))
+            return;
+        // rdpmc is allowed once the events are mapped if the kernel says so
+        auto pageSize = static_cast<std::size_t>(::getpagesize());
+        userRead_ = true;
+        for (auto & e : hardwareEvents_)
+        {
+            if (auto * page = ::mmap(nullptr, pageSize, PROT_READ, MAP_SHARED, e.fileDescriptor_.get(), 0); page != MAP_FAILED)
+                e.page_ = static_cast<perf_event_mmap_page *>(page);
+            userRead_ = ((userRead_) && (e.page_ != nullptr) && (e.page_->cap_user_rdpmc));
+        }
+    #endif
+}
+
+
+//=============================================================================
+bcpp::system::perf_counters::~perf_counters
+(
+)
+{
+    auto pageSize = static_cast<std::size_t>(::getpagesize());
+    for (auto & e : hardwareEvents_)
+        if (e.page_ != nullptr)
+            ::munmap(e.page_, pageSize);
+}
+
+
+//=============================================================================
+void bcpp::system::perf_counters::open_group
+(
+    // the first event leads the group.  without it the group is not opened.
+    // other events which can not be opened are left out
+    std::vector<event> & events,
+    std::uint32_t type,
+    std::initializer_list<std::pair<counter, std::uint64_t>> counters
+)
+{
+    for (auto const & [c, config] : counters)
+    {
+        // hardware events count user mode only.  software events (page faults
+        // and context switches are taken in the kernel) include the kernel
+        // where perf_event_paranoid allows it
+        auto groupFileDescriptor = events.empty() ? -1 : events.front().fileDescriptor_.get();
+        file_descriptor fileDescriptor(open_event(type, config, groupFileDescriptor, (type == PERF_TYPE_HARDWARE)));
+        if ((!fileDescriptor.is_valid()) && (type != PERF_TYPE_HARDWARE))
+            fileDescriptor = file_descriptor(open_event(type, config, groupFileDescriptor, true));
+        if (fileDescriptor.is_valid())
+            events.push_back({.counter_ = c, .fileDescriptor_ = std::move(fileDescriptor)});
+        else if (events.empty())
+            return;
+    }
+}
+
+
+//=============================================================================
+void bcpp::system::perf_counters::read_group
+(
+    // one read of the leader returns the count of every event of the group
+    // (in the order in which they were opened)
+    std::vector<event> const & events,
+    sample & result
+) const noexcept
+{
+    std::uint64_t values[1 + counter_count];
+    auto size = ::read(events.front().fileDescriptor_.get(), values, sizeof(values));
+    if (size < static_cast<ssize_t>(sizeof(std::uint64_t)))
+        return;
+    auto count = std::min<std::size_t>({values[0], events.size(), (static_cast<std::size_t>(size) / sizeof(std::uint64_t)) - 1});
+    for (std::size_t i = 0; i < count; ++i)
+        result.values_[static_cast<std::size_t>(events[i].counter_)] = values[1 + i];
+}
+
+
+//=============================================================================
+bool bcpp::system::perf_counters::is_valid
+(
+) const
+{
+    return ((!hardwareEvents_.empty()) || (!softwareEvents_.empty()));
+}
+
+
+//=============================================================================
+bool bcpp::system::perf_counters::is_available
+(
+    counter c
+) const
+{
+    auto has = [c](auto const & events)
+            {
+                return std::any_of(events.begin(), events.end(), [c](auto const & e){return (e.counter_ == c);});
+            };
+    return ((has(hardwareEvents_)) || (has(softwareEvents_)));
+}
+
+
+//=============================================================================
+bool bcpp::system::perf_counters::is_user_read
+(
+) const
+{
+    return userRead_;
+}
+
+
+//=============================================================================
+std::string_view bcpp::system::perf_counters::name
+(
+    counter c
+)
+{
+    switch (c)
+    {
+        case counter::cycles: return "cycles";
+        case counter::instructions: return "instructions";
+        case counter::cache_misses: return "cache_misses";
+        case counter::branch_misses: return "branch_misses";
+        case counter::task_clock: return "task_clock";
+        case counter::page_faults: return "page_faults";
+        case counter::context_switches: return "context_switches";
+    }
+    return "unknown";
+}
+
+
+//=============================================================================
+auto bcpp::system::perf_counters::instrument
+(
+    thread_pool::thread_configuration config,
+    configuration const & counterConfiguration,
+    report_handler reportHandler
+) -> thread_pool::thread_configuration
+{
+    auto attach = [counterConfiguration]
+            (
+            )
+            {
+                detail::currentPerfCounters = std::make_unique<perf_counters>(counterConfiguration);
+            };
+    auto detach = [name = config.name_, reportHandler = std::move(reportHandler)]
+            (
+            )
+            {
+                if ((reportHandler) && (current() != nullptr))
+                    reportHandler(name, current()->read());
+                detail::currentPerfCounters.reset();
+            };
+    return thread_pool::wrap_handlers(std::move(config), std::move(attach), std::move(detach));
+}
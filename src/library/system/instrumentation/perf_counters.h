@@ -0,0 +1,388 @@
+#pragma once
+
+#include <library/system/threading/thread_pool.h>
+#include <include/file_descriptor.h>
+#include <include/non_copyable.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <linux/perf_event.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // perf_counters
+    //
+    // counts events of the calling thread (perf_event_open) in two groups:
+    //
+    //  hardware - cycles, instructions, cache misses and branch misses.
+    //             where the kernel allows it (cap_user_rdpmc) the counters
+    //             are read in user space with rdpmc (a few nanoseconds a
+    //             counter) rather than with a system call.
+    //  software - task clock (nanoseconds on cpu), page faults and context
+    //             switches.  read with one system call for the group.
+    //
+    // where the pmu is not accessible (ie: a virtual machine or a restrictive
+    // perf_event_paranoid) only the software group is opened.  counters which
+    // can not be opened read as zero (see is_available()).  hardware events
+    // are counted in user mode only.  counts are not scaled for multiplexing.
+    //
+    // the counters belong to the thread which constructed them and may only
+    // be read by it.  instrument() gives each thread_pool worker its own
+    // (see current()) and perf_scope reports the deltas of a scope.  for the
+    // cheapest scopes open the hardware group only (software_ = false) so
+    // that no read needs a system call.
+    //=========================================================================
+    class perf_counters :
+        non_copyable
+    {
+    public:
+
+        enum class counter : std::size_t
+        {
+            cycles,
+            instructions,
+            cache_misses,
+            branch_misses,
+            task_clock,
+            page_faults,
+            context_switches
+        };
+
+        static std::size_t constexpr counter_count = 7;
+
+        struct configuration
+        {
+            bool    hardware_{true};
+            bool    software_{true};
+            bool    userRead_{true};        // rdpmc where allowed
+        };
+
+        struct sample
+        {
+            std::uint64_t operator[]
+            (
+                counter
+            ) const noexcept;
+
+            sample operator -
+            (
+                sample const &
+            ) const noexcept;
+
+            std::array<std::uint64_t, counter_count>    values_{};
+        };
+
+        // called with the totals of a worker when it terminates
+        using report_handler = std::function<void(std::string_view, sample const &)>;
+
+        perf_counters();
+
+        explicit perf_counters
+        (
+            configuration const &
+        );
+
+        ~perf_counters();
+
+        // false if no counter could be opened
+        bool is_valid() const;
+
+        bool is_available
+        (
+            counter
+        ) const;
+
+        // true if the hardware counters are read with rdpmc
+        bool is_user_read() const;
+
+        // the counts since construction.  the owning thread only
+        sample read() const noexcept;
+
+        static std::string_view name
+        (
+            counter
+        );
+
+        // the counters of the calling thread (see instrument()).  nullptr if none
+        static perf_counters * current() noexcept;
+
+        // wrap the thread configuration so that the worker opens its counters
+        // before the initialize handler runs and reports (and closes) them
+        // when it exits (see thread_pool::wrap_handlers)
+        static thread_pool::thread_configuration instrument
+        (
+            thread_pool::thread_configuration,
+            configuration const &,
+            report_handler = nullptr
+        );
+
+    private:
+
+        struct event
+        {
+            counter                 counter_;
+            file_descriptor         fileDescriptor_;
+            perf_event_mmap_page *  page_{nullptr};
+        };
+
+        void open_group
+        (
+            std::vector<event> &,
+            std::uint32_t,
+            std::initializer_list<std::pair<counter, std::uint64_t>>
+        );
+
+        void read_group
+        (
+            std::vector<event> const &,
+            sample &
+        ) const noexcept;
+
+        static bool read_user
+        (
+            perf_event_mmap_page const *,
+            std::uint64_t &
+        ) noexcept;
+
+        std::vector<event>      hardwareEvents_;
+
+        std::vector<event>      softwareEvents_;
+
+        bool                    userRead_{false};
+
+    }; // class perf_counters
+
+
+    //=========================================================================
+    // perf_scope_stats
+    //
+    // the sum of the counter deltas of the scopes recorded into it.  written
+    // by one thread (plain relaxed stores) and readable by any.
+    //=========================================================================
+    struct perf_scope_stats
+    {
+        void record
+        (
+            perf_counters::sample const &
+        ) noexcept;
+
+        std::uint64_t count() const noexcept;
+
+        perf_counters::sample total() const noexcept;
+
+        std::atomic<std::uint64_t>                                          count_{0};
+        std::array<std::atomic<std::uint64_t>, perf_counters::counter_count> totals_{};
+
+    }; // struct perf_scope_stats
+
+
+    //=========================================================================
+    // perf_scope
+    //
+    // records the counter deltas of the scope (using the calling thread's
+    // perf_counters::current()) into a perf_scope_stats.
+    //=========================================================================
+    class perf_scope
+    {
+    public:
+
+        perf_scope
+        (
+            perf_scope_stats *
+        ) noexcept;
+
+        ~perf_scope();
+
+    private:
+
+        perf_scope_stats *          stats_;
+
+        perf_counters const *       counters_;
+
+        perf_counters::sample       start_;
+
+    }; // class perf_scope
+
+} // namespace bcpp::system
+
+
+#define BCPP_PERF_SCOPE_CONCAT_(a, b) a##b
+#define BCPP_PERF_SCOPE_NAME_(line) BCPP_PERF_SCOPE_CONCAT_(bcppPerfScope_, line)
+
+// record the counter deltas of the enclosing scope into the given perf_scope_stats
+#define BCPP_PERF_SCOPE(stats) \
+        ::bcpp::system::perf_scope BCPP_PERF_SCOPE_NAME_(__LINE__)(&(stats))
+
+
+namespace bcpp::system::detail
+{
+    inline thread_local std::unique_ptr<perf_counters> currentPerfCounters;
+}
+
+
+//=============================================================================
+inline std::uint64_t bcpp::system::perf_counters::sample::operator[]
+(
+    counter c
+) const noexcept
+{
+    return values_[static_cast<std::size_t>(c)];
+}
+
+
+//=============================================================================
+inline auto bcpp::system::perf_counters::sample::operator -
+(
+    sample const & other
+) const noexcept -> sample
+{
+    sample result;
+    for (std::size_t i = 0; i < counter_count; ++i)
+        result.values_[i] = (values_[i] - other.values_[i]);
+    return result;
+}
+
+
+//=============================================================================
+inline auto bcpp::system::perf_counters::current
+(
+) noexcept -> perf_counters *
+{
+    return detail::currentPerfCounters.get();
+}
+
+
+//=============================================================================
+inline bool bcpp::system::perf_counters::read_user
+(
+    // read a counter with rdpmc under the seqlock of its mmap page.  false if
+    // the counter is not currently on the pmu (the caller reads it with a
+    // system call instead)
+    perf_event_mmap_page const * page,
+    std::uint64_t & value
+) noexcept
+{
+    #if defined(__x86_64__) || defined(__i386__)
+        while (true)
+        {
+            perf_event_mmap_page const volatile * p = page;
+            auto sequence = p->lock;
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            auto index = p->index;
+            auto offset = p->offset;
+            if (index == 0)
+                return false;
+            auto width = p->pmc_width;
+            auto count = static_cast<std::int64_t>(__rdpmc(static_cast<std::int32_t>(index - 1)));
+            // sign extend from the width of the counter
+            count = ((count << (64 - width)) >> (64 - width));
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            if (p->lock == sequence)
+            {
+                value = static_cast<std::uint64_t>(offset + count);
+                return true;
+            }
+        }
+    #else
+        return false;
+    #endif
+}
+
+
+//=============================================================================
+inline auto bcpp::system::perf_counters::read
+(
+) const noexcept -> sample
+{
+    sample result;
+    if (userRead_)
+    {
+        for (auto const & e : hardwareEvents_)
+        {
+            if (!read_user(e.page_, result.values_[static_cast<std::size_t>(e.counter_)]))
+            {
+                read_group(hardwareEvents_, result);
+                break;
+            }
+        }
+    }
+    else if (!hardwareEvents_.empty())
+    {
+        read_group(hardwareEvents_, result);
+    }
+    if (!softwareEvents_.empty())
+        read_group(softwareEvents_, result);
+    return result;
+}
+
+
+//=============================================================================
+inline void bcpp::system::perf_scope_stats::record
+(
+    // single writer
+    perf_counters::sample const & delta
+) noexcept
+{
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < perf_counters::counter_count; ++i)
+        totals_[i].store(totals_[i].load(std::memory_order_relaxed) + delta.values_[i], std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+inline std::uint64_t bcpp::system::perf_scope_stats::count
+(
+) const noexcept
+{
+    return count_.load(std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+inline auto bcpp::system::perf_scope_stats::total
+(
+) const noexcept -> perf_counters::sample
+{
+    perf_counters::sample result;
+    for (std::size_t i = 0; i < perf_counters::counter_count; ++i)
+        result.values_[i] = totals_[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+
+//=============================================================================
+inline bcpp::system::perf_scope::perf_scope
+(
+    perf_scope_stats * stats
+) noexcept :
+    stats_(stats),
+    counters_(stats ? perf_counters::current() : nullptr),
+    start_(counters_ ? counters_->read() : perf_counters::sample())
+{
+}
+
+
+//=============================================================================
+inline bcpp::system::perf_scope::~perf_scope
+(
+)
+{
+    if (counters_ != nullptr)
+        stats_->record(counters_->read() - start_);
+}
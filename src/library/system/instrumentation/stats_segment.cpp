@@ -0,0 +1,366 @@
+#include "./stats_segment.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+
+namespace
+{
+
+    using header = bcpp::system::stats_segment::header;
+
+    // the segments created by this process which have yet to be destroyed.
+    // a slot is written by claim or release only while its segment is listed
+    std::mutex liveSegmentsMutex;
+    std::vector<std::pair<std::uint64_t, header *>> liveSegments;
+    std::uint64_t nextSegmentId = 1;
+
+
+    //=========================================================================
+    header * find_live_segment
+    (
+        // requires liveSegmentsMutex
+        std::uint64_t segmentId
+    )
+    {
+        auto iter = std::find_if(liveSegments.begin(), liveSegments.end(), [&](auto const & entry){return (entry.first == segmentId);});
+        return (iter == liveSegments.end()) ? nullptr : iter->second;
+    }
+
+
+    //=========================================================================
+    // retires the slot of an instrumented worker which exits without having
+    // released it (ie: after an exception which the pool handled without an
+    // exception handler)
+    struct slot_guard
+    {
+        ~slot_guard()
+        {
+            using thread_stats = bcpp::system::thread_stats;
+            if (auto * threadStats = thread_stats::current(); (segmentId_ != 0) && (threadStats != nullptr))
+            {
+                thread_stats::set_current(nullptr);
+                std::lock_guard lockGuard(liveSegmentsMutex);
+                if (find_live_segment(segmentId_) != nullptr)
+                    threadStats->state_.store(thread_stats::slot_state::retired, std::memory_order_release);
+            }
+        }
+
+        std::uint64_t segmentId_{0};
+    };
+
+    thread_local slot_guard slotGuard;
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::stats_segment::stats_segment
+(
+    stats_segment && other
+):
+    sharedMemory_(std::move(other.sharedMemory_)),
+    id_(std::exchange(other.id_, 0))
+{
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::operator =
+(
+    stats_segment && other
+) -> stats_segment &
+{
+    if (this != &other)
+    {
+        unregister();
+        sharedMemory_ = std::move(other.sharedMemory_);
+        id_ = std::exchange(other.id_, 0);
+    }
+    return *this;
+}
+
+
+//=============================================================================
+bcpp::system::stats_segment::~stats_segment
+(
+)
+{
+    unregister();
+}
+
+
+//=============================================================================
+void bcpp::system::stats_segment::unregister
+(
+    // before the segment is unmapped so that no worker writes to it afterwards
+)
+{
+    if (id_ == 0)
+        return;
+    std::lock_guard lockGuard(liveSegmentsMutex);
+    std::erase_if(liveSegments, [&](auto const & entry){return (entry.first == id_);});
+    id_ = 0;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::stats_segment::required_size
+(
+    std::size_t capacity
+)
+{
+    return (sizeof(header) + (capacity * sizeof(thread_stats)));
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::create
+(
+    create_configuration const & config
+) -> stats_segment
+{
+    stats_segment statsSegment;
+    if (config.capacity_ == 0)
+        return statsSegment;
+
+    statsSegment.sharedMemory_ = shared_memory::create(
+            {
+                .path_ = config.path_.empty() ? (std::string(path_prefix) + std::to_string(::getpid())) : config.path_,
+                .size_ = required_size(config.capacity_),
+                .ioMode_ = io_mode::read_write,
+                .unlinkPolicy_ = config.unlinkPolicy_
+            },
+            {});
+    if (!statsSegment.sharedMemory_.is_valid())
+        return statsSegment;
+
+    auto * address = statsSegment.sharedMemory_.data();
+    for (std::size_t i = 0; i < config.capacity_; ++i)
+        new (address + sizeof(header) + (i * sizeof(thread_stats))) thread_stats{};
+    auto * hdr = new (address) header{};
+    hdr->version_ = version;
+    hdr->capacity_ = static_cast<std::uint32_t>(config.capacity_);
+    hdr->processId_ = ::getpid();
+    hdr->createTime_ = tsc_clock::now().time_since_epoch().count();
+    std::strncpy(hdr->processName_, config.processName_.c_str(), max_process_name_length - 1);
+    hdr->threadCount_.store(0, std::memory_order_relaxed);
+    // magic is written last so that a joiner never sees a partially initialized segment
+    std::atomic_ref(hdr->magic_).store(magic, std::memory_order_release);
+
+    std::lock_guard lockGuard(liveSegmentsMutex);
+    statsSegment.id_ = nextSegmentId++;
+    liveSegments.emplace_back(statsSegment.id_, hdr);
+    return statsSegment;
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::join
+(
+    join_configuration const & config
+) -> stats_segment
+{
+    stats_segment statsSegment;
+    statsSegment.sharedMemory_ = shared_memory::join(
+            {
+                .path_ = config.path_,
+                .ioMode_ = io_mode::read,
+                .unlinkPolicy_ = shared_memory::unlink_policy::never     // never remove another process' segment
+            },
+            {});
+    if (!statsSegment.sharedMemory_.is_valid())
+        return statsSegment;
+
+    auto valid = (statsSegment.sharedMemory_.size() >= sizeof(header));
+    if (valid)
+    {
+        auto const & hdr = statsSegment.get_header();
+        valid = ((std::atomic_ref(const_cast<std::uint64_t &>(hdr.magic_)).load(std::memory_order_acquire) == magic) &&
+                (hdr.version_ == version) &&
+                (statsSegment.sharedMemory_.size() >= required_size(hdr.capacity_)));
+    }
+    if (!valid)
+        statsSegment.sharedMemory_ = {};
+    return statsSegment;
+}
+
+
+//=============================================================================
+bool bcpp::system::stats_segment::is_valid
+(
+) const
+{
+    return sharedMemory_.is_valid();
+}
+
+
+//=============================================================================
+std::string bcpp::system::stats_segment::path
+(
+) const
+{
+    return sharedMemory_.path();
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::get_header
+(
+) const -> header const &
+{
+    return sharedMemory_.as<header const>();
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::get_slots
+(
+    header * hdr
+) -> thread_stats *
+{
+    return reinterpret_cast<thread_stats *>(reinterpret_cast<std::byte *>(hdr) + sizeof(header));
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::threads
+(
+) const -> std::span<thread_stats const>
+{
+    if (!is_valid())
+        return {};
+    auto & hdr = const_cast<header &>(get_header());
+    auto count = std::min(hdr.threadCount_.load(std::memory_order_acquire), hdr.capacity_);
+    return {get_slots(&hdr), count};
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::claim
+(
+    std::string_view name,
+    std::optional<cpu_id> cpuId
+) -> thread_stats *
+{
+    return claim(id_, name, cpuId);
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::claim
+(
+    segment_id segmentId,
+    std::string_view name,
+    std::optional<cpu_id> cpuId
+) -> thread_stats *
+{
+    std::lock_guard lockGuard(liveSegmentsMutex);
+    auto * hdr = find_live_segment(segmentId);
+    return (hdr == nullptr) ? nullptr : claim(hdr, name, cpuId);
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::claim
+(
+    // claim a free slot (or recycle a retired one) for the calling thread
+    header * hdr,
+    std::string_view name,
+    std::optional<cpu_id> cpuId
+) -> thread_stats *
+{
+    auto * slots = get_slots(hdr);
+    for (std::uint32_t i = 0; i < hdr->capacity_; ++i)
+    {
+        auto & slot = slots[i];
+        auto state = slot.state_.load(std::memory_order_relaxed);
+        if (state == thread_stats::slot_state::active)
+            continue;
+        if (!slot.state_.compare_exchange_strong(state, thread_stats::slot_state::active, std::memory_order_acq_rel))
+            continue;
+
+        for (auto * counter : {&slot.tasksRun_, &slot.idleSpins_, &slot.parks_, &slot.steals_,
+                &slot.queueDepth_, &slot.busyNanoseconds_, &slot.idleNanoseconds_})
+            counter->store(0, std::memory_order_relaxed);
+        slot.latency_.reset();
+        std::fill(std::begin(slot.name_), std::end(slot.name_), '\0');
+        slot.processId_ = ::getpid();
+        slot.threadId_ = ::gettid();
+        slot.cpuId_.store(cpuId.has_value() ? static_cast<std::int32_t>(*cpuId) : -1, std::memory_order_relaxed);
+        name.copy(slot.name_, std::min(name.size(), thread_stats::max_name_length - 1));
+        slot.heartbeat();
+
+        auto threadCount = hdr->threadCount_.load(std::memory_order_relaxed);
+        while ((threadCount < (i + 1)) && (!hdr->threadCount_.compare_exchange_weak(threadCount, i + 1, std::memory_order_release)))
+            ;
+        return &slot;
+    }
+    return nullptr;
+}
+
+
+//=============================================================================
+void bcpp::system::stats_segment::release
+(
+    thread_stats * threadStats
+)
+{
+    release(id_, threadStats);
+}
+
+
+//=============================================================================
+void bcpp::system::stats_segment::release
+(
+    // the slot is left alone if its segment has been destroyed
+    segment_id segmentId,
+    thread_stats * threadStats
+)
+{
+    if (threadStats == nullptr)
+        return;
+    if (thread_stats::current() == threadStats)
+        thread_stats::set_current(nullptr);
+    std::lock_guard lockGuard(liveSegmentsMutex);
+    if (find_live_segment(segmentId) != nullptr)
+        threadStats->state_.store(thread_stats::slot_state::retired, std::memory_order_release);
+}
+
+
+//=============================================================================
+auto bcpp::system::stats_segment::instrument
+(
+    // wrap the thread configuration so that the worker claims a slot (and
+    // makes it the thread's current stats) before the initialize handler
+    // runs and releases it when the worker exits.
+    thread_pool::thread_configuration config,
+    std::string_view name
+) -> thread_pool::thread_configuration
+{
+    if (id_ == 0)
+        return config;
+
+    auto attach = [segmentId = id_, name = std::string(name), cpuId = config.cpuId_]
+            (
+            )
+            {
+                // a restarted worker may still hold the slot of its previous run
+                release(segmentId, thread_stats::current());
+                thread_stats::set_current(claim(segmentId, name, cpuId));
+                slotGuard.segmentId_ = segmentId;
+            };
+    auto detach = [segmentId = id_]
+            (
+            )
+            {
+                release(segmentId, thread_stats::current());
+            };
+    return thread_pool::wrap_handlers(std::move(config), std::move(attach), std::move(detach));
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "./thread_stats.h"
+
+#include <library/system/cpu_id.h>
+#include <library/system/cache_line.h>
+#include <library/system/memory/shared_memory.h>
+#include <library/system/threading/thread_pool.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // stats_segment
+    //
+    // a shared_memory segment holding a header and a fixed number of
+    // thread_stats slots.  instrumented processes create the segment and
+    // claim a slot per hot thread.  monitors join the segment read only and
+    // never write to it so observing has no effect on the observed threads.
+    // an instrumented worker which exits after the segment was destroyed
+    // leaves the (unmapped) slot alone.
+    //=========================================================================
+    class stats_segment :
+        non_copyable
+    {
+    public:
+
+        static std::uint64_t constexpr magic = 0x7461'7473'7070'6362;   // "bcppstat"
+        static std::uint32_t constexpr version = 1;
+        static std::size_t constexpr default_capacity = 64;
+        static std::size_t constexpr max_process_name_length = 32;
+        // segments created without an explicit path are named with this
+        // prefix (and the process id) which is how thread_monitor finds them
+        static std::string_view constexpr path_prefix = "bcpp.stats.";
+
+        struct alignas(cache_line_size) header
+        {
+            std::uint64_t               magic_;
+            std::uint32_t               version_;
+            std::uint32_t               capacity_;
+            std::int32_t                processId_;
+            std::int32_t                reserved_;
+            std::int64_t                createTime_;
+            char                        processName_[max_process_name_length];
+            std::atomic<std::uint32_t>  threadCount_;      // high water mark of claimed slots
+        };
+
+        struct create_configuration
+        {
+            std::string                     path_;
+            std::size_t                     capacity_{default_capacity};
+            std::string                     processName_;
+            shared_memory::unlink_policy    unlinkPolicy_{shared_memory::unlink_policy::on_detach};
+        };
+
+        struct join_configuration
+        {
+            std::string                     path_;
+        };
+
+        static stats_segment create
+        (
+            create_configuration const &
+        );
+
+        static stats_segment join
+        (
+            join_configuration const &
+        );
+
+        stats_segment() = default;
+
+        stats_segment
+        (
+            stats_segment &&
+        );
+
+        stats_segment & operator =
+        (
+            stats_segment &&
+        );
+
+        ~stats_segment();
+
+        bool is_valid() const;
+
+        std::string path() const;
+
+        header const & get_header() const;
+
+        std::span<thread_stats const> threads() const;
+
+        thread_stats * claim
+        (
+            std::string_view,
+            std::optional<cpu_id> = std::nullopt
+        );
+
+        void release
+        (
+            thread_stats *
+        );
+
+        thread_pool::thread_configuration instrument
+        (
+            thread_pool::thread_configuration,
+            std::string_view
+        );
+
+        static std::size_t required_size
+        (
+            std::size_t
+        );
+
+    private:
+
+        // segment ids are never reused so that a worker which outlives its
+        // segment can tell that the segment is gone
+        using segment_id = std::uint64_t;
+
+        static thread_stats * claim
+        (
+            header *,
+            std::string_view,
+            std::optional<cpu_id>
+        );
+
+        static thread_stats * claim
+        (
+            segment_id,
+            std::string_view,
+            std::optional<cpu_id>
+        );
+
+        static void release
+        (
+            segment_id,
+            thread_stats *
+        );
+
+        void unregister();
+
+        static thread_stats * get_slots
+        (
+            header *
+        );
+
+        shared_memory   sharedMemory_;
+
+        segment_id      id_{0};     // non zero if created (and so claimable) by this process
+
+    }; // class stats_segment
+
+} // namespace bcpp::system
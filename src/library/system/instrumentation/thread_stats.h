@@ -0,0 +1,257 @@
+#pragma once
+
+#include "./latency_histogram.h"
+
+#include <library/system/cache_line.h>
+#include <library/system/time/tsc_clock.h>
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // thread_stats
+    //
+    // counters published by one (hot) thread.  all fields are written by the
+    // owning thread only, using plain relaxed stores, and may be read at any
+    // time by a monitor - typically from another process via a stats_segment.
+    //=========================================================================
+    struct alignas(cache_line_size) thread_stats
+    {
+        enum class slot_state : std::uint32_t
+        {
+            free        = 0,
+            active      = 1,
+            retired     = 2
+        };
+
+        static std::size_t constexpr max_name_length = 16;
+
+        static thread_stats * current() noexcept;
+
+        static void set_current
+        (
+            thread_stats *
+        ) noexcept;
+
+        void on_task
+        (
+            std::chrono::nanoseconds
+        ) noexcept;
+
+        void on_idle
+        (
+            std::chrono::nanoseconds
+        ) noexcept;
+
+        void on_idle_spin() noexcept;
+
+        void on_park() noexcept;
+
+        void on_steal() noexcept;
+
+        void set_queue_depth
+        (
+            std::uint64_t
+        ) noexcept;
+
+        void heartbeat() noexcept;
+
+        static void increment
+        (
+            std::atomic<std::uint64_t> &,
+            std::uint64_t = 1
+        ) noexcept;
+
+        // identity (written once when the slot is claimed)
+        std::atomic<slot_state>         state_{slot_state::free};
+        std::int32_t                    processId_{0};
+        std::int32_t                    threadId_{0};
+        std::atomic<std::int32_t>       cpuId_{-1};
+        char                            name_[max_name_length]{};
+
+        // counters
+        alignas(cache_line_size)
+        std::atomic<std::uint64_t>      tasksRun_{0};
+        std::atomic<std::uint64_t>      idleSpins_{0};
+        std::atomic<std::uint64_t>      parks_{0};
+        std::atomic<std::uint64_t>      steals_{0};
+        std::atomic<std::uint64_t>      queueDepth_{0};
+        std::atomic<std::uint64_t>      busyNanoseconds_{0};
+        std::atomic<std::uint64_t>      idleNanoseconds_{0};
+        std::atomic<std::int64_t>       heartbeat_{0};
+
+        // task latency
+        alignas(cache_line_size)
+        latency_histogram               latency_;
+
+    }; // struct thread_stats
+
+
+    //=========================================================================
+    // scope_timer
+    //
+    // records the lifetime of the scope into a latency_histogram.
+    //=========================================================================
+    class scope_timer
+    {
+    public:
+
+        scope_timer
+        (
+            latency_histogram *
+        ) noexcept;
+
+        ~scope_timer();
+
+    private:
+
+        latency_histogram *     histogram_;
+
+        tsc_clock::time_point   start_;
+    }; // class scope_timer
+
+} // namespace bcpp::system
+
+
+#define BCPP_SCOPE_TIMER_CONCAT_(a, b) a##b
+#define BCPP_SCOPE_TIMER_NAME_(line) BCPP_SCOPE_TIMER_CONCAT_(bcppScopeTimer_, line)
+
+// time the enclosing scope into the given histogram
+#define BCPP_SCOPE_TIMER_TO(histogram) \
+        ::bcpp::system::scope_timer BCPP_SCOPE_TIMER_NAME_(__LINE__)(&(histogram))
+
+// time the enclosing scope into the calling thread's published latency histogram (if any)
+#define BCPP_SCOPE_TIMER() \
+        ::bcpp::system::scope_timer BCPP_SCOPE_TIMER_NAME_(__LINE__)( \
+                ::bcpp::system::thread_stats::current() ? &::bcpp::system::thread_stats::current()->latency_ : nullptr)
+
+
+namespace bcpp::system::detail
+{
+    inline thread_local thread_stats * currentThreadStats{nullptr};
+}
+
+
+//=============================================================================
+inline auto bcpp::system::thread_stats::current
+(
+) noexcept -> thread_stats *
+{
+    return detail::currentThreadStats;
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::set_current
+(
+    thread_stats * threadStats
+) noexcept
+{
+    detail::currentThreadStats = threadStats;
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::increment
+(
+    // single writer increment.  avoids the locked instruction of fetch_add
+    std::atomic<std::uint64_t> & value,
+    std::uint64_t amount
+) noexcept
+{
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::on_task
+(
+    std::chrono::nanoseconds duration
+) noexcept
+{
+    increment(tasksRun_);
+    increment(busyNanoseconds_, static_cast<std::uint64_t>(duration.count()));
+    latency_.record(duration);
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::on_idle
+(
+    std::chrono::nanoseconds duration
+) noexcept
+{
+    increment(idleNanoseconds_, static_cast<std::uint64_t>(duration.count()));
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::on_idle_spin
+(
+) noexcept
+{
+    increment(idleSpins_);
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::on_park
+(
+) noexcept
+{
+    increment(parks_);
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::on_steal
+(
+) noexcept
+{
+    increment(steals_);
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::set_queue_depth
+(
+    std::uint64_t queueDepth
+) noexcept
+{
+    queueDepth_.store(queueDepth, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+inline void bcpp::system::thread_stats::heartbeat
+(
+) noexcept
+{
+    heartbeat_.store(tsc_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+inline bcpp::system::scope_timer::scope_timer
+(
+    latency_histogram * histogram
+) noexcept :
+    histogram_(histogram),
+    start_(histogram ? tsc_clock::now() : tsc_clock::time_point())
+{
+}
+
+
+//=============================================================================
+inline bcpp::system::scope_timer::~scope_timer
+(
+)
+{
+    if (histogram_ != nullptr)
+        histogram_->record(tsc_clock::now() - start_);
+}
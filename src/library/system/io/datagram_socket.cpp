@@ -0,0 +1,387 @@
+#include "./datagram_socket.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include <arpa/inet.h>
+#include <linux/net_tstamp.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    // the kernel segments at most this many datagrams per gso send (UDP_MAX_SEGMENTS)
+    static std::size_t constexpr max_gso_segments = 64;
+    static std::size_t constexpr max_udp_payload = 65'507;
+    static std::size_t constexpr gro_slot_size = (64 << 10);
+
+
+    //=========================================================================
+    std::optional<sockaddr_in> to_socket_address
+    (
+        std::string const & address,
+        std::uint16_t port
+    )
+    {
+        sockaddr_in socketAddress{};
+        socketAddress.sin_family = AF_INET;
+        socketAddress.sin_port = htons(port);
+        if (::inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1)
+            return std::nullopt;
+        return socketAddress;
+    }
+
+
+    //=========================================================================
+    template <typename T>
+    bool set_option
+    (
+        std::int32_t fileDescriptor,
+        std::int32_t level,
+        std::int32_t option,
+        T value
+    )
+    {
+        return (::setsockopt(fileDescriptor, level, option, &value, sizeof(value)) == 0);
+    }
+
+
+    //=========================================================================
+    void set_buffer_size
+    (
+        // the FORCE variant exceeds net.core.[rw]mem_max but requires CAP_NET_ADMIN
+        std::int32_t fileDescriptor,
+        std::int32_t forceOption,
+        std::int32_t option,
+        std::size_t size
+    )
+    {
+        if (size == 0)
+            return;
+        auto value = static_cast<std::int32_t>(std::min<std::size_t>(size, std::numeric_limits<std::int32_t>::max() / 2));
+        if (!set_option(fileDescriptor, SOL_SOCKET, forceOption, value))
+            set_option(fileDescriptor, SOL_SOCKET, option, value);
+    }
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::datagram_socket::datagram_socket
+(
+    configuration const & config
+):
+    configuration_(config),
+    fileDescriptor_(::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | (config.nonBlocking_ ? SOCK_NONBLOCK : 0), 0))
+{
+    configuration_.batchSize_ = std::max<std::size_t>(configuration_.batchSize_, 1);
+    configuration_.ringDepth_ = std::max<std::size_t>(configuration_.ringDepth_, 1);
+    if (!fileDescriptor_.is_valid())
+        return;
+    auto fd = fileDescriptor_.get();
+
+    auto local = to_socket_address(config.local_.address_, config.local_.port_);
+    auto failed = (!local.has_value());
+    if (config.reuseAddress_)
+        set_option(fd, SOL_SOCKET, SO_REUSEADDR, 1);
+    set_buffer_size(fd, SO_RCVBUFFORCE, SO_RCVBUF, config.receiveBufferSize_);
+    set_buffer_size(fd, SO_SNDBUFFORCE, SO_SNDBUF, config.sendBufferSize_);
+    if (!failed)
+        failed = (::bind(fd, reinterpret_cast<sockaddr const *>(&*local), sizeof(*local)) != 0);
+
+    // multicast send options (ignored for unicast)
+    in_addr interface{};
+    failed |= (::inet_pton(AF_INET, config.multicastInterface_.c_str(), &interface) != 1);
+    set_option(fd, IPPROTO_IP, IP_MULTICAST_IF, interface);
+    set_option(fd, IPPROTO_IP, IP_MULTICAST_LOOP, static_cast<std::uint8_t>(config.multicastLoopback_));
+    set_option(fd, IPPROTO_IP, IP_MULTICAST_TTL, static_cast<std::uint8_t>(config.multicastTtl_));
+    if ((!failed) && (config.multicastGroup_.has_value()))
+    {
+        ip_mreq membership{};
+        membership.imr_interface = interface;
+        failed = ((::inet_pton(AF_INET, config.multicastGroup_->c_str(), &membership.imr_multiaddr) != 1) ||
+                (!set_option(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, membership)));
+    }
+
+    if (config.timestamps_)
+        set_option(fd, SOL_SOCKET, SO_TIMESTAMPING, static_cast<std::int32_t>(SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE));
+    // without kernel support each datagram is simply received (or sent) individually
+    if ((config.gro_) && (!set_option(fd, IPPROTO_UDP, UDP_GRO, 1)))
+        configuration_.gro_ = false;
+    if (config.gsoSegmentSize_ > 0)
+    {
+        // probe with the socket option (and clear it again since as a socket
+        // option it would segment every large send, not just gso messages)
+        configuration_.gsoSegmentSize_ = static_cast<std::uint16_t>(std::min<std::size_t>(config.gsoSegmentSize_, max_udp_payload));
+        if (set_option(fd, IPPROTO_UDP, UDP_SEGMENT, static_cast<std::int32_t>(configuration_.gsoSegmentSize_)))
+            set_option(fd, IPPROTO_UDP, UDP_SEGMENT, std::int32_t{0});
+        else
+            configuration_.gsoSegmentSize_ = 0;
+    }
+
+    if (config.destination_.has_value())
+    {
+        destination_ = to_socket_address(config.destination_->address_, config.destination_->port_);
+        failed |= (!destination_.has_value());
+    }
+
+    // the receive ring
+    slotSize_ = configuration_.gro_ ? gro_slot_size : std::max<std::size_t>(config.maxDatagramSize_, 1);
+    auto slotCount = (configuration_.batchSize_ * configuration_.ringDepth_);
+    ring_ = anonymous_mapping({.size_ = (slotCount * slotSize_), .alignment_ = cache_line_size, .tag_ = "datagram_socket"}, {});
+    failed |= (!ring_.is_valid());
+    if (failed)
+    {
+        fileDescriptor_ = {};
+        return;
+    }
+
+    messages_.resize(slotCount);
+    messageHeaders_.resize(slotCount);
+    for (std::size_t i = 0; i < slotCount; ++i)
+    {
+        auto & m = messages_[i];
+        m.iovec_ = {.iov_base = ring_.data() + (i * slotSize_), .iov_len = slotSize_};
+        auto & header = messageHeaders_[i].msg_hdr;
+        header.msg_name = &m.source_;
+        header.msg_iov = &m.iovec_;
+        header.msg_iovlen = 1;
+        header.msg_control = m.control_;
+    }
+    datagrams_.resize(configuration_.ringDepth_);
+    for (auto & batch : datagrams_)
+        batch.reserve(configuration_.batchSize_);
+}
+
+
+//=============================================================================
+bool bcpp::system::datagram_socket::is_valid
+(
+) const
+{
+    return fileDescriptor_.is_valid();
+}
+
+
+//=============================================================================
+auto bcpp::system::datagram_socket::get_file_descriptor
+(
+) const -> file_descriptor const &
+{
+    return fileDescriptor_;
+}
+
+
+//=============================================================================
+auto bcpp::system::datagram_socket::local_endpoint
+(
+) const -> std::optional<endpoint>
+{
+    sockaddr_in socketAddress{};
+    socklen_t length = sizeof(socketAddress);
+    if ((!is_valid()) || (::getsockname(fileDescriptor_.get(), reinterpret_cast<sockaddr *>(&socketAddress), &length) != 0))
+        return std::nullopt;
+    char address[INET_ADDRSTRLEN] = {};
+    ::inet_ntop(AF_INET, &socketAddress.sin_addr, address, sizeof(address));
+    return endpoint{address, ntohs(socketAddress.sin_port)};
+}
+
+
+//=============================================================================
+auto bcpp::system::datagram_socket::receive
+(
+) -> std::span<datagram const>
+{
+    if (!is_valid())
+        return {};
+    auto batch = nextBatch_;
+    auto batchSize = configuration_.batchSize_;
+    auto * headers = messageHeaders_.data() + (batch * batchSize);
+    // the kernel overwrites the lengths so they are reset for every call
+    for (std::size_t i = 0; i < batchSize; ++i)
+    {
+        headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        headers[i].msg_hdr.msg_controllen = sizeof(message::control_);
+        headers[i].msg_hdr.msg_flags = 0;
+    }
+
+    ++statistics_.receiveCalls_;
+    auto received = ::recvmmsg(fileDescriptor_.get(), headers, static_cast<std::uint32_t>(batchSize),
+            configuration_.nonBlocking_ ? MSG_DONTWAIT : MSG_WAITFORONE, nullptr);
+    if (received <= 0)
+        return {};
+    nextBatch_ = ((batch + 1) % configuration_.ringDepth_);
+
+    auto & datagrams = datagrams_[batch];
+    datagrams.clear();
+    for (auto i = 0; i < received; ++i)
+    {
+        auto const & header = headers[i].msg_hdr;
+        auto const * data = static_cast<std::byte const *>(header.msg_iov->iov_base);
+        std::size_t length = headers[i].msg_len;
+        std::chrono::system_clock::time_point timestamp;
+        std::size_t segmentSize = length;
+        for (auto * cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr; cmsg = CMSG_NXTHDR(const_cast<msghdr *>(&header), cmsg))
+        {
+            if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPING))
+            {
+                timespec ts[3];
+                std::memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+                timestamp = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::seconds(ts[0].tv_sec) + std::chrono::nanoseconds(ts[0].tv_nsec)));
+            }
+            else if ((cmsg->cmsg_level == IPPROTO_UDP) && (cmsg->cmsg_type == UDP_GRO))
+            {
+                std::int32_t groSize;
+                std::memcpy(&groSize, CMSG_DATA(cmsg), sizeof(groSize));
+                if (groSize > 0)
+                    segmentSize = static_cast<std::size_t>(groSize);
+            }
+        }
+        auto truncated = ((header.msg_flags & MSG_TRUNC) != 0);
+        statistics_.truncated_ += truncated;
+        statistics_.bytesReceived_ += length;
+        // a gro datagram holds segments of segmentSize (the last may be shorter)
+        for (std::size_t offset = 0; offset < std::max<std::size_t>(length, 1); offset += std::max<std::size_t>(segmentSize, 1))
+        {
+            datagrams.push_back(
+                    {
+                        .data_ = {data + offset, std::min(segmentSize, length - offset)},
+                        .source_ = *static_cast<sockaddr_in const *>(header.msg_name),
+                        .timestamp_ = timestamp,
+                        .truncated_ = truncated
+                    });
+        }
+    }
+    statistics_.datagramsReceived_ += datagrams.size();
+    return datagrams;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::datagram_socket::send
+(
+    std::span<std::span<std::byte const> const> payloads
+)
+{
+    return destination_.has_value() ? send(payloads, &*destination_) : 0;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::datagram_socket::send
+(
+    std::span<std::span<std::byte const> const> payloads,
+    endpoint const & destination
+)
+{
+    auto socketAddress = to_socket_address(destination.address_, destination.port_);
+    return socketAddress.has_value() ? send(payloads, &*socketAddress) : 0;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::datagram_socket::send
+(
+    // up to batchSize_ messages per sendmmsg.  with gso a message carries a
+    // run of payloads of gsoSegmentSize_ (the last of which may be shorter)
+    std::span<std::span<std::byte const> const> payloads,
+    sockaddr_in const * destination
+)
+{
+    if ((!is_valid()) || (payloads.empty()))
+        return 0;
+    auto batchSize = configuration_.batchSize_;
+    auto segmentSize = static_cast<std::size_t>(configuration_.gsoSegmentSize_);
+    auto maxSegments = (segmentSize > 0) ? std::min(max_gso_segments, max_udp_payload / segmentSize) : 1;
+    sendHeaders_.resize(batchSize);
+    sendControls_.resize(batchSize);
+    sendIovecs_.resize(batchSize * maxSegments);
+
+    std::size_t sent = 0;
+    while (sent < payloads.size())
+    {
+        // build a batch of messages
+        std::size_t messageCount = 0;
+        std::size_t iovecCount = 0;
+        sendDatagramCounts_.clear();
+        auto next = sent;
+        while ((messageCount < batchSize) && (next < payloads.size()))
+        {
+            auto & header = sendHeaders_[messageCount].msg_hdr;
+            header = {};
+            header.msg_name = const_cast<sockaddr_in *>(destination);
+            header.msg_namelen = sizeof(sockaddr_in);
+            header.msg_iov = sendIovecs_.data() + iovecCount;
+
+            std::size_t segments = 0;
+            while ((next < payloads.size()) && (segments < maxSegments))
+            {
+                auto size = payloads[next].size();
+                if ((segments > 0) && (size > segmentSize))
+                    break;
+                sendIovecs_[iovecCount++] = {.iov_base = const_cast<std::byte *>(payloads[next].data()), .iov_len = size};
+                statistics_.bytesSent_ += size;
+                ++segments;
+                ++next;
+                // a payload which is not a full segment (or larger) ends the message
+                if (size != segmentSize)
+                    break;
+            }
+            header.msg_iovlen = segments;
+            if (segments > 1)
+            {
+                header.msg_control = sendControls_[messageCount].control_;
+                header.msg_controllen = CMSG_SPACE(sizeof(std::uint16_t));
+                auto * cmsg = CMSG_FIRSTHDR(&header);
+                cmsg->cmsg_level = IPPROTO_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+                auto gsoSize = static_cast<std::uint16_t>(segmentSize);
+                std::memcpy(CMSG_DATA(cmsg), &gsoSize, sizeof(gsoSize));
+            }
+            sendDatagramCounts_.push_back(segments);
+            ++messageCount;
+        }
+
+        ++statistics_.sendCalls_;
+        auto messagesSent = ::sendmmsg(fileDescriptor_.get(), sendHeaders_.data(), static_cast<std::uint32_t>(messageCount), 0);
+        auto error = errno;
+        auto messagesAccepted = std::max(messagesSent, 0);
+        for (auto i = 0; i < messagesAccepted; ++i)
+            sent += sendDatagramCounts_[i];
+        if (static_cast<std::size_t>(messagesAccepted) < messageCount)
+        {
+            // the socket buffer is full (or an error).  bytes of unsent datagrams are not counted
+            for (auto i = static_cast<std::size_t>(messagesAccepted); i < messageCount; ++i)
+                for (std::size_t j = 0; j < sendHeaders_[i].msg_hdr.msg_iovlen; ++j)
+                    statistics_.bytesSent_ -= sendHeaders_[i].msg_hdr.msg_iov[j].iov_len;
+            if ((messagesSent < 0) && (sendDatagramCounts_[0] > 1) && (error != EAGAIN) && (error != EWOULDBLOCK) && (error != ENOBUFS))
+            {
+                // the path refused segmentation (ie: a device without checksum offload)
+                // which the probe could not rule out.  send datagrams individually from now on
+                configuration_.gsoSegmentSize_ = 0;
+                segmentSize = 0;
+                maxSegments = 1;
+                continue;
+            }
+            break;
+        }
+    }
+    statistics_.datagramsSent_ += sent;
+    return sent;
+}
+
+
+//=============================================================================
+auto bcpp::system::datagram_socket::get_statistics
+(
+) const -> statistics const &
+{
+    return statistics_;
+}
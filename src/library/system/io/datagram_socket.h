@@ -0,0 +1,180 @@
+#pragma once
+
+#include <library/system/memory/anonymous_mapping.h>
+#include <library/system/cache_line.h>
+#include <include/file_descriptor.h>
+#include <include/non_copyable.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // datagram_socket
+    //
+    // udp socket (ipv4, unicast or multicast) which receives with recvmmsg
+    // and sends with sendmmsg so that a single system call moves a batch of
+    // datagrams.  received datagrams are written directly into a ring of
+    // batches preallocated in an anonymous_mapping.  the datagrams returned
+    // by receive() are views into the ring and remain valid until the ring
+    // wraps (ringDepth_ - 1 further calls to receive()).
+    //
+    // with timestamps_ each datagram carries the kernel's software receive
+    // timestamp (SO_TIMESTAMPING).  with gro_ the kernel coalesces datagrams
+    // of a flow into one (UDP_GRO) and receive() splits them again so the
+    // caller sees individual datagrams either way.  with gsoSegmentSize_
+    // send() passes runs of equal sized datagrams to the kernel as one
+    // message to be segmented (UDP_SEGMENT).  where the kernel (or the
+    // path) does not support segmentation they are sent individually.
+    //
+    // the socket is non blocking by default and so is suited to a reactor
+    // (receive until receive() returns nothing).  a blocking socket waits
+    // for the first datagram of a batch (MSG_WAITFORONE).
+    //=========================================================================
+    class datagram_socket :
+        non_copyable
+    {
+    public:
+
+        struct endpoint
+        {
+            std::string     address_;
+            std::uint16_t   port_;
+        };
+
+        struct configuration
+        {
+            endpoint                    local_{"0.0.0.0", 0};
+            std::optional<std::string>  multicastGroup_;                // joined on multicastInterface_
+            std::string                 multicastInterface_{"0.0.0.0"};
+            bool                        multicastLoopback_{true};
+            std::int32_t                multicastTtl_{1};
+            std::optional<endpoint>     destination_;                   // default destination for send()
+            std::size_t                 batchSize_{64};                 // datagrams per system call
+            std::size_t                 ringDepth_{4};                  // batches in the receive ring
+            std::size_t                 maxDatagramSize_{2048};
+            std::size_t                 receiveBufferSize_{0};          // SO_RCVBUF(FORCE).  zero for the system default
+            std::size_t                 sendBufferSize_{0};             // SO_SNDBUF(FORCE).  zero for the system default
+            bool                        timestamps_{true};
+            bool                        gro_{false};
+            std::uint16_t               gsoSegmentSize_{0};             // zero disables gso
+            bool                        nonBlocking_{true};
+            bool                        reuseAddress_{true};
+        };
+
+        struct datagram
+        {
+            std::span<std::byte const>              data_;
+            sockaddr_in                             source_;
+            std::chrono::system_clock::time_point   timestamp_;     // epoch if timestamps are disabled
+            bool                                    truncated_;
+        };
+
+        struct statistics
+        {
+            std::uint64_t   receiveCalls_{0};
+            std::uint64_t   datagramsReceived_{0};
+            std::uint64_t   bytesReceived_{0};
+            std::uint64_t   sendCalls_{0};
+            std::uint64_t   datagramsSent_{0};
+            std::uint64_t   bytesSent_{0};
+            std::uint64_t   truncated_{0};
+        };
+
+        datagram_socket() = default;
+
+        explicit datagram_socket
+        (
+            configuration const &
+        );
+
+        datagram_socket(datagram_socket &&) = default;
+        datagram_socket & operator = (datagram_socket &&) = default;
+        ~datagram_socket() = default;
+
+        bool is_valid() const;
+
+        file_descriptor const & get_file_descriptor() const;
+
+        // the bound address (ie: to discover the port chosen for port 0)
+        std::optional<endpoint> local_endpoint() const;
+
+        // one recvmmsg.  empty if nothing is available (non blocking) or on error
+        std::span<datagram const> receive();
+
+        // returns the number of datagrams sent
+        std::size_t send
+        (
+            std::span<std::span<std::byte const> const>
+        );
+
+        std::size_t send
+        (
+            std::span<std::span<std::byte const> const>,
+            endpoint const &
+        );
+
+        statistics const & get_statistics() const;
+
+    private:
+
+        struct message
+        {
+            sockaddr_in     source_;
+            iovec           iovec_;
+            alignas(cmsghdr) std::byte control_[128];
+        };
+
+        struct send_control
+        {
+            alignas(cmsghdr) std::byte control_[32];
+        };
+
+        std::size_t send
+        (
+            std::span<std::span<std::byte const> const>,
+            sockaddr_in const *
+        );
+
+        configuration                               configuration_;
+
+        file_descriptor                             fileDescriptor_;
+
+        anonymous_mapping                           ring_;
+
+        std::size_t                                 slotSize_{0};
+
+        std::size_t                                 nextBatch_{0};
+
+        std::vector<message>                        messages_;                  // one per slot of the ring
+
+        std::vector<mmsghdr>                        messageHeaders_;            // one per slot of the ring
+
+        std::vector<std::vector<datagram>>          datagrams_;                 // one per batch of the ring
+
+        std::vector<mmsghdr>                        sendHeaders_;
+
+        std::vector<iovec>                          sendIovecs_;
+
+        std::vector<send_control>                   sendControls_;
+
+        std::vector<std::size_t>                    sendDatagramCounts_;        // per message of the current send batch
+
+        std::optional<sockaddr_in>                  destination_;
+
+        statistics                                  statistics_;
+
+    }; // class datagram_socket
+
+} // namespace bcpp::system
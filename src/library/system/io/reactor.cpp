@@ -0,0 +1,286 @@
+#include "./reactor.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    //=========================================================================
+    void apply_busy_poll
+    (
+        // SO_BUSY_POLL on anything which is a socket.  requires CAP_NET_ADMIN
+        // to raise above net.core.busy_read so failure is not an error
+        std::int32_t fileDescriptor,
+        std::chrono::microseconds busyPoll
+    )
+    {
+        std::int32_t socketType = 0;
+        socklen_t length = sizeof(socketType);
+        if (::getsockopt(fileDescriptor, SOL_SOCKET, SO_TYPE, &socketType, &length) != 0)
+            return;
+        std::int32_t microseconds = static_cast<std::int32_t>(busyPoll.count());
+        ::setsockopt(fileDescriptor, SOL_SOCKET, SO_BUSY_POLL, &microseconds, sizeof(microseconds));
+    }
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::reactor::reactor
+(
+):
+    reactor(configuration{})
+{
+}
+
+
+//=============================================================================
+bcpp::system::reactor::reactor
+(
+    configuration const & config
+):
+    configuration_(config),
+    epollFileDescriptor_(::epoll_create1(EPOLL_CLOEXEC)),
+    eventFileDescriptor_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+    events_(std::max<std::size_t>(config.maxEvents_, 1))
+{
+    if ((!epollFileDescriptor_.is_valid()) || (!eventFileDescriptor_.is_valid()))
+    {
+        epollFileDescriptor_ = {};
+        return;
+    }
+    // the eventfd is the one registration with a null data pointer
+    epoll_event event{.events = EPOLLIN | EPOLLET, .data = {.ptr = nullptr}};
+    if (::epoll_ctl(epollFileDescriptor_.get(), EPOLL_CTL_ADD, eventFileDescriptor_.get(), &event) != 0)
+        epollFileDescriptor_ = {};
+}
+
+
+//=============================================================================
+bcpp::system::reactor::~reactor
+(
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    for (auto & [id, r] : registrations_)
+        ::epoll_ctl(epollFileDescriptor_.get(), EPOLL_CTL_DEL, r->fileDescriptor_, nullptr);
+}
+
+
+//=============================================================================
+bool bcpp::system::reactor::is_valid
+(
+) const
+{
+    return epollFileDescriptor_.is_valid();
+}
+
+
+//=============================================================================
+auto bcpp::system::reactor::add
+(
+    // register the descriptor for the events (edge triggered).  empty if
+    // epoll_ctl fails (ie: the descriptor is already registered)
+    file_descriptor const & fileDescriptor,
+    event_mask events,
+    event_handler handler
+) -> std::optional<registration_id>
+{
+    if ((!is_valid()) || (!fileDescriptor.is_valid()) || (!handler))
+        return std::nullopt;
+    if (configuration_.busyPoll_)
+        apply_busy_poll(fileDescriptor.get(), configuration_.socketBusyPoll_);
+
+    std::lock_guard lockGuard(mutex_);
+    auto r = std::make_unique<registration>();
+    r->id_ = nextRegistrationId_++;
+    r->fileDescriptor_ = fileDescriptor.get();
+    r->handler_ = std::move(handler);
+    epoll_event event{.events = events | EPOLLET, .data = {.ptr = r.get()}};
+    if (::epoll_ctl(epollFileDescriptor_.get(), EPOLL_CTL_ADD, r->fileDescriptor_, &event) != 0)
+        return std::nullopt;
+    auto id = r->id_;
+    registrations_[id] = std::move(r);
+    return id;
+}
+
+
+//=============================================================================
+bool bcpp::system::reactor::modify
+(
+    registration_id id,
+    event_mask events
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    auto iter = registrations_.find(id);
+    if (iter == registrations_.end())
+        return false;
+    epoll_event event{.events = events | EPOLLET, .data = {.ptr = iter->second.get()}};
+    return (::epoll_ctl(epollFileDescriptor_.get(), EPOLL_CTL_MOD, iter->second->fileDescriptor_, &event) == 0);
+}
+
+
+//=============================================================================
+bool bcpp::system::reactor::remove
+(
+    registration_id id
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    auto iter = registrations_.find(id);
+    if (iter == registrations_.end())
+        return false;
+    auto & r = iter->second;
+    ::epoll_ctl(epollFileDescriptor_.get(), EPOLL_CTL_DEL, r->fileDescriptor_, nullptr);
+    r->removed_.store(true, std::memory_order_relaxed);
+    // events for it may already have been collected by the loop so it is
+    // destroyed by the loop once the current dispatch is complete
+    retiredRegistrations_.push_back(std::move(r));
+    registrations_.erase(iter);
+    return true;
+}
+
+
+//=============================================================================
+void bcpp::system::reactor::post
+(
+    task t
+)
+{
+    {
+        std::lock_guard lockGuard(mutex_);
+        postedTasks_.push_back(std::move(t));
+    }
+    wake();
+}
+
+
+//=============================================================================
+void bcpp::system::reactor::wake
+(
+    // at most one write to the eventfd until the loop consumes it
+)
+{
+    if (!wakePending_.exchange(true, std::memory_order_acq_rel))
+    {
+        std::uint64_t value = 1;
+        [[maybe_unused]] auto _ = ::write(eventFileDescriptor_.get(), &value, sizeof(value));
+    }
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::reactor::poll
+(
+    std::chrono::milliseconds timeout
+)
+{
+    if (!is_valid())
+        return 0;
+    auto eventCount = ::epoll_wait(epollFileDescriptor_.get(), events_.data(), static_cast<std::int32_t>(events_.size()),
+            (timeout.count() < 0) ? -1 : static_cast<std::int32_t>(timeout.count()));
+
+    std::size_t dispatched = 0;
+    for (auto i = 0; i < eventCount; ++i)
+    {
+        auto const & event = events_[i];
+        if (event.data.ptr == nullptr)
+        {
+            // drained before the flag is cleared so that the flag is never left
+            // set with nothing to read.  a wake() between the drain and the clear
+            // does not write but what it announces (a posted task or a stop) is
+            // seen once this dispatch completes
+            std::uint64_t value;
+            while (::read(eventFileDescriptor_.get(), &value, sizeof(value)) > 0)
+                ;
+            wakePending_.store(false, std::memory_order_seq_cst);
+            continue;
+        }
+        auto & r = *static_cast<registration *>(event.data.ptr);
+        if (r.removed_.load(std::memory_order_relaxed))
+            continue;
+        r.handler_(event.events);
+        ++dispatched;
+    }
+    run_posted_tasks();
+    release_retired_registrations();
+    return dispatched;
+}
+
+
+//=============================================================================
+void bcpp::system::reactor::run_posted_tasks
+(
+)
+{
+    {
+        std::lock_guard lockGuard(mutex_);
+        if (postedTasks_.empty())
+            return;
+        std::swap(postedTasks_, runningTasks_);
+    }
+    for (auto & t : runningTasks_)
+        t();
+    runningTasks_.clear();
+}
+
+
+//=============================================================================
+void bcpp::system::reactor::release_retired_registrations
+(
+)
+{
+    std::vector<std::unique_ptr<registration>> retired;
+    {
+        std::lock_guard lockGuard(mutex_);
+        if (retiredRegistrations_.empty())
+            return;
+        std::swap(retired, retiredRegistrations_);
+    }
+    // destroyed outside of the lock as handlers may own resources which call back into the reactor
+}
+
+
+//=============================================================================
+void bcpp::system::reactor::run
+(
+    std::stop_token const & stopToken
+)
+{
+    std::stop_callback stopCallback(stopToken, [this](){wake();});
+    auto timeout = std::chrono::milliseconds(configuration_.busyPoll_ ? 0 : -1);
+    while (!stopToken.stop_requested())
+        poll(timeout);
+}
+
+
+//=============================================================================
+auto bcpp::system::reactor::worker
+(
+    std::optional<cpu_id> cpuId,
+    std::string_view name
+) -> thread_pool::thread_configuration
+{
+    return {
+                .function_ = [this](std::stop_token const & stopToken){run(stopToken);},
+                .cpuId_ = cpuId,
+                .name_ = std::string(name)
+            };
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::reactor::size
+(
+) const
+{
+    std::lock_guard lockGuard(mutex_);
+    return registrations_.size();
+}
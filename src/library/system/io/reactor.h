@@ -0,0 +1,169 @@
+#pragma once
+
+#include <library/system/cpu_id.h>
+#include <library/system/threading/thread_pool.h>
+#include <include/file_descriptor.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // reactor
+    //
+    // edge triggered epoll event loop.  file_descriptors are registered with
+    // a handler which is called on the loop thread with the events which
+    // occurred.  because registrations are edge triggered a handler must
+    // read (or write) until the call would block (EAGAIN) or it will not be
+    // called again for that descriptor.  the reactor does not own registered
+    // descriptors; remove a descriptor before closing it.
+    //
+    // add(), modify(), remove() and post() may be called from any thread.
+    // post() queues a task to run on the loop thread and wakes the loop
+    // through an eventfd.  a registration removed while its events are
+    // being dispatched is not called again and is destroyed once the
+    // dispatch completes.
+    //
+    // with busyPoll_ the loop never sleeps (epoll_wait with a zero timeout)
+    // and sockets are registered with SO_BUSY_POLL so that the kernel polls
+    // the device queue rather than waiting for an interrupt.  this trades a
+    // core for latency and should be combined with a pinned worker():
+    //
+    //      reactor reactor({.busyPoll_ = true});
+    //      thread_pool pool({reactor.worker(3)});
+    //=========================================================================
+    class reactor :
+        non_copyable
+    {
+    public:
+
+        using event_mask = std::uint32_t;
+        using registration_id = std::uint64_t;
+        using event_handler = std::function<void(event_mask)>;
+        using task = std::function<void()>;
+
+        static event_mask constexpr readable = EPOLLIN;
+        static event_mask constexpr writable = EPOLLOUT;
+        static event_mask constexpr peer_closed = EPOLLRDHUP;
+        static event_mask constexpr hangup = EPOLLHUP;     // always reported
+        static event_mask constexpr error = EPOLLERR;      // always reported
+
+        struct configuration
+        {
+            std::size_t                 maxEvents_{256};            // events dispatched per epoll_wait
+            bool                        busyPoll_{false};
+            std::chrono::microseconds   socketBusyPoll_{50};        // SO_BUSY_POLL applied to sockets when busyPoll_
+        };
+
+        reactor();
+
+        explicit reactor
+        (
+            configuration const &
+        );
+
+        ~reactor();
+
+        bool is_valid() const;
+
+        std::optional<registration_id> add
+        (
+            file_descriptor const &,
+            event_mask,
+            event_handler
+        );
+
+        bool modify
+        (
+            registration_id,
+            event_mask
+        );
+
+        bool remove
+        (
+            registration_id
+        );
+
+        void post
+        (
+            task
+        );
+
+        void wake();
+
+        // wait at most timeout (negative for no limit) for events and dispatch
+        // them then run posted tasks.  returns the number of events dispatched
+        std::size_t poll
+        (
+            std::chrono::milliseconds
+        );
+
+        // poll until stop is requested
+        void run
+        (
+            std::stop_token const &
+        );
+
+        // a thread_pool worker which runs the reactor
+        thread_pool::thread_configuration worker
+        (
+            std::optional<cpu_id> = std::nullopt,
+            std::string_view = "reactor"
+        );
+
+        std::size_t size() const;
+
+    private:
+
+        struct registration
+        {
+            registration_id         id_;
+            std::int32_t            fileDescriptor_;
+            event_handler           handler_;
+            std::atomic<bool>       removed_{false};
+        };
+
+        void run_posted_tasks();
+
+        void release_retired_registrations();
+
+        configuration                                                       configuration_;
+
+        file_descriptor                                                     epollFileDescriptor_;
+
+        file_descriptor                                                     eventFileDescriptor_;
+
+        std::atomic<bool>                                                   wakePending_{false};
+
+        std::vector<epoll_event>                                            events_;
+
+        mutable std::mutex                                                  mutex_;
+
+        std::unordered_map<registration_id, std::unique_ptr<registration>>  registrations_;
+
+        std::vector<std::unique_ptr<registration>>                          retiredRegistrations_;
+
+        registration_id                                                     nextRegistrationId_{1};
+
+        std::vector<task>                                                   postedTasks_;
+
+        std::vector<task>                                                   runningTasks_;
+
+    }; // class reactor
+
+} // namespace bcpp::system
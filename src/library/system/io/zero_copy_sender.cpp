@@ -0,0 +1,166 @@
+#include "./zero_copy_sender.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+
+//=============================================================================
+bcpp::system::zero_copy_sender::zero_copy_sender
+(
+    file_descriptor const & fileDescriptor
+):
+    zero_copy_sender(fileDescriptor, configuration{})
+{
+}
+
+
+//=============================================================================
+bcpp::system::zero_copy_sender::zero_copy_sender
+(
+    file_descriptor const & fileDescriptor,
+    configuration const & config
+):
+    configuration_(config),
+    fileDescriptor_(fileDescriptor.get())
+{
+    std::int32_t enable = 1;
+    zeroCopy_ = ((fileDescriptor.is_valid()) &&
+            (::setsockopt(fileDescriptor_, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0));
+}
+
+
+//=============================================================================
+bool bcpp::system::zero_copy_sender::is_valid
+(
+) const
+{
+    return zeroCopy_;
+}
+
+
+//=============================================================================
+auto bcpp::system::zero_copy_sender::send
+(
+    std::span<std::byte const> data,
+    completion_handler completionHandler
+) -> std::optional<std::size_t>
+{
+    if (!is_valid())
+        return std::nullopt;
+    auto zeroCopy = (data.size() >= configuration_.copyThreshold_);
+    auto sent = ::send(fileDescriptor_, data.data(), data.size(), MSG_NOSIGNAL | (zeroCopy ? MSG_ZEROCOPY : 0));
+    if (sent < 0)
+        return std::nullopt;    // the kernel does not number a failed send
+    statistics_.bytesSent_ += sent;
+    if (!zeroCopy)
+    {
+        ++statistics_.copiedSends_;
+        if (completionHandler)
+            completionHandler(true);
+        return sent;
+    }
+    ++statistics_.zeroCopySends_;
+    if (pendingSends_.empty())
+        firstPendingId_ = nextId_;
+    pendingSends_.push_back({.completionHandler_ = std::move(completionHandler)});
+    ++nextId_;
+    ++outstanding_;
+    return sent;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::zero_copy_sender::poll_completions
+(
+)
+{
+    if (!is_valid())
+        return 0;
+    auto previousCompletions = statistics_.completions_;
+    while (outstanding_ > 0)
+    {
+        alignas(cmsghdr) std::byte control[128];
+        msghdr header{};
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+        if (::recvmsg(fileDescriptor_, &header, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;  // EAGAIN: the error queue is empty
+        }
+        for (auto * cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr; cmsg = CMSG_NXTHDR(&header, cmsg))
+        {
+            if (!(((cmsg->cmsg_level == SOL_IP) && (cmsg->cmsg_type == IP_RECVERR)) ||
+                    ((cmsg->cmsg_level == SOL_IPV6) && (cmsg->cmsg_type == IPV6_RECVERR))))
+                continue;
+            sock_extended_err error;
+            std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+            if ((error.ee_errno != 0) || (error.ee_origin != SO_EE_ORIGIN_ZEROCOPY))
+                continue;
+            // a completion reports the inclusive range of sends [ee_info, ee_data]
+            complete(error.ee_info, error.ee_data, ((error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0));
+        }
+    }
+    return (statistics_.completions_ - previousCompletions);
+}
+
+
+//=============================================================================
+void bcpp::system::zero_copy_sender::complete
+(
+    std::uint32_t first,
+    std::uint32_t last,
+    bool copied
+)
+{
+    // ids are compared relative to the first pending send so that the
+    // numbering may wrap
+    for (auto id = first; ; ++id)
+    {
+        auto index = static_cast<std::size_t>(id - firstPendingId_);
+        if (index < pendingSends_.size())
+        {
+            auto & pendingSend = pendingSends_[index];
+            if (!pendingSend.complete_)
+            {
+                pendingSend.complete_ = true;
+                --outstanding_;
+                ++statistics_.completions_;
+                statistics_.kernelCopies_ += copied;
+                if (pendingSend.completionHandler_)
+                    pendingSend.completionHandler_(copied);
+                pendingSend.completionHandler_ = nullptr;
+            }
+        }
+        if (id == last)
+            break;
+    }
+    while ((!pendingSends_.empty()) && (pendingSends_.front().complete_))
+    {
+        pendingSends_.pop_front();
+        ++firstPendingId_;
+    }
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::zero_copy_sender::outstanding
+(
+) const
+{
+    return outstanding_;
+}
+
+
+//=============================================================================
+auto bcpp::system::zero_copy_sender::get_statistics
+(
+) const -> statistics const &
+{
+    return statistics_;
+}
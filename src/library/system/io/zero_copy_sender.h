@@ -0,0 +1,128 @@
+#pragma once
+
+#include <include/file_descriptor.h>
+#include <include/non_copyable.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <span>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // zero_copy_sender
+    //
+    // sends on a socket with MSG_ZEROCOPY so that the kernel transmits from
+    // the caller's pages rather than copying them into socket buffers.  the
+    // pages are referenced until the kernel reports the send complete, so
+    // each send() takes a completion_handler which is called (from
+    // poll_completions()) once the buffer may be modified or released.
+    //
+    // completions are delivered on the socket's error queue which makes the
+    // socket report an error event (POLLERR / reactor::error) so a reactor
+    // handler can call poll_completions() when that event occurs.
+    //
+    // pinning pages and processing the completion costs more than copying a
+    // small buffer so sends smaller than copyThreshold_ are ordinary sends
+    // whose handler is called immediately.  where the kernel had to copy
+    // anyway (ie: loopback or a device without scatter gather) the handler
+    // is told so and the sends are counted in the statistics.
+    //
+    // the sender does not own the socket.  it must outlive the sender.
+    //=========================================================================
+    class zero_copy_sender :
+        non_copyable
+    {
+    public:
+
+        // called once the kernel no longer references the buffer.  copied is
+        // true if the data was copied (rather than sent from the buffer)
+        using completion_handler = std::function<void(bool copied)>;
+
+        struct configuration
+        {
+            std::size_t     copyThreshold_{10 << 10};
+        };
+
+        struct statistics
+        {
+            std::uint64_t   zeroCopySends_{0};
+            std::uint64_t   copiedSends_{0};            // below copyThreshold_
+            std::uint64_t   bytesSent_{0};
+            std::uint64_t   completions_{0};
+            std::uint64_t   kernelCopies_{0};           // zero copy sends which the kernel copied
+        };
+
+        explicit zero_copy_sender
+        (
+            file_descriptor const &
+        );
+
+        zero_copy_sender
+        (
+            file_descriptor const &,
+            configuration const &
+        );
+
+        // false if the socket does not support SO_ZEROCOPY
+        bool is_valid() const;
+
+        // returns the number of bytes sent (which may be fewer than the size
+        // of the span for a non blocking stream socket).  empty on error in
+        // which case the handler is not called
+        std::optional<std::size_t> send
+        (
+            std::span<std::byte const>,
+            completion_handler
+        );
+
+        // process the completions on the error queue.  returns the number of
+        // handlers called
+        std::size_t poll_completions();
+
+        // sends which are not yet complete
+        std::size_t outstanding() const;
+
+        statistics const & get_statistics() const;
+
+    private:
+
+        struct pending_send
+        {
+            completion_handler  completionHandler_;
+            bool                complete_{false};
+        };
+
+        void complete
+        (
+            std::uint32_t,
+            std::uint32_t,
+            bool
+        );
+
+        configuration                   configuration_;
+
+        std::int32_t                    fileDescriptor_{0};
+
+        bool                            zeroCopy_{false};
+
+        // the kernel numbers each successful zero copy send (from zero).
+        // pendingSends_[0] is the send numbered firstPendingId_
+        std::uint32_t                   nextId_{0};
+
+        std::uint32_t                   firstPendingId_{0};
+
+        std::deque<pending_send>        pendingSends_;
+
+        std::size_t                     outstanding_{0};
+
+        statistics                      statistics_;
+
+    }; // class zero_copy_sender
+
+} // namespace bcpp::system
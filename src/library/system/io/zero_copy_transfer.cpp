@@ -0,0 +1,289 @@
+#include "./zero_copy_transfer.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    // the most that sendfile() and splice() move per call
+    static std::size_t constexpr max_transfer_size = 0x7ffff000;
+
+
+    //=========================================================================
+    bool wait_for
+    (
+        // wait for a non blocking descriptor to become ready.  false on error
+        std::int32_t fileDescriptor,
+        std::int16_t events
+    )
+    {
+        pollfd pollFileDescriptor{.fd = fileDescriptor, .events = events, .revents = 0};
+        auto result = ::poll(&pollFileDescriptor, 1, -1);
+        return ((result > 0) || ((result < 0) && (errno == EINTR)));
+    }
+
+
+    //=========================================================================
+    bool is_regular_file
+    (
+        std::int32_t fileDescriptor
+    )
+    {
+        struct stat status;
+        return ((::fstat(fileDescriptor, &status) == 0) && (S_ISREG(status.st_mode)));
+    }
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::zero_copy_transfer::zero_copy_transfer
+(
+):
+    zero_copy_transfer(configuration{})
+{
+}
+
+
+//=============================================================================
+bcpp::system::zero_copy_transfer::zero_copy_transfer
+(
+    configuration const & config
+):
+    configuration_(config)
+{
+}
+
+
+//=============================================================================
+auto bcpp::system::zero_copy_transfer::acquire_pipe
+(
+) -> std::optional<pipe>
+{
+    {
+        std::lock_guard lockGuard(mutex_);
+        if (!pipes_.empty())
+        {
+            auto p = std::move(pipes_.back());
+            pipes_.pop_back();
+            return p;
+        }
+    }
+    // non blocking so that vmsplice() of more pages than the pipe holds
+    // returns a partial count rather than waiting for a reader (this thread)
+    std::int32_t fileDescriptors[2];
+    if (::pipe2(fileDescriptors, O_CLOEXEC | O_NONBLOCK) != 0)
+        return std::nullopt;
+    pipe p{.read_ = fileDescriptors[0], .write_ = fileDescriptors[1], .size_ = 0};
+    auto size = ::fcntl(p.write_.get(), F_SETPIPE_SZ, static_cast<std::int32_t>(configuration_.pipeSize_));
+    if (size < 0)
+        size = ::fcntl(p.write_.get(), F_GETPIPE_SZ);
+    if (size <= 0)
+        return std::nullopt;
+    p.size_ = static_cast<std::size_t>(size);
+    ++pipesCreated_;
+    return p;
+}
+
+
+//=============================================================================
+void bcpp::system::zero_copy_transfer::release_pipe
+(
+    // only empty pipes are released.  a pipe holding data after an error is closed
+    pipe p
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    if (pipes_.size() < configuration_.maxPooledPipes_)
+        pipes_.push_back(std::move(p));
+}
+
+
+//=============================================================================
+bool bcpp::system::zero_copy_transfer::drain_pipe
+(
+    // splice size bytes from the pipe to the destination
+    pipe & p,
+    std::size_t size,
+    file_descriptor const & destination
+)
+{
+    while (size > 0)
+    {
+        auto spliced = ::splice(p.read_.get(), nullptr, destination.get(), nullptr, size, SPLICE_F_MOVE);
+        if (spliced > 0)
+        {
+            size -= spliced;
+            bytesSpliced_ += spliced;
+            continue;
+        }
+        if ((spliced < 0) && (errno == EAGAIN) && (wait_for(destination.get(), POLLOUT)))
+            continue;
+        if ((spliced < 0) && (errno == EINTR))
+            continue;
+        return false;
+    }
+    return true;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::zero_copy_transfer::write
+(
+    std::span<std::byte const> data,
+    file_descriptor const & destination
+)
+{
+    if ((data.empty()) || (!destination.is_valid()))
+        return 0;
+    auto p = acquire_pipe();
+    if (!p)
+        return 0;
+
+    std::size_t written = 0;
+    while (written < data.size())
+    {
+        iovec iov{.iov_base = const_cast<std::byte *>(data.data() + written), .iov_len = std::min(data.size() - written, p->size_)};
+        auto vmspliced = ::vmsplice(p->write_.get(), &iov, 1, 0);
+        if (vmspliced <= 0)
+        {
+            if ((vmspliced < 0) && (errno == EINTR))
+                continue;
+            release_pipe(std::move(*p));
+            return written;
+        }
+        bytesVmspliced_ += vmspliced;
+        if (!drain_pipe(*p, vmspliced, destination))
+            return written;
+        written += vmspliced;
+    }
+    release_pipe(std::move(*p));
+    return written;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::zero_copy_transfer::transfer
+(
+    file_descriptor const & source,
+    file_descriptor const & destination,
+    std::size_t size,
+    std::optional<std::size_t> sourceOffset
+)
+{
+    if ((size == 0) || (!source.is_valid()) || (!destination.is_valid()))
+        return 0;
+    if (!is_regular_file(source.get()))
+        return splice_transfer(source, destination, size, sourceOffset);
+
+    auto offset = static_cast<loff_t>(sourceOffset.value_or(0));
+    auto * offsetPointer = sourceOffset.has_value() ? &offset : nullptr;
+    std::size_t transferred = 0;
+
+    if (is_regular_file(destination.get()))
+    {
+        while (transferred < size)
+        {
+            auto copied = ::copy_file_range(source.get(), offsetPointer, destination.get(), nullptr, size - transferred, 0);
+            if (copied > 0)
+            {
+                transferred += copied;
+                bytesCopiedFileRange_ += copied;
+                continue;
+            }
+            if ((copied < 0) && (errno == EINTR))
+                continue;
+            // file systems (or kernels) which can not copy between these files fall back to sendfile()
+            if ((copied < 0) && (transferred == 0) && ((errno == EXDEV) || (errno == EINVAL) || (errno == EOPNOTSUPP) || (errno == ENOSYS)))
+                break;
+            return transferred;
+        }
+        if (transferred > 0)
+            return transferred;
+    }
+
+    while (transferred < size)
+    {
+        auto sent = ::sendfile(destination.get(), source.get(), offsetPointer, std::min(size - transferred, max_transfer_size));
+        if (sent > 0)
+        {
+            transferred += sent;
+            bytesSentFile_ += sent;
+            continue;
+        }
+        if ((sent < 0) && (errno == EAGAIN) && (wait_for(destination.get(), POLLOUT)))
+            continue;
+        if ((sent < 0) && (errno == EINTR))
+            continue;
+        // ie: a destination opened with O_APPEND
+        if ((sent < 0) && (transferred == 0) && (errno == EINVAL))
+            return splice_transfer(source, destination, size, sourceOffset);
+        break;
+    }
+    return transferred;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::zero_copy_transfer::splice_transfer
+(
+    // source to pipe to destination
+    file_descriptor const & source,
+    file_descriptor const & destination,
+    std::size_t size,
+    std::optional<std::size_t> sourceOffset
+)
+{
+    auto p = acquire_pipe();
+    if (!p)
+        return 0;
+    auto offset = static_cast<loff_t>(sourceOffset.value_or(0));
+    auto * offsetPointer = sourceOffset.has_value() ? &offset : nullptr;
+
+    std::size_t transferred = 0;
+    while (transferred < size)
+    {
+        auto spliced = ::splice(source.get(), offsetPointer, p->write_.get(), nullptr, std::min(size - transferred, p->size_), SPLICE_F_MOVE);
+        if (spliced == 0)
+            break;
+        if (spliced < 0)
+        {
+            // the pipe is empty so EAGAIN is the (non blocking) source
+            if ((errno == EAGAIN) && (wait_for(source.get(), POLLIN)))
+                continue;
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        bytesSpliced_ += spliced;
+        if (!drain_pipe(*p, spliced, destination))
+            return transferred;
+        transferred += spliced;
+    }
+    release_pipe(std::move(*p));
+    return transferred;
+}
+
+
+//=============================================================================
+auto bcpp::system::zero_copy_transfer::get_statistics
+(
+) const -> statistics
+{
+    return {
+                .bytesVmspliced_ = bytesVmspliced_.load(std::memory_order_relaxed),
+                .bytesSpliced_ = bytesSpliced_.load(std::memory_order_relaxed),
+                .bytesSentFile_ = bytesSentFile_.load(std::memory_order_relaxed),
+                .bytesCopiedFileRange_ = bytesCopiedFileRange_.load(std::memory_order_relaxed),
+                .pipesCreated_ = pipesCreated_.load(std::memory_order_relaxed)
+            };
+}
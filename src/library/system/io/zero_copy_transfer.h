@@ -0,0 +1,140 @@
+#pragma once
+
+#include <include/file_descriptor.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // zero_copy_transfer
+    //
+    // moves data to a file_descriptor without copying it through user space
+    // (or, where the destination allows, without copying it at all).
+    //
+    // write() moves memory (ie: a shared_memory or memory_mapping buffer)
+    // with vmsplice() into a pipe which maps the pages rather than copying
+    // them, then with splice() from the pipe to the destination.  because
+    // the destination may reference the pages after write() returns (ie: a
+    // tcp socket until the data is acknowledged) the memory should not be
+    // modified until the consumer is known to have the data.  write() to a
+    // file copies into the page cache and so has no such restriction.
+    //
+    // transfer() moves from a file to any descriptor.  file to file uses
+    // copy_file_range() (an in kernel copy which some file systems perform
+    // by sharing extents), file to anything else uses sendfile() and any
+    // other source (ie: a socket or pipe) is spliced through a pipe.
+    //
+    // pipes are pooled (and sized with F_SETPIPE_SZ) so that a transfer
+    // costs no pipe creation.  both calls move all of the data unless an
+    // error occurs, waiting (poll) on a non blocking destination which is
+    // full.  a zero_copy_transfer may be shared by threads.
+    //=========================================================================
+    class zero_copy_transfer :
+        non_copyable
+    {
+    public:
+
+        struct configuration
+        {
+            std::size_t     pipeSize_{1 << 20};         // F_SETPIPE_SZ (limited by /proc/sys/fs/pipe-max-size)
+            std::size_t     maxPooledPipes_{8};
+        };
+
+        struct statistics
+        {
+            std::uint64_t   bytesVmspliced_{0};
+            std::uint64_t   bytesSpliced_{0};
+            std::uint64_t   bytesSentFile_{0};
+            std::uint64_t   bytesCopiedFileRange_{0};
+            std::uint64_t   pipesCreated_{0};
+        };
+
+        zero_copy_transfer();
+
+        explicit zero_copy_transfer
+        (
+            configuration const &
+        );
+
+        // returns the number of bytes written.  less than the size of the
+        // span only on error (see errno)
+        std::size_t write
+        (
+            std::span<std::byte const>,
+            file_descriptor const &
+        );
+
+        // size bytes from the source (at sourceOffset if provided, in which
+        // case the source's file position is unchanged) to the destination.
+        // returns the number of bytes moved which is less than size at the
+        // end of the source or on error
+        std::size_t transfer
+        (
+            file_descriptor const &,
+            file_descriptor const &,
+            std::size_t,
+            std::optional<std::size_t> = std::nullopt
+        );
+
+        statistics get_statistics() const;
+
+    private:
+
+        struct pipe
+        {
+            file_descriptor     read_;
+            file_descriptor     write_;
+            std::size_t         size_;
+        };
+
+        std::optional<pipe> acquire_pipe();
+
+        void release_pipe
+        (
+            pipe
+        );
+
+        bool drain_pipe
+        (
+            pipe &,
+            std::size_t,
+            file_descriptor const &
+        );
+
+        std::size_t splice_transfer
+        (
+            file_descriptor const &,
+            file_descriptor const &,
+            std::size_t,
+            std::optional<std::size_t>
+        );
+
+        configuration                   configuration_;
+
+        mutable std::mutex              mutex_;
+
+        std::vector<pipe>               pipes_;
+
+        std::atomic<std::uint64_t>      bytesVmspliced_{0};
+
+        std::atomic<std::uint64_t>      bytesSpliced_{0};
+
+        std::atomic<std::uint64_t>      bytesSentFile_{0};
+
+        std::atomic<std::uint64_t>      bytesCopiedFileRange_{0};
+
+        std::atomic<std::uint64_t>      pipesCreated_{0};
+
+    }; // class zero_copy_transfer
+
+} // namespace bcpp::system
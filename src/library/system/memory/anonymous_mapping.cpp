@@ -1,5 +1,9 @@
 #include "./anonymous_mapping.h"
 
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 
 //=============================================================================
 bcpp::system::anonymous_mapping::anonymous_mapping
@@ -12,7 +16,8 @@ bcpp::system::anonymous_mapping::anonymous_mapping
                 .size_ = config.size_,
                 .ioMode_ = io_mode::read_write,
                 .mmapFlags_ = config.mmapFlags_ | MAP_PRIVATE | MAP_ANONYMOUS,
-                .alignment_ = config.alignment_
+                .alignment_ = config.alignment_,
+                .tag_ = config.tag_
             },
             memory_mapping::event_handlers{
                 .closeHandler_ = [closeHandler = eventHandlers.closeHandler_]
@@ -26,4 +31,21 @@ bcpp::system::anonymous_mapping::anonymous_mapping
             },
             {})
 {
+    if ((config.numaNode_.has_value()) && (is_valid()) && (*config.numaNode_ >= 0) && (*config.numaNode_ < 64))
+    {
+        // pages are not yet faulted in so binding now places every page on the node
+        unsigned long nodeMask = (1ul << *config.numaNode_);
+        if (::syscall(SYS_mbind, data(), size(), MPOL_BIND, &nodeMask, sizeof(nodeMask) * 8, 0) == 0)
+            numaNode_ = config.numaNode_;
+    }
+}
+
+
+//=============================================================================
+auto bcpp::system::anonymous_mapping::numa_node
+(
+    // the node to which the mapping is bound.  empty if not bound
+) const -> std::optional<std::int32_t>
+{
+    return numaNode_;
 }
@@ -2,6 +2,10 @@
 
 #include "./memory_mapping.h"
 
+#include <cstdint>
+#include <optional>
+#include <string>
+
 
 namespace bcpp::system
 {
@@ -19,6 +23,9 @@ namespace bcpp::system
             std::size_t     size_;
             std::size_t     mmapFlags_ = {MAP_PRIVATE | MAP_ANONYMOUS};
             std::size_t     alignment_{1024};
+            // bind the pages of the mapping to this numa node (MPOL_BIND)
+            std::optional<std::int32_t> numaNode_;
+            std::string     tag_{"anonymous"};  // accounting tag (see mapping_registry)
         };
 
         struct event_handlers
@@ -36,6 +43,12 @@ namespace bcpp::system
         anonymous_mapping(anonymous_mapping &&) = default;
         anonymous_mapping & operator = (anonymous_mapping &&) = default;
         virtual ~anonymous_mapping() = default;
+
+        std::optional<std::int32_t> numa_node() const;
+
+    private:
+
+        std::optional<std::int32_t> numaNode_;
     }; // class anonymous_mapping
 
 } // namespace bcpp::system
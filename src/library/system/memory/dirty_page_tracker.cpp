@@ -0,0 +1,231 @@
+#include "./dirty_page_tracker.h"
+
+#include <include/file_descriptor.h>
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    static std::uint64_t constexpr soft_dirty_bit = (1ull << 55);
+
+    // clear_refs is process wide so soft dirty trackers are scanned together
+    std::mutex softDirtyMutex;
+    std::vector<bcpp::system::dirty_page_tracker *> softDirtyTrackers;
+
+
+    //=========================================================================
+    bool read_pagemap
+    (
+        // the pagemap entries of count pages from address
+        std::int32_t fileDescriptor,
+        void const * address,
+        std::size_t pageSize,
+        std::uint64_t * entries,
+        std::size_t count
+    )
+    {
+        auto offset = static_cast<off_t>((reinterpret_cast<std::uintptr_t>(address) / pageSize) * sizeof(std::uint64_t));
+        auto size = (count * sizeof(std::uint64_t));
+        return (::pread(fileDescriptor, entries, size, offset) == static_cast<ssize_t>(size));
+    }
+
+
+    //=========================================================================
+    bool clear_soft_dirty
+    (
+    )
+    {
+        bcpp::system::file_descriptor fileDescriptor(::open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC));
+        return ((fileDescriptor.is_valid()) && (::write(fileDescriptor.get(), "4", 1) == 1));
+    }
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::dirty_page_tracker::dirty_page_tracker
+(
+    std::span<std::byte const> region,
+    configuration const & config
+):
+    region_(region),
+    trackingMethod_(config.trackingMethod_),
+    pageSize_(static_cast<std::size_t>(::getpagesize())),
+    pageCount_((region.size() + pageSize_ - 1) / pageSize_),
+    bitmapSize_((pageCount_ + 63) / 64)
+{
+    bitmap_ = std::make_unique<std::atomic<std::uint64_t>[]>(bitmapSize_);
+    for (std::size_t i = 0; i < bitmapSize_; ++i)
+        bitmap_[i].store(0, std::memory_order_relaxed);
+    if (trackingMethod_ == tracking_method::bitmap)
+    {
+        valid_ = true;
+        return;
+    }
+    if ((!is_soft_dirty_supported()) || ((reinterpret_cast<std::uintptr_t>(region.data()) % pageSize_) != 0))
+        return;
+    std::lock_guard lockGuard(softDirtyMutex);
+    softDirtyTrackers.push_back(this);
+    valid_ = true;
+}
+
+
+//=============================================================================
+bcpp::system::dirty_page_tracker::~dirty_page_tracker
+(
+)
+{
+    if ((trackingMethod_ == tracking_method::soft_dirty) && (valid_))
+    {
+        std::lock_guard lockGuard(softDirtyMutex);
+        std::erase(softDirtyTrackers, this);
+    }
+}
+
+
+//=============================================================================
+bool bcpp::system::dirty_page_tracker::is_soft_dirty_supported
+(
+    // a newly faulted page is soft dirty where the kernel tracks it
+)
+{
+    static bool const supported = []()
+            {
+                auto pageSize = static_cast<std::size_t>(::getpagesize());
+                auto * page = ::mmap(nullptr, pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (page == MAP_FAILED)
+                    return false;
+                *static_cast<volatile std::uint8_t *>(page) = 1;
+                file_descriptor fileDescriptor(::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC));
+                std::uint64_t entry = 0;
+                auto supported = ((fileDescriptor.is_valid()) && (read_pagemap(fileDescriptor.get(), page, pageSize, &entry, 1)) &&
+                        ((entry & soft_dirty_bit) != 0));
+                ::munmap(page, pageSize);
+                return supported;
+            }();
+    return supported;
+}
+
+
+//=============================================================================
+bool bcpp::system::dirty_page_tracker::is_valid
+(
+) const
+{
+    return valid_;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::dirty_page_tracker::page_size
+(
+) const
+{
+    return pageSize_;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::dirty_page_tracker::page_count
+(
+) const
+{
+    return pageCount_;
+}
+
+
+//=============================================================================
+void bcpp::system::dirty_page_tracker::mark_dirty
+(
+    std::size_t offset,
+    std::size_t size
+)
+{
+    if ((size == 0) || (offset >= region_.size()))
+        return;
+    auto firstPage = (offset / pageSize_);
+    auto lastPage = (std::min(offset + size, region_.size()) - 1) / pageSize_;
+    for (auto page = firstPage; page <= lastPage; ++page)
+    {
+        auto & word = bitmap_[page / 64];
+        auto bit = (1ull << (page % 64));
+        // a load first so that rewriting a page already marked costs no write to the shared line
+        if ((word.load(std::memory_order_relaxed) & bit) == 0)
+            word.fetch_or(bit, std::memory_order_release);
+    }
+}
+
+
+//=============================================================================
+void bcpp::system::dirty_page_tracker::mark_all_dirty
+(
+)
+{
+    mark_dirty(0, region_.size());
+}
+
+
+//=============================================================================
+void bcpp::system::dirty_page_tracker::scan_soft_dirty
+(
+    // accumulate the soft dirty bits into the bitmap.  softDirtyMutex is held
+)
+{
+    file_descriptor fileDescriptor(::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC));
+    if (!fileDescriptor.is_valid())
+        return;
+    static std::size_t constexpr batch_size = 4096;
+    std::vector<std::uint64_t> entries(batch_size);
+    for (std::size_t first = 0; first < pageCount_; first += batch_size)
+    {
+        auto count = std::min(batch_size, pageCount_ - first);
+        if (!read_pagemap(fileDescriptor.get(), region_.data() + (first * pageSize_), pageSize_, entries.data(), count))
+            return;
+        for (std::size_t i = 0; i < count; ++i)
+            if ((entries[i] & soft_dirty_bit) != 0)
+                mark_dirty((first + i) * pageSize_, 1);
+    }
+}
+
+
+//=============================================================================
+auto bcpp::system::dirty_page_tracker::collect
+(
+) -> std::vector<page_range>
+{
+    if (!valid_)
+        return {};
+    if (trackingMethod_ == tracking_method::soft_dirty)
+    {
+        std::lock_guard lockGuard(softDirtyMutex);
+        for (auto * tracker : softDirtyTrackers)
+            tracker->scan_soft_dirty();
+        clear_soft_dirty();
+    }
+
+    std::vector<page_range> pageRanges;
+    for (std::size_t i = 0; i < bitmapSize_; ++i)
+    {
+        if (bitmap_[i].load(std::memory_order_relaxed) == 0)
+            continue;
+        auto bits = bitmap_[i].exchange(0, std::memory_order_acquire);
+        while (bits != 0)
+        {
+            auto page = ((i * 64) + std::countr_zero(bits));
+            bits &= (bits - 1);
+            if ((!pageRanges.empty()) && ((pageRanges.back().firstPage_ + pageRanges.back().pageCount_) == page))
+                ++pageRanges.back().pageCount_;
+            else
+                pageRanges.push_back({.firstPage_ = page, .pageCount_ = 1});
+        }
+    }
+    return pageRanges;
+}
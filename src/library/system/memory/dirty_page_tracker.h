@@ -0,0 +1,114 @@
+#pragma once
+
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // dirty_page_tracker
+    //
+    // reports which pages of a region (ie: a memory_mapping or shared_memory)
+    // have been written since the previous collect() so that only those
+    // pages need to be copied (ie: by a replication_sender).
+    //
+    //  soft_dirty - the kernel marks each page table entry written by this
+    //               process (/proc/self/pagemap) and collect() clears the
+    //               marks (/proc/self/clear_refs).  writers need not
+    //               cooperate but only writes by this process are seen (not
+    //               those of other processes sharing the memory) and the
+    //               kernel must be built with CONFIG_MEM_SOFT_DIRTY.  the
+    //               marks are cleared for the whole process so every
+    //               soft_dirty tracker is collected whenever any one is.  a
+    //               write which lands between the reading and the clearing of
+    //               the marks is missed, so for exact tracking writers should
+    //               be paused across collect().
+    //
+    //  bitmap     - writers mark what they write (mark_dirty()) in a bitmap
+    //               of atomic words.  exact (a page marked after it is written
+    //               is never missed) and portable but every writer must mark.
+    //
+    // soft_dirty trackers are not valid (is_valid()) where the kernel does
+    // not support soft dirty bits.
+    //=========================================================================
+    class dirty_page_tracker :
+        non_copyable
+    {
+    public:
+
+        enum class tracking_method
+        {
+            soft_dirty,
+            bitmap
+        };
+
+        struct configuration
+        {
+            tracking_method     trackingMethod_{tracking_method::soft_dirty};
+        };
+
+        struct page_range
+        {
+            std::size_t     firstPage_;
+            std::size_t     pageCount_;
+        };
+
+        dirty_page_tracker
+        (
+            std::span<std::byte const>,
+            configuration const &
+        );
+
+        ~dirty_page_tracker();
+
+        bool is_valid() const;
+
+        static bool is_soft_dirty_supported();
+
+        std::size_t page_size() const;
+
+        std::size_t page_count() const;
+
+        // writers (any thread) mark bytes which they have written.  a write
+        // must be marked after it is made
+        void mark_dirty
+        (
+            std::size_t,
+            std::size_t
+        );
+
+        // mark every page (ie: to copy the whole region once)
+        void mark_all_dirty();
+
+        // the runs of pages written since the previous collect()
+        std::vector<page_range> collect();
+
+    private:
+
+        void scan_soft_dirty();
+
+        std::span<std::byte const>                      region_;
+
+        tracking_method                                 trackingMethod_;
+
+        std::size_t                                     pageSize_;
+
+        std::size_t                                     pageCount_;
+
+        std::unique_ptr<std::atomic<std::uint64_t>[]>   bitmap_;
+
+        std::size_t                                     bitmapSize_;    // in words
+
+        bool                                            valid_{false};
+
+    }; // class dirty_page_tracker
+
+} // namespace bcpp::system
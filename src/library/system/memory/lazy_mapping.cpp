@@ -0,0 +1,294 @@
+#include "./lazy_mapping.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <linux/userfaultfd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    //=========================================================================
+    std::int32_t open_user_fault_file_descriptor
+    (
+        // handling faults in the kernel (ie: a read() into the mapping) needs
+        // privilege where vm.unprivileged_userfaultfd is 0.  otherwise only
+        // faults in user mode are handled
+    )
+    {
+        auto fileDescriptor = static_cast<std::int32_t>(::syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK));
+        #ifdef UFFD_USER_MODE_ONLY
+            if (fileDescriptor < 0)
+                fileDescriptor = static_cast<std::int32_t>(::syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY));
+        #endif
+        return fileDescriptor;
+    }
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::lazy_mapping::lazy_mapping
+(
+    configuration const & config,
+    loader loader
+):
+    loader_(std::move(loader)),
+    pageSize_(static_cast<std::size_t>(::getpagesize())),
+    pageCount_((config.size_ + pageSize_ - 1) / pageSize_),
+    prefetchPages_(config.prefetchPages_),
+    mapping_({.size_ = config.size_, .alignment_ = pageSize_, .tag_ = config.tag_}, {}),
+    staging_({.size_ = (prefetchPages_ + 1) * pageSize_, .alignment_ = pageSize_, .tag_ = config.tag_ + ".staging"}, {}),
+    residency_(prefetchPages_ + 1)
+{
+    if ((!mapping_.is_valid()) || (!staging_.is_valid()) || (loader_ == nullptr))
+        return;
+    userFaultFileDescriptor_ = file_descriptor(open_user_fault_file_descriptor());
+    eventFileDescriptor_ = file_descriptor(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+    if ((!userFaultFileDescriptor_.is_valid()) || (!eventFileDescriptor_.is_valid()))
+        return;
+
+    uffdio_api api{.api = UFFD_API, .features = 0};
+    if (::ioctl(userFaultFileDescriptor_.get(), UFFDIO_API, &api) != 0)
+        return;
+    uffdio_register registration{};
+    registration.range = {.start = reinterpret_cast<std::uint64_t>(mapping_.data()), .len = (pageCount_ * pageSize_)};
+    registration.mode = UFFDIO_REGISTER_MODE_MISSING;
+    if (::ioctl(userFaultFileDescriptor_.get(), UFFDIO_REGISTER, &registration) != 0)
+        return;
+    valid_ = ((registration.ioctls & (1ull << _UFFDIO_COPY)) != 0);
+}
+
+
+//=============================================================================
+bool bcpp::system::lazy_mapping::is_valid
+(
+) const
+{
+    return valid_;
+}
+
+
+//=============================================================================
+std::byte const * bcpp::system::lazy_mapping::data
+(
+) const
+{
+    return mapping_.data();
+}
+
+
+//=============================================================================
+std::byte * bcpp::system::lazy_mapping::data
+(
+)
+{
+    return mapping_.data();
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::lazy_mapping::size
+(
+) const
+{
+    return mapping_.size();
+}
+
+
+//=============================================================================
+void bcpp::system::lazy_mapping::copy
+(
+    // copy pages from staging_ into the mapping, waking the threads which
+    // fault on them.  pages which became resident meanwhile are skipped
+    std::size_t firstPage,
+    std::size_t pageCount
+)
+{
+    auto offset = std::size_t{0};
+    auto size = (pageCount * pageSize_);
+    while (offset < size)
+    {
+        uffdio_copy copy{
+                .dst = reinterpret_cast<std::uint64_t>(mapping_.data() + (firstPage * pageSize_) + offset),
+                .src = reinterpret_cast<std::uint64_t>(staging_.data() + offset),
+                .len = (size - offset),
+                .mode = 0,
+                .copy = 0};
+        if (::ioctl(userFaultFileDescriptor_.get(), UFFDIO_COPY, &copy) == 0)
+            return;
+        if (copy.copy > 0)
+            offset += static_cast<std::size_t>(copy.copy);
+        else if (copy.copy == -EEXIST)
+            offset += pageSize_;
+        else if (copy.copy != -EAGAIN)
+        {
+            // never leave a faulting thread held.  zero fill the rest or,
+            // failing that, wake the threads to fault (and be handled) again
+            ++statistics_.copyFailures_;
+            uffdio_zeropage zeroPage{
+                    .range = {.start = copy.dst, .len = copy.len},
+                    .mode = 0,
+                    .zeropage = 0};
+            if (::ioctl(userFaultFileDescriptor_.get(), UFFDIO_ZEROPAGE, &zeroPage) != 0)
+                ::ioctl(userFaultFileDescriptor_.get(), UFFDIO_WAKE, &zeroPage.range);
+            return;
+        }
+    }
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::lazy_mapping::load
+(
+    // load the run of non resident pages starting at firstPage (up to
+    // pageCount pages).  returns the number of pages loaded.  mutex_ is held
+    std::size_t firstPage,
+    std::size_t pageCount,
+    bool fault
+)
+{
+    pageCount = std::min({pageCount, pageCount_ - firstPage, residency_.size()});
+    if (::mincore(mapping_.data() + (firstPage * pageSize_), pageCount * pageSize_, residency_.data()) != 0)
+        std::fill_n(residency_.begin(), pageCount, std::uint8_t{0});
+    if ((residency_[0] & 1) != 0)
+    {
+        if (fault)
+        {
+            // loaded since the fault.  the copy woke the faulting thread but wake it in case
+            uffdio_range range{.start = reinterpret_cast<std::uint64_t>(mapping_.data() + (firstPage * pageSize_)), .len = pageSize_};
+            ::ioctl(userFaultFileDescriptor_.get(), UFFDIO_WAKE, &range);
+        }
+        return 0;
+    }
+    auto runLength = static_cast<std::size_t>(std::distance(residency_.begin(),
+            std::find_if(residency_.begin(), residency_.begin() + pageCount, [](auto residency){return ((residency & 1) != 0);})));
+
+    auto offset = (firstPage * pageSize_);
+    auto size = std::min(runLength * pageSize_, mapping_.size() - offset);
+    if (!loader_(offset, {staging_.data(), size}))
+    {
+        std::memset(staging_.data(), 0, runLength * pageSize_);
+        ++statistics_.loaderFailures_;
+    }
+    else if (size < (runLength * pageSize_))
+    {
+        // the rest of the last page
+        std::memset(staging_.data() + size, 0, (runLength * pageSize_) - size);
+    }
+    copy(firstPage, runLength);
+    statistics_.pagesLoaded_ += runLength;
+    return runLength;
+}
+
+
+//=============================================================================
+bool bcpp::system::lazy_mapping::prefetch
+(
+    std::size_t offset,
+    std::size_t size
+)
+{
+    if ((!valid_) || (offset >= mapping_.size()))
+        return false;
+    auto firstPage = (offset / pageSize_);
+    auto endPage = ((std::min(offset + size, mapping_.size()) + pageSize_ - 1) / pageSize_);
+    std::lock_guard lockGuard(mutex_);
+    for (auto page = firstPage; page < endPage; )
+    {
+        auto loaded = load(page, endPage - page, false);
+        statistics_.pagesPrefetched_ += loaded;
+        page += std::max<std::size_t>(loaded, 1);
+    }
+    return true;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::lazy_mapping::poll
+(
+    std::chrono::milliseconds timeout
+)
+{
+    if (!valid_)
+        return 0;
+    pollfd pollFileDescriptors[2]{{userFaultFileDescriptor_.get(), POLLIN, 0}, {eventFileDescriptor_.get(), POLLIN, 0}};
+    if (::poll(pollFileDescriptors, 2, static_cast<std::int32_t>(timeout.count())) <= 0)
+        return 0;
+    if (pollFileDescriptors[1].revents != 0)
+    {
+        std::uint64_t value;
+        [[maybe_unused]] auto _ = ::read(eventFileDescriptor_.get(), &value, sizeof(value));
+    }
+
+    std::size_t faults = 0;
+    uffd_msg messages[16];
+    while (true)
+    {
+        auto result = ::read(userFaultFileDescriptor_.get(), messages, sizeof(messages));
+        if ((result < 0) && (errno == EINTR))
+            continue;
+        if (result <= 0)
+            break;
+        std::lock_guard lockGuard(mutex_);
+        for (std::size_t i = 0; i < (static_cast<std::size_t>(result) / sizeof(uffd_msg)); ++i)
+        {
+            if (messages[i].event != UFFD_EVENT_PAGEFAULT)
+                continue;
+            auto page = ((messages[i].arg.pagefault.address - reinterpret_cast<std::uint64_t>(mapping_.data())) / pageSize_);
+            auto loaded = load(page, prefetchPages_ + 1, true);
+            statistics_.pagesPrefetched_ += ((loaded > 1) ? (loaded - 1) : 0);
+            ++statistics_.faults_;
+            ++faults;
+        }
+    }
+    return faults;
+}
+
+
+//=============================================================================
+void bcpp::system::lazy_mapping::run
+(
+    std::stop_token const & stopToken
+)
+{
+    std::stop_callback stopCallback(stopToken, [this]()
+            {
+                std::uint64_t value = 1;
+                [[maybe_unused]] auto _ = ::write(eventFileDescriptor_.get(), &value, sizeof(value));
+            });
+    while (!stopToken.stop_requested())
+        poll(std::chrono::milliseconds(-1));
+}
+
+
+//=============================================================================
+auto bcpp::system::lazy_mapping::handler
+(
+    std::optional<cpu_id> cpuId,
+    std::string_view name
+) -> thread_pool::thread_configuration
+{
+    return {
+                .function_ = [this](std::stop_token const & stopToken){run(stopToken);},
+                .cpuId_ = cpuId,
+                .name_ = std::string(name)
+            };
+}
+
+
+//=============================================================================
+auto bcpp::system::lazy_mapping::get_statistics
+(
+) const -> statistics
+{
+    std::lock_guard lockGuard(mutex_);
+    return statistics_;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "./anonymous_mapping.h"
+
+#include <library/system/cpu_id.h>
+#include <library/system/threading/thread_pool.h>
+#include <include/file_descriptor.h>
+#include <include/non_copyable.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // lazy_mapping
+    //
+    // a private anonymous mapping whose pages are filled on first access by
+    // a loader (ie: which reads or decompresses the corresponding part of a
+    // dataset) so that a process pays (in time and in resident memory) only
+    // for the pages it touches.  the mapping is registered with userfaultfd
+    // and a thread which first touches a missing page is held by the kernel
+    // until the handler (a thread_pool worker, see handler(), or a caller of
+    // poll()) has loaded it.
+    //
+    // each fault also loads up to prefetchPages_ following pages which are
+    // not yet resident, in the same call of the loader and the same copy
+    // into the mapping, so that sequential access faults once per run.
+    //
+    // the loader is called with the offset of the first page to load and the
+    // bytes to fill (whole pages, except at the end of the mapping).  it is
+    // called from the handler and must never touch the lazy_mapping itself.
+    // if it fails the pages are zero filled (rather than leave the faulting
+    // thread held forever) and counted in loaderFailures_.  likewise if the
+    // kernel refuses to copy the loaded pages into the mapping (counted in
+    // copyFailures_).
+    //
+    // the handler must be stopped before the lazy_mapping is destroyed.
+    // is_valid() is false if userfaultfd is not available (ie: where
+    // vm.unprivileged_userfaultfd is 0 and the kernel predates
+    // UFFD_USER_MODE_ONLY).
+    //=========================================================================
+    class lazy_mapping :
+        non_copyable
+    {
+    public:
+
+        using loader = std::function<bool(std::size_t, std::span<std::byte>)>;
+
+        struct configuration
+        {
+            std::size_t     size_;
+            std::size_t     prefetchPages_{15};
+            std::string     tag_{"lazy"};       // accounting tag (see mapping_registry)
+        };
+
+        struct statistics
+        {
+            std::uint64_t   faults_{0};
+            std::uint64_t   pagesLoaded_{0};    // including those prefetched
+            std::uint64_t   pagesPrefetched_{0};
+            std::uint64_t   loaderFailures_{0};
+            std::uint64_t   copyFailures_{0};
+        };
+
+        lazy_mapping
+        (
+            configuration const &,
+            loader
+        );
+
+        bool is_valid() const;
+
+        std::byte const * data() const;
+
+        std::byte * data();
+
+        std::size_t size() const;
+
+        // load a range in advance (ie: from a thread which knows what will be
+        // needed).  pages which are already resident are skipped
+        bool prefetch
+        (
+            std::size_t,
+            std::size_t
+        );
+
+        // wait at most timeout (negative for no limit) for faults and load
+        // them.  returns the number of faults handled
+        std::size_t poll
+        (
+            std::chrono::milliseconds
+        );
+
+        // poll until stop is requested
+        void run
+        (
+            std::stop_token const &
+        );
+
+        // a thread_pool worker which handles the faults
+        thread_pool::thread_configuration handler
+        (
+            std::optional<cpu_id> = std::nullopt,
+            std::string_view = "lazy_mapping"
+        );
+
+        statistics get_statistics() const;
+
+    private:
+
+        std::size_t load
+        (
+            std::size_t,
+            std::size_t,
+            bool
+        );
+
+        void copy
+        (
+            std::size_t,
+            std::size_t
+        );
+
+        loader                      loader_;
+
+        std::size_t                 pageSize_;
+
+        std::size_t                 pageCount_;
+
+        std::size_t                 prefetchPages_;
+
+        anonymous_mapping           mapping_;
+
+        file_descriptor             userFaultFileDescriptor_;
+
+        file_descriptor             eventFileDescriptor_;
+
+        // serializes the loads (and the use of staging_)
+        mutable std::mutex          mutex_;
+
+        anonymous_mapping           staging_;
+
+        std::vector<std::uint8_t>   residency_;
+
+        statistics                  statistics_;
+
+        bool                        valid_{false};
+
+    }; // class lazy_mapping
+
+} // namespace bcpp::system
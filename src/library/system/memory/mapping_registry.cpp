@@ -0,0 +1,438 @@
+#include "./mapping_registry.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <sstream>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    struct vma
+    {
+        std::uintptr_t  begin_;
+        std::uintptr_t  end_;
+        std::size_t     lockedBytes_{0};
+        std::size_t     hugePageBytes_{0};
+    };
+
+    struct range
+    {
+        std::uintptr_t  address_;
+        std::size_t     size_;
+        std::string     tag_;
+        bool            idle_;
+    };
+
+
+    //=========================================================================
+    std::size_t page_size
+    (
+    )
+    {
+        static auto const pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return pageSize;
+    }
+
+
+    //=========================================================================
+    std::vector<vma> read_vmas
+    (
+        // the locked and huge page bytes of each of this process's vmas.  ordered by address
+    )
+    {
+        std::vector<vma> vmas;
+        std::ifstream smapsFile("/proc/self/smaps");
+        std::string line;
+        while (std::getline(smapsFile, line))
+        {
+            if (auto dash = line.find('-'); (dash != std::string::npos) && (line.find(':') > line.find(' ')))
+            {
+                // vma header line.  ie: "7f12a0000000-7f12a4000000 rw-s 00000000 00:01 1234 /dev/shm/name"
+                auto space = line.find(' ');
+                vmas.push_back({.begin_ = std::stoull(line.substr(0, dash), nullptr, 16), .end_ = std::stoull(line.substr(dash + 1, space - dash - 1), nullptr, 16)});
+                continue;
+            }
+            if (vmas.empty())
+                continue;
+            std::istringstream stream(line);
+            std::string key;
+            std::size_t kiloBytes = 0;
+            if (!(stream >> key >> kiloBytes))
+                continue;
+            if (key == "Locked:")
+                vmas.back().lockedBytes_ += (kiloBytes * 1024);
+            else if ((key == "AnonHugePages:") || (key == "ShmemPmdMapped:") || (key == "FilePmdMapped:") ||
+                    (key == "Shared_Hugetlb:") || (key == "Private_Hugetlb:"))
+                vmas.back().hugePageBytes_ += (kiloBytes * 1024);
+        }
+        return vmas;
+    }
+
+
+    //=========================================================================
+    void accumulate
+    (
+        // add the resident, locked and huge page bytes of the range to usage
+        range const & r,
+        std::vector<vma> const & vmas,
+        bcpp::system::mapping_registry::usage & usage
+    )
+    {
+        auto pageSize = page_size();
+        auto begin = r.address_ & ~(pageSize - 1);
+        auto end = r.address_ + r.size_;
+
+        std::vector<unsigned char> residency(((end - begin) + pageSize - 1) / pageSize);
+        if (::mincore(reinterpret_cast<void *>(begin), end - begin, residency.data()) == 0)
+            usage.residentBytes_ += (std::count_if(residency.begin(), residency.end(), [](auto page){return ((page & 1) != 0);}) * pageSize);
+
+        // adjacent mappings with identical flags share a vma so its counts are prorated by overlap
+        auto iter = std::upper_bound(vmas.begin(), vmas.end(), begin, [](auto address, auto const & v){return (address < v.end_);});
+        for (; (iter != vmas.end()) && (iter->begin_ < end); ++iter)
+        {
+            auto overlap = std::min(end, iter->end_) - std::max(begin, iter->begin_);
+            auto vmaSize = iter->end_ - iter->begin_;
+            usage.lockedBytes_ += ((iter->lockedBytes_ * overlap) / vmaSize);
+            usage.hugePageBytes_ += ((iter->hugePageBytes_ * overlap) / vmaSize);
+        }
+    }
+
+
+    //=========================================================================
+    bool is_exceeded
+    (
+        bcpp::system::mapping_registry::budget const & budget,
+        bcpp::system::mapping_registry::usage const & usage
+    )
+    {
+        return (((budget.virtualBytes_.has_value()) && (usage.virtualBytes_ > *budget.virtualBytes_)) ||
+                ((budget.residentBytes_.has_value()) && (usage.residentBytes_ > *budget.residentBytes_)) ||
+                ((budget.lockedBytes_.has_value()) && (usage.lockedBytes_ > *budget.lockedBytes_)));
+    }
+
+} // namespace
+
+
+//=============================================================================
+auto bcpp::system::mapping_registry::instance
+(
+) -> mapping_registry &
+{
+    // never destroyed so that mappings with static storage duration may close safely
+    static auto * registry = new mapping_registry;
+    return *registry;
+}
+
+
+//=============================================================================
+auto bcpp::system::mapping_registry::get_virtual_usage
+(
+    std::string_view tag
+) const -> usage
+{
+    usage result;
+    for (auto const & [address, m] : mappings_)
+    {
+        if ((tag != all_tags) && (m.tag_ != tag))
+            continue;
+        ++result.mappings_;
+        result.virtualBytes_ += m.size_;
+        if (m.idle_)
+            result.idleBytes_ += m.size_;
+    }
+    return result;
+}
+
+
+//=============================================================================
+bool bcpp::system::mapping_registry::add
+(
+    void const * address,
+    std::size_t size,
+    std::string_view tag,
+    bool shared
+)
+{
+    std::vector<std::pair<budget_handler, usage>> exceeded;
+    auto admitted = true;
+    std::string tagName(tag.empty() ? default_tag : tag);
+    {
+        std::lock_guard lockGuard(mutex_);
+        for (auto const & budgetTag : {std::string_view(all_tags), std::string_view(tagName)})
+        {
+            auto iter = budgets_.find(budgetTag);
+            if ((iter == budgets_.end()) || (!iter->second.virtualBytes_.has_value()))
+                continue;
+            auto prospective = get_virtual_usage(budgetTag);
+            ++prospective.mappings_;
+            prospective.virtualBytes_ += size;
+            if (prospective.virtualBytes_ <= *iter->second.virtualBytes_)
+                continue;
+            if (iter->second.enforceVirtualBytes_)
+                admitted = false;
+            if (iter->second.exceededHandler_)
+                exceeded.emplace_back(iter->second.exceededHandler_, prospective);
+        }
+        if (admitted)
+            mappings_[reinterpret_cast<std::uintptr_t>(address)] = {.size_ = size, .tag_ = tagName, .shared_ = shared};
+    }
+    for (auto const & [handler, exceededUsage] : exceeded)
+        handler(tagName, exceededUsage);
+    return admitted;
+}
+
+
+//=============================================================================
+void bcpp::system::mapping_registry::remove
+(
+    void const * address
+)
+{
+    // the caller unmaps the mapping next so wait out any release_idle() advising it
+    std::unique_lock uniqueLock(mutex_);
+    releasedCondition_.wait(uniqueLock, [&]()
+            {
+                auto iter = mappings_.find(reinterpret_cast<std::uintptr_t>(address));
+                return ((iter == mappings_.end()) || (iter->second.releasing_ == 0));
+            });
+    mappings_.erase(reinterpret_cast<std::uintptr_t>(address));
+}
+
+
+//=============================================================================
+std::string bcpp::system::mapping_registry::tag_of
+(
+    void const * address
+) const
+{
+    std::lock_guard lockGuard(mutex_);
+    if (auto iter = mappings_.find(reinterpret_cast<std::uintptr_t>(address)); iter != mappings_.end())
+        return iter->second.tag_;
+    return {};
+}
+
+
+//=============================================================================
+void bcpp::system::mapping_registry::set_idle
+(
+    void const * address,
+    bool idle
+)
+{
+    std::unique_lock uniqueLock(mutex_);
+    auto find = [&](){return mappings_.find(reinterpret_cast<std::uintptr_t>(address));};
+    // a mapping which is about to be written must not be discarded afterwards
+    if (!idle)
+        releasedCondition_.wait(uniqueLock, [&](){return ((find() == mappings_.end()) || (find()->second.releasing_ == 0));});
+    if (auto iter = find(); iter != mappings_.end())
+        iter->second.idle_ = idle;
+}
+
+
+//=============================================================================
+void bcpp::system::mapping_registry::set_budget
+(
+    std::string_view tag,
+    budget value
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    budgets_.insert_or_assign(std::string(tag), std::move(value));
+}
+
+
+//=============================================================================
+void bcpp::system::mapping_registry::clear_budget
+(
+    std::string_view tag
+)
+{
+    std::lock_guard lockGuard(mutex_);
+    if (auto iter = budgets_.find(tag); iter != budgets_.end())
+        budgets_.erase(iter);
+}
+
+
+//=============================================================================
+std::vector<std::string> bcpp::system::mapping_registry::get_tags
+(
+) const
+{
+    std::vector<std::string> tags;
+    std::lock_guard lockGuard(mutex_);
+    for (auto const & [address, m] : mappings_)
+        if (std::find(tags.begin(), tags.end(), m.tag_) == tags.end())
+            tags.push_back(m.tag_);
+    std::sort(tags.begin(), tags.end());
+    return tags;
+}
+
+
+//=============================================================================
+auto bcpp::system::mapping_registry::get_usage
+(
+    std::string_view tag
+) const -> usage
+{
+    if (tag == all_tags)
+    {
+        usage total;
+        for (auto const & [tagName, tagUsage] : get_usage_by_tag())
+        {
+            total.mappings_ += tagUsage.mappings_;
+            total.virtualBytes_ += tagUsage.virtualBytes_;
+            total.residentBytes_ += tagUsage.residentBytes_;
+            total.lockedBytes_ += tagUsage.lockedBytes_;
+            total.hugePageBytes_ += tagUsage.hugePageBytes_;
+            total.idleBytes_ += tagUsage.idleBytes_;
+        }
+        return total;
+    }
+    auto byTag = get_usage_by_tag();
+    if (auto iter = byTag.find(std::string(tag)); iter != byTag.end())
+        return iter->second;
+    return {};
+}
+
+
+//=============================================================================
+auto bcpp::system::mapping_registry::get_usage_by_tag
+(
+) const -> std::map<std::string, usage>
+{
+    std::vector<range> ranges;
+    {
+        std::lock_guard lockGuard(mutex_);
+        ranges.reserve(mappings_.size());
+        for (auto const & [address, m] : mappings_)
+            ranges.push_back({.address_ = address, .size_ = m.size_, .tag_ = m.tag_, .idle_ = m.idle_});
+    }
+
+    // sampled outside of the lock.  a mapping closed meanwhile contributes nothing
+    auto vmas = read_vmas();
+    std::map<std::string, usage> result;
+    for (auto const & r : ranges)
+    {
+        auto & tagUsage = result[r.tag_];
+        ++tagUsage.mappings_;
+        tagUsage.virtualBytes_ += r.size_;
+        if (r.idle_)
+            tagUsage.idleBytes_ += r.size_;
+        accumulate(r, vmas, tagUsage);
+    }
+    return result;
+}
+
+
+//=============================================================================
+auto bcpp::system::mapping_registry::check_budgets
+(
+) -> std::vector<std::string>
+{
+    std::vector<std::pair<std::string, budget>> budgets;
+    {
+        std::lock_guard lockGuard(mutex_);
+        budgets.assign(budgets_.begin(), budgets_.end());
+    }
+    if (budgets.empty())
+        return {};
+
+    auto byTag = get_usage_by_tag();
+    usage total;
+    for (auto const & [tag, tagUsage] : byTag)
+    {
+        total.mappings_ += tagUsage.mappings_;
+        total.virtualBytes_ += tagUsage.virtualBytes_;
+        total.residentBytes_ += tagUsage.residentBytes_;
+        total.lockedBytes_ += tagUsage.lockedBytes_;
+        total.hugePageBytes_ += tagUsage.hugePageBytes_;
+        total.idleBytes_ += tagUsage.idleBytes_;
+    }
+
+    std::vector<std::string> exceeded;
+    for (auto const & [tag, tagBudget] : budgets)
+    {
+        auto tagUsage = (tag == all_tags) ? total : byTag[tag];
+        if (!is_exceeded(tagBudget, tagUsage))
+            continue;
+        exceeded.push_back(tag);
+        if (tagBudget.exceededHandler_)
+            tagBudget.exceededHandler_(tag, tagUsage);
+    }
+    return exceeded;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::mapping_registry::release_idle
+(
+    std::string_view tag,
+    release_advice advice
+)
+{
+    // snapshot the idle mappings and pin them (so that they are neither
+    // closed nor reused while advised) then madvise outside of the lock
+    std::vector<std::pair<std::uintptr_t, std::size_t>> idle;
+    {
+        std::lock_guard lockGuard(mutex_);
+        for (auto & [address, m] : mappings_)
+        {
+            if ((!m.idle_) || (m.shared_) || ((tag != all_tags) && (m.tag_ != tag)))
+                continue;
+            ++m.releasing_;
+            idle.emplace_back(address, m.size_);
+        }
+    }
+
+    std::size_t released = 0;
+    for (auto [address, size] : idle)
+    {
+        auto result = -1;
+        if (advice == release_advice::free)
+            result = ::madvise(reinterpret_cast<void *>(address), size, MADV_FREE);
+        // MADV_FREE is only supported for anonymous mappings
+        if (result != 0)
+            result = ::madvise(reinterpret_cast<void *>(address), size, MADV_DONTNEED);
+        if (result == 0)
+            released += size;
+    }
+
+    if (!idle.empty())
+    {
+        {
+            std::lock_guard lockGuard(mutex_);
+            for (auto [address, size] : idle)
+                --mappings_.at(address).releasing_;
+        }
+        releasedCondition_.notify_all();
+    }
+    return released;
+}
+
+
+//=============================================================================
+auto bcpp::system::mapping_registry::monitor
+(
+    std::chrono::nanoseconds interval,
+    std::string_view name
+) -> thread_pool::thread_configuration
+{
+    return {
+                .function_ = [this, interval](std::stop_token const & stopToken)
+                        {
+                            std::mutex mutex;
+                            std::condition_variable_any conditionVariable;
+                            std::unique_lock uniqueLock(mutex);
+                            do
+                            {
+                                check_budgets();
+                            } while (!conditionVariable.wait_for(uniqueLock, stopToken, interval, [&](){return stopToken.stop_requested();}));
+                        },
+                .name_ = std::string(name)
+            };
+}
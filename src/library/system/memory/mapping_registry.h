@@ -0,0 +1,170 @@
+#pragma once
+
+#include "./memory_mapping.h"
+
+#include <library/system/threading/thread_pool.h>
+#include <include/non_copyable.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // mapping_registry
+    //
+    // process wide accounting of every memory_mapping (and so every
+    // anonymous_mapping and shared_memory segment) by tag.  virtual bytes
+    // are tracked as mappings are created and closed.  resident bytes come
+    // from mincore() and locked and huge page bytes from /proc/self/smaps
+    // (prorated where the kernel has merged adjacent mappings into one vma)
+    // so get_usage() is a sample rather than a free lookup.
+    //
+    // budgets may be set per tag or for the whole process (all_tags).  a
+    // virtual byte budget is checked as each mapping is created and may be
+    // enforced, failing the mapping.  resident and locked budgets are checked
+    // by check_budgets(), usually from the monitor() worker.  the callback of
+    // an exceeded budget is called outside of the registry's lock and may
+    // release_idle() to return memory to the kernel.
+    //=========================================================================
+    class mapping_registry :
+        non_copyable
+    {
+    public:
+
+        static auto constexpr all_tags = "*";
+        static auto constexpr default_tag = "untagged";
+
+        struct usage
+        {
+            std::size_t     mappings_{0};
+            std::size_t     virtualBytes_{0};
+            std::size_t     residentBytes_{0};
+            std::size_t     lockedBytes_{0};
+            std::size_t     hugePageBytes_{0};
+            std::size_t     idleBytes_{0};      // virtual bytes of mappings marked idle
+        };
+
+        using budget_handler = std::function<void(std::string_view, usage const &)>;
+
+        struct budget
+        {
+            std::optional<std::size_t>  virtualBytes_;
+            std::optional<std::size_t>  residentBytes_;
+            std::optional<std::size_t>  lockedBytes_;
+            bool                        enforceVirtualBytes_{false};    // fail mappings which would exceed virtualBytes_
+            budget_handler              exceededHandler_;
+        };
+
+        static mapping_registry & instance();
+
+        // called by memory_mapping.  returns false if the mapping would exceed an
+        // enforced budget in which case it is not registered
+        bool add
+        (
+            void const *,
+            std::size_t,
+            std::string_view,
+            bool shared
+        );
+
+        void remove
+        (
+            void const *
+        );
+
+        std::string tag_of
+        (
+            void const *
+        ) const;
+
+        void set_idle
+        (
+            void const *,
+            bool
+        );
+
+        void set_budget
+        (
+            std::string_view,
+            budget
+        );
+
+        void clear_budget
+        (
+            std::string_view
+        );
+
+        std::vector<std::string> get_tags() const;
+
+        usage get_usage
+        (
+            std::string_view = all_tags
+        ) const;
+
+        std::map<std::string, usage> get_usage_by_tag() const;
+
+        // returns the tags whose budgets were exceeded
+        std::vector<std::string> check_budgets();
+
+        // madvise every idle private mapping with the tag.  returns the bytes
+        // released.  shared mappings (ie: shared_memory) are skipped: advice
+        // only unmaps this process's view of their pages while the segment
+        // keeps them, and freeing them from the segment (MADV_REMOVE) would
+        // discard them for every process.  the madvise calls are made outside
+        // of the registry's lock.  closing the mappings being released (or
+        // marking them no longer idle) waits until they have been released
+        std::size_t release_idle
+        (
+            std::string_view = all_tags,
+            release_advice = release_advice::free
+        );
+
+        // a thread_pool worker which calls check_budgets() every interval
+        thread_pool::thread_configuration monitor
+        (
+            std::chrono::nanoseconds,
+            std::string_view = "mapping_monitor"
+        );
+
+    private:
+
+        struct mapping
+        {
+            std::size_t     size_;
+            std::string     tag_;
+            bool            shared_{false};
+            bool            idle_{false};
+            std::size_t     releasing_{0};  // release_idle() calls advising the mapping
+        };
+
+        mapping_registry() = default;
+
+        // tag's usage of virtual bytes only.  requires mutex_
+        usage get_virtual_usage
+        (
+            std::string_view
+        ) const;
+
+        mutable std::mutex                          mutex_;
+
+        std::condition_variable                     releasedCondition_;     // notified as release_idle() finishes
+
+        std::map<std::uintptr_t, mapping>           mappings_;
+
+        std::map<std::string, budget, std::less<>>  budgets_;
+
+    }; // class mapping_registry
+
+} // namespace bcpp::system
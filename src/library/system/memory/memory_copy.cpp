@@ -0,0 +1,422 @@
+#include "./memory_copy.h"
+
+#include <library/system/topology/cpu_topology.h>
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#endif
+
+
+namespace
+{
+
+    using namespace bcpp::system;
+
+    static std::size_t constexpr default_non_temporal_threshold = (1 << 20);
+
+    std::atomic<std::size_t> nonTemporalThreshold{0};
+
+#if defined(__x86_64__) || defined(__i386__)
+
+    //=========================================================================
+    std::size_t unaligned_head
+    (
+        // bytes to copy conventionally before destination is cache line aligned
+        void const * destination,
+        std::size_t size
+    )
+    {
+        auto misalignment = (reinterpret_cast<std::uintptr_t>(destination) & (cache_line_size - 1));
+        return std::min(size, (cache_line_size - misalignment) & (cache_line_size - 1));
+    }
+
+
+    //=========================================================================
+    __attribute__((target("sse2")))
+    void stream_copy_sse2
+    (
+        void * destination,
+        void const * source,
+        std::size_t size
+    )
+    {
+        auto * out = static_cast<std::uint8_t *>(destination);
+        auto const * in = static_cast<std::uint8_t const *>(source);
+        auto head = unaligned_head(out, size);
+        std::memcpy(out, in, head);
+        out += head;
+        in += head;
+        size -= head;
+        for (; size >= cache_line_size; size -= cache_line_size, out += cache_line_size, in += cache_line_size)
+        {
+            auto a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in));
+            auto b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + 16));
+            auto c = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + 32));
+            auto d = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + 48));
+            _mm_stream_si128(reinterpret_cast<__m128i *>(out), a);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(out + 16), b);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(out + 32), c);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(out + 48), d);
+        }
+        std::memcpy(out, in, size);
+        _mm_sfence();
+    }
+
+
+    //=========================================================================
+    __attribute__((target("sse2")))
+    void stream_fill_sse2
+    (
+        void * destination,
+        std::uint8_t value,
+        std::size_t size
+    )
+    {
+        auto * out = static_cast<std::uint8_t *>(destination);
+        auto head = unaligned_head(out, size);
+        std::memset(out, value, head);
+        out += head;
+        size -= head;
+        auto v = _mm_set1_epi8(static_cast<char>(value));
+        for (; size >= cache_line_size; size -= cache_line_size, out += cache_line_size)
+        {
+            _mm_stream_si128(reinterpret_cast<__m128i *>(out), v);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(out + 16), v);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(out + 32), v);
+            _mm_stream_si128(reinterpret_cast<__m128i *>(out + 48), v);
+        }
+        std::memset(out, value, size);
+        _mm_sfence();
+    }
+
+
+    //=========================================================================
+    __attribute__((target("sse2")))
+    void copy_cache_lines_sse2
+    (
+        void * destination,
+        void const * source,
+        std::size_t lineCount
+    )
+    {
+        auto * out = static_cast<__m128i *>(destination);
+        auto const * in = static_cast<__m128i const *>(source);
+        for (std::size_t i = 0; i < lineCount; ++i, out += 4, in += 4)
+        {
+            auto a = _mm_load_si128(in);
+            auto b = _mm_load_si128(in + 1);
+            auto c = _mm_load_si128(in + 2);
+            auto d = _mm_load_si128(in + 3);
+            _mm_store_si128(out, a);
+            _mm_store_si128(out + 1, b);
+            _mm_store_si128(out + 2, c);
+            _mm_store_si128(out + 3, d);
+        }
+    }
+
+
+    //=========================================================================
+    __attribute__((target("avx2")))
+    void stream_copy_avx2
+    (
+        void * destination,
+        void const * source,
+        std::size_t size
+    )
+    {
+        auto * out = static_cast<std::uint8_t *>(destination);
+        auto const * in = static_cast<std::uint8_t const *>(source);
+        auto head = unaligned_head(out, size);
+        std::memcpy(out, in, head);
+        out += head;
+        in += head;
+        size -= head;
+        for (; size >= (2 * cache_line_size); size -= (2 * cache_line_size), out += (2 * cache_line_size), in += (2 * cache_line_size))
+        {
+            auto a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in));
+            auto b = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + 32));
+            auto c = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + 64));
+            auto d = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + 96));
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(out), a);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(out + 32), b);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(out + 64), c);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(out + 96), d);
+        }
+        for (; size >= cache_line_size; size -= cache_line_size, out += cache_line_size, in += cache_line_size)
+        {
+            auto a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in));
+            auto b = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + 32));
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(out), a);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(out + 32), b);
+        }
+        std::memcpy(out, in, size);
+        _mm_sfence();
+    }
+
+
+    //=========================================================================
+    __attribute__((target("avx2")))
+    void stream_fill_avx2
+    (
+        void * destination,
+        std::uint8_t value,
+        std::size_t size
+    )
+    {
+        auto * out = static_cast<std::uint8_t *>(destination);
+        auto head = unaligned_head(out, size);
+        std::memset(out, value, head);
+        out += head;
+        size -= head;
+        auto v = _mm256_set1_epi8(static_cast<char>(value));
+        for (; size >= cache_line_size; size -= cache_line_size, out += cache_line_size)
+        {
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(out), v);
+            _mm256_stream_si256(reinterpret_cast<__m256i *>(out + 32), v);
+        }
+        std::memset(out, value, size);
+        _mm_sfence();
+    }
+
+
+    //=========================================================================
+    __attribute__((target("avx2")))
+    void copy_cache_lines_avx2
+    (
+        void * destination,
+        void const * source,
+        std::size_t lineCount
+    )
+    {
+        auto * out = static_cast<__m256i *>(destination);
+        auto const * in = static_cast<__m256i const *>(source);
+        for (std::size_t i = 0; i < lineCount; ++i, out += 2, in += 2)
+        {
+            auto a = _mm256_load_si256(in);
+            auto b = _mm256_load_si256(in + 1);
+            _mm256_store_si256(out, a);
+            _mm256_store_si256(out + 1, b);
+        }
+    }
+
+
+    //=========================================================================
+    __attribute__((target("avx512f")))
+    void stream_copy_avx512
+    (
+        void * destination,
+        void const * source,
+        std::size_t size
+    )
+    {
+        auto * out = static_cast<std::uint8_t *>(destination);
+        auto const * in = static_cast<std::uint8_t const *>(source);
+        auto head = unaligned_head(out, size);
+        std::memcpy(out, in, head);
+        out += head;
+        in += head;
+        size -= head;
+        for (; size >= (4 * cache_line_size); size -= (4 * cache_line_size), out += (4 * cache_line_size), in += (4 * cache_line_size))
+        {
+            auto a = _mm512_loadu_si512(in);
+            auto b = _mm512_loadu_si512(in + 64);
+            auto c = _mm512_loadu_si512(in + 128);
+            auto d = _mm512_loadu_si512(in + 192);
+            _mm512_stream_si512(reinterpret_cast<__m512i *>(out), a);
+            _mm512_stream_si512(reinterpret_cast<__m512i *>(out + 64), b);
+            _mm512_stream_si512(reinterpret_cast<__m512i *>(out + 128), c);
+            _mm512_stream_si512(reinterpret_cast<__m512i *>(out + 192), d);
+        }
+        for (; size >= cache_line_size; size -= cache_line_size, out += cache_line_size, in += cache_line_size)
+            _mm512_stream_si512(reinterpret_cast<__m512i *>(out), _mm512_loadu_si512(in));
+        std::memcpy(out, in, size);
+        _mm_sfence();
+    }
+
+
+    //=========================================================================
+    __attribute__((target("avx512f")))
+    void stream_fill_avx512
+    (
+        void * destination,
+        std::uint8_t value,
+        std::size_t size
+    )
+    {
+        auto * out = static_cast<std::uint8_t *>(destination);
+        auto head = unaligned_head(out, size);
+        std::memset(out, value, head);
+        out += head;
+        size -= head;
+        auto v = _mm512_set1_epi8(static_cast<char>(value));
+        for (; size >= cache_line_size; size -= cache_line_size, out += cache_line_size)
+            _mm512_stream_si512(reinterpret_cast<__m512i *>(out), v);
+        std::memset(out, value, size);
+        _mm_sfence();
+    }
+
+
+    //=========================================================================
+    __attribute__((target("avx512f")))
+    void copy_cache_lines_avx512
+    (
+        void * destination,
+        void const * source,
+        std::size_t lineCount
+    )
+    {
+        auto * out = static_cast<__m512i *>(destination);
+        auto const * in = static_cast<__m512i const *>(source);
+        for (std::size_t i = 0; i < lineCount; ++i)
+            _mm512_store_si512(out + i, _mm512_load_si512(in + i));
+    }
+
+
+    copy_kernels const sse2_kernels{simd_level::sse2, stream_copy_sse2, stream_fill_sse2, copy_cache_lines_sse2};
+    copy_kernels const avx2_kernels{simd_level::avx2, stream_copy_avx2, stream_fill_avx2, copy_cache_lines_avx2};
+    copy_kernels const avx512_kernels{simd_level::avx512, stream_copy_avx512, stream_fill_avx512, copy_cache_lines_avx512};
+
+#else
+
+    //=========================================================================
+    void copy_portable
+    (
+        void * destination,
+        void const * source,
+        std::size_t size
+    )
+    {
+        std::memcpy(destination, source, size);
+    }
+
+
+    //=========================================================================
+    void fill_portable
+    (
+        void * destination,
+        std::uint8_t value,
+        std::size_t size
+    )
+    {
+        std::memset(destination, value, size);
+    }
+
+
+    //=========================================================================
+    void copy_cache_lines_portable
+    (
+        void * destination,
+        void const * source,
+        std::size_t lineCount
+    )
+    {
+        std::memcpy(destination, source, lineCount * cache_line_size);
+    }
+
+
+    // no non-temporal stores without the x86 intrinsics.  the only level
+    // (reported as sse2) is memcpy and memset
+    copy_kernels const sse2_kernels{simd_level::sse2, copy_portable, fill_portable, copy_cache_lines_portable};
+
+#endif
+
+    static_assert(cache_line_size == 64, "copy kernels assume 64 byte cache lines");
+
+} // namespace
+
+
+//=============================================================================
+std::string_view bcpp::system::to_string
+(
+    simd_level simdLevel
+)
+{
+    switch (simdLevel)
+    {
+        case simd_level::sse2: return "sse2";
+        case simd_level::avx2: return "avx2";
+        case simd_level::avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+
+//=============================================================================
+auto bcpp::system::get_simd_level
+(
+    // __builtin_cpu_supports also checks that the os saves the wider registers
+) -> simd_level
+{
+    #if defined(__x86_64__) || defined(__i386__)
+        static auto const simdLevel = []()
+                {
+                    __builtin_cpu_init();
+                    if (__builtin_cpu_supports("avx512f"))
+                        return simd_level::avx512;
+                    if (__builtin_cpu_supports("avx2"))
+                        return simd_level::avx2;
+                    return simd_level::sse2;
+                }();
+        return simdLevel;
+    #else
+        return simd_level::sse2;
+    #endif
+}
+
+
+//=============================================================================
+auto bcpp::system::get_copy_kernels
+(
+    simd_level simdLevel
+) -> copy_kernels const &
+{
+    switch (std::min(simdLevel, get_simd_level()))
+    {
+        #if defined(__x86_64__) || defined(__i386__)
+            case simd_level::avx512: return avx512_kernels;
+            case simd_level::avx2: return avx2_kernels;
+        #endif
+        default: return sse2_kernels;
+    }
+}
+
+
+//=============================================================================
+auto bcpp::system::get_copy_kernels
+(
+) -> copy_kernels const &
+{
+    static auto const & kernels = get_copy_kernels(get_simd_level());
+    return kernels;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::non_temporal_threshold
+(
+)
+{
+    if (auto threshold = nonTemporalThreshold.load(std::memory_order_relaxed); threshold != 0)
+        return threshold;
+    // a copy larger than half of the last level cache evicts more than it is worth keeping
+    auto const & topology = cpu_topology::get();
+    auto cacheSize = topology.cache_size(3);
+    if (cacheSize == 0)
+        cacheSize = topology.cache_size(2);
+    auto threshold = (cacheSize != 0) ? (cacheSize / 2) : default_non_temporal_threshold;
+    nonTemporalThreshold.store(threshold, std::memory_order_relaxed);
+    return threshold;
+}
+
+
+//=============================================================================
+void bcpp::system::set_non_temporal_threshold
+(
+    std::size_t threshold
+)
+{
+    nonTemporalThreshold.store(std::max<std::size_t>(threshold, 1), std::memory_order_relaxed);
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <library/system/cache_line.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // copy and fill kernels for mapped memory
+    //
+    // stream_copy() and stream_fill() write with non-temporal stores which
+    // bypass the cache.  for transfers larger than the last level cache this
+    // avoids evicting the producer's working set to make room for data that
+    // only the consumer will read (and saves the read for ownership of each
+    // destination line).  a trailing sfence orders the streamed stores ahead
+    // of any subsequent store (ie: the release of a sequence number).
+    //
+    // copy_cache_lines() copies whole cache lines with full width loads and
+    // stores and suits small hot messages in buffers padded to cache lines.
+    //
+    // copy() uses memcpy below non_temporal_threshold() and stream_copy()
+    // above it.
+    //
+    // the kernels are selected at runtime for the widest instruction set the
+    // cpu supports (avx512, avx2 or sse2).  get_copy_kernels() returns the
+    // kernels of a specific level (ie: to benchmark one against another).
+    // other than on x86 there is only sse2 and it is plain memcpy/memset.
+    //=========================================================================
+
+    enum class simd_level
+    {
+        sse2,
+        avx2,
+        avx512
+    };
+
+    std::string_view to_string
+    (
+        simd_level
+    );
+
+    struct copy_kernels
+    {
+        using copy_function = void(*)(void *, void const *, std::size_t);
+        using fill_function = void(*)(void *, std::uint8_t, std::size_t);
+
+        simd_level      simdLevel_;
+        copy_function   streamCopy_;
+        fill_function   streamFill_;
+        copy_function   copyCacheLines_;    // size is in cache lines
+    };
+
+    // the widest level supported by this cpu
+    simd_level get_simd_level();
+
+    // the kernels of the level (or of the widest supported level below it)
+    copy_kernels const & get_copy_kernels
+    (
+        simd_level
+    );
+
+    copy_kernels const & get_copy_kernels();
+
+    // copies of at least this many bytes are streamed by copy().  defaults to
+    // half of the last level cache
+    std::size_t non_temporal_threshold();
+
+    void set_non_temporal_threshold
+    (
+        std::size_t
+    );
+
+    void stream_copy
+    (
+        void *,
+        void const *,
+        std::size_t
+    );
+
+    void stream_fill
+    (
+        void *,
+        std::uint8_t,
+        std::size_t
+    );
+
+    void copy_cache_lines
+    (
+        void *,
+        void const *,
+        std::size_t
+    );
+
+    void * copy
+    (
+        void *,
+        void const *,
+        std::size_t
+    );
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+inline void bcpp::system::stream_copy
+(
+    void * destination,
+    void const * source,
+    std::size_t size
+)
+{
+    get_copy_kernels().streamCopy_(destination, source, size);
+}
+
+
+//=============================================================================
+inline void bcpp::system::stream_fill
+(
+    void * destination,
+    std::uint8_t value,
+    std::size_t size
+)
+{
+    get_copy_kernels().streamFill_(destination, value, size);
+}
+
+
+//=============================================================================
+inline void bcpp::system::copy_cache_lines
+(
+    // destination and source are cache line aligned and lineCount lines long
+    void * destination,
+    void const * source,
+    std::size_t lineCount
+)
+{
+    get_copy_kernels().copyCacheLines_(destination, source, lineCount);
+}
+
+
+//=============================================================================
+inline void * bcpp::system::copy
+(
+    void * destination,
+    void const * source,
+    std::size_t size
+)
+{
+    if (size < non_temporal_threshold())
+        return std::memcpy(destination, source, size);
+    stream_copy(destination, source, size);
+    return destination;
+}
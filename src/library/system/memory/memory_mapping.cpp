@@ -1,4 +1,5 @@
 #include "./memory_mapping.h"
+#include "./mapping_registry.h"
 
 #include <include/file_descriptor.h>
 #include <include/bit.h>
@@ -38,6 +39,14 @@ bcpp::system::memory_mapping::memory_mapping
             if (alignment != 0)
                 alignedAddress = reinterpret_cast<std::byte *>((reinterpret_cast<std::size_t>(unalignedAddress) + alignment - 1) & ~(alignment - 1));
             alignedAllocation_ = {alignedAddress, config.size_};
+            if (!mapping_registry::instance().add(alignedAddress, config.size_, config.tag_, ((config.mmapFlags_ & MAP_SHARED) != 0)))
+            {
+                // refused by an enforced budget
+                ::munmap(unalignedAllocation_.data(), unalignedAllocation_.size());
+                unalignedAllocation_ = {};
+                alignedAllocation_ = {};
+                budgetRefused_ = true;
+            }
         }
     }
 }
@@ -50,11 +59,13 @@ bcpp::system::memory_mapping::memory_mapping
 ):
     closeHandler_(other.closeHandler_),
     alignedAllocation_(other.alignedAllocation_),
-    unalignedAllocation_(other.unalignedAllocation_)
+    unalignedAllocation_(other.unalignedAllocation_),
+    budgetRefused_(other.budgetRefused_)
 {
     other.closeHandler_ = nullptr;
     other.alignedAllocation_ = {};
     other.unalignedAllocation_ = {};
+    other.budgetRefused_ = false;
 }
 
 
@@ -70,9 +81,11 @@ auto bcpp::system::memory_mapping::operator =
         closeHandler_ = other.closeHandler_;
         alignedAllocation_ = other.alignedAllocation_;
         unalignedAllocation_ = other.unalignedAllocation_;
+        budgetRefused_ = other.budgetRefused_;
         other.closeHandler_ = nullptr;
         other.alignedAllocation_ = {};
         other.unalignedAllocation_ = {};
+        other.budgetRefused_ = false;
     }
     return *this;
 }
@@ -94,6 +107,8 @@ void bcpp::system::memory_mapping::close
 {
     if (auto closeHandler = std::exchange(closeHandler_, nullptr); closeHandler)
         closeHandler(*this);
+    if (alignedAllocation_.data() != nullptr)
+        mapping_registry::instance().remove(alignedAllocation_.data());
     if (unalignedAllocation_.data() != nullptr)
         ::munmap(unalignedAllocation_.data(), unalignedAllocation_.size());
     unalignedAllocation_ = {};
@@ -137,6 +152,50 @@ bool bcpp::system::memory_mapping::is_valid
 }
 
 
+//=============================================================================
+bool bcpp::system::memory_mapping::is_budget_refused
+(
+) const
+{
+    return budgetRefused_;
+}
+
+
+//=============================================================================
+std::string bcpp::system::memory_mapping::tag
+(
+) const
+{
+    return mapping_registry::instance().tag_of(alignedAllocation_.data());
+}
+
+
+//=============================================================================
+void bcpp::system::memory_mapping::set_idle
+(
+    bool idle
+)
+{
+    mapping_registry::instance().set_idle(alignedAllocation_.data(), idle);
+}
+
+
+//=============================================================================
+bool bcpp::system::memory_mapping::release
+(
+    // return the mapping's pages to the kernel.  MADV_FREE falls back to
+    // MADV_DONTNEED for mappings which do not support it (ie: shared)
+    release_advice advice
+)
+{
+    if (!is_valid())
+        return false;
+    if ((advice == release_advice::free) && (::madvise(alignedAllocation_.data(), alignedAllocation_.size(), MADV_FREE) == 0))
+        return true;
+    return (::madvise(alignedAllocation_.data(), alignedAllocation_.size(), MADV_DONTNEED) == 0);
+}
+
+
 //=============================================================================
 std::byte * bcpp::system::memory_mapping::begin
 (
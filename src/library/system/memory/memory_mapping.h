@@ -17,6 +17,13 @@
 namespace bcpp::system
 {
 
+    enum class release_advice
+    {
+        dont_need,  // MADV_DONTNEED: pages are freed now and read back as zero (or file content)
+        free        // MADV_FREE: pages are freed lazily under memory pressure (private anonymous only)
+    };
+
+
     class memory_mapping :
         virtual non_copyable
     {
@@ -30,6 +37,7 @@ namespace bcpp::system
             io_mode         ioMode_{PROT_READ | PROT_WRITE};
             std::size_t     mmapFlags_;
             std::size_t     alignment_{1024};
+            std::string     tag_{};         // accounting tag (see mapping_registry)
         };
 
         struct event_handlers
@@ -68,6 +76,23 @@ namespace bcpp::system
 
         bool is_valid() const;
 
+        // true if the mapping was refused by an enforced budget (see
+        // mapping_registry) rather than failed
+        bool is_budget_refused() const;
+
+        std::string tag() const;
+
+        // idle mappings are released by mapping_registry::release_idle()
+        void set_idle
+        (
+            bool
+        );
+
+        bool release
+        (
+            release_advice = release_advice::free
+        );
+
         std::byte * begin();
         std::byte const * begin() const;
         std::byte * end();
@@ -81,6 +106,8 @@ namespace bcpp::system
 
         std::span<std::byte>    unalignedAllocation_;
 
+        bool                    budgetRefused_{false};
+
     }; // class memory_mapping
 
 } // namespace bcpp::system
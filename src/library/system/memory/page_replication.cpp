@@ -0,0 +1,241 @@
+#include "./page_replication.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    static std::uint32_t constexpr replication_magic = 0x70657272;     // "rrep"
+
+    enum frame_type : std::uint32_t
+    {
+        hello_frame,        // offset_ is the page size, size_ the size of the region
+        pages_frame,        // size_ bytes at offset_ follow
+        commit_frame        // the end of cycle sequence_
+    };
+
+    struct frame_header
+    {
+        std::uint32_t   magic_;
+        std::uint32_t   type_;
+        std::uint64_t   sequence_;
+        std::uint64_t   offset_;
+        std::uint64_t   size_;
+    };
+
+
+    //=========================================================================
+    bool write_all
+    (
+        std::int32_t fileDescriptor,
+        iovec * vectors,
+        std::int32_t count
+    )
+    {
+        while (count > 0)
+        {
+            auto written = ::writev(fileDescriptor, vectors, count);
+            if ((written < 0) && (errno == EINTR))
+                continue;
+            if (written <= 0)
+                return false;
+            // skip what was written
+            auto remaining = static_cast<std::size_t>(written);
+            while ((count > 0) && (remaining >= vectors->iov_len))
+            {
+                remaining -= vectors->iov_len;
+                ++vectors;
+                --count;
+            }
+            if (count > 0)
+            {
+                vectors->iov_base = static_cast<std::byte *>(vectors->iov_base) + remaining;
+                vectors->iov_len -= remaining;
+            }
+        }
+        return true;
+    }
+
+
+    //=========================================================================
+    bool read_all
+    (
+        std::int32_t fileDescriptor,
+        void * data,
+        std::size_t size
+    )
+    {
+        auto * bytes = static_cast<std::byte *>(data);
+        while (size > 0)
+        {
+            auto result = ::read(fileDescriptor, bytes, size);
+            if ((result < 0) && (errno == EINTR))
+                continue;
+            if (result <= 0)
+                return false;
+            bytes += result;
+            size -= result;
+        }
+        return true;
+    }
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::replication_sender::replication_sender
+(
+    std::span<std::byte const> region,
+    dirty_page_tracker & dirtyPageTracker,
+    file_descriptor const & fileDescriptor
+):
+    region_(region),
+    dirtyPageTracker_(dirtyPageTracker),
+    fileDescriptor_(fileDescriptor.get())
+{
+}
+
+
+//=============================================================================
+bool bcpp::system::replication_sender::send_frame
+(
+    std::uint32_t type,
+    std::size_t offset,
+    std::size_t size
+)
+{
+    frame_header header{.magic_ = replication_magic, .type_ = type, .sequence_ = sequence_, .offset_ = offset, .size_ = size};
+    iovec vectors[2]{{&header, sizeof(header)}, {const_cast<std::byte *>(region_.data() + offset), size}};
+    return write_all(fileDescriptor_, vectors, (type == pages_frame) ? 2 : 1);
+}
+
+
+//=============================================================================
+auto bcpp::system::replication_sender::replicate
+(
+) -> std::optional<std::size_t>
+{
+    if (!dirtyPageTracker_.is_valid())
+        return std::nullopt;
+    auto pageSize = dirtyPageTracker_.page_size();
+    if (statistics_.cycles_ == 0)
+    {
+        // the standby starts from nothing so the first cycle ships everything
+        dirtyPageTracker_.mark_all_dirty();
+        frame_header header{.magic_ = replication_magic, .type_ = hello_frame, .sequence_ = 0, .offset_ = pageSize, .size_ = region_.size()};
+        iovec vector{&header, sizeof(header)};
+        if (!write_all(fileDescriptor_, &vector, 1))
+            return std::nullopt;
+    }
+
+    ++sequence_;
+    std::size_t pages = 0;
+    for (auto const & pageRange : dirtyPageTracker_.collect())
+    {
+        auto offset = (pageRange.firstPage_ * pageSize);
+        auto size = std::min(pageRange.pageCount_ * pageSize, region_.size() - offset);
+        if (!send_frame(pages_frame, offset, size))
+            return std::nullopt;
+        pages += pageRange.pageCount_;
+        statistics_.bytesSent_ += size;
+    }
+    if (!send_frame(commit_frame, 0, 0))
+        return std::nullopt;
+    ++statistics_.cycles_;
+    statistics_.pagesSent_ += pages;
+    return pages;
+}
+
+
+//=============================================================================
+std::uint64_t bcpp::system::replication_sender::sequence
+(
+) const
+{
+    return sequence_;
+}
+
+
+//=============================================================================
+auto bcpp::system::replication_sender::get_statistics
+(
+) const -> statistics const &
+{
+    return statistics_;
+}
+
+
+//=============================================================================
+bcpp::system::replication_receiver::replication_receiver
+(
+    std::span<std::byte> region,
+    file_descriptor const & fileDescriptor
+):
+    region_(region),
+    fileDescriptor_(fileDescriptor.get()),
+    pageSize_(static_cast<std::size_t>(::getpagesize()))
+{
+}
+
+
+//=============================================================================
+auto bcpp::system::replication_receiver::receive
+(
+) -> std::optional<std::uint64_t>
+{
+    while (true)
+    {
+        frame_header header;
+        if ((!read_all(fileDescriptor_, &header, sizeof(header))) || (header.magic_ != replication_magic))
+            return std::nullopt;
+        switch (header.type_)
+        {
+            case hello_frame:
+            {
+                if ((header.size_ != region_.size()) || (header.offset_ != pageSize_))
+                    return std::nullopt;
+                break;
+            }
+            case pages_frame:
+            {
+                if ((header.offset_ > region_.size()) || (header.size_ > (region_.size() - header.offset_)))
+                    return std::nullopt;
+                if (!read_all(fileDescriptor_, region_.data() + header.offset_, header.size_))
+                    return std::nullopt;
+                statistics_.pagesReceived_ += ((header.size_ + pageSize_ - 1) / pageSize_);
+                statistics_.bytesReceived_ += header.size_;
+                break;
+            }
+            case commit_frame:
+            {
+                ++statistics_.cycles_;
+                return (sequence_ = header.sequence_);
+            }
+            default:
+                return std::nullopt;
+        }
+    }
+}
+
+
+//=============================================================================
+std::uint64_t bcpp::system::replication_receiver::sequence
+(
+) const
+{
+    return sequence_;
+}
+
+
+//=============================================================================
+auto bcpp::system::replication_receiver::get_statistics
+(
+) const -> statistics const &
+{
+    return statistics_;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "./dirty_page_tracker.h"
+
+#include <include/file_descriptor.h>
+#include <include/non_copyable.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // replication_sender
+    //
+    // keeps a standby copy of a region (ie: a primary's shared_memory)
+    // current by shipping only the pages which a dirty_page_tracker reports
+    // as written.  each replicate() collects the dirty pages, writes each run
+    // of them as one frame (header and pages in a single writev straight
+    // from the region) and ends the cycle with a commit frame.  the first
+    // cycle ships the whole region.  the cost of a cycle follows the pages
+    // written since the previous one, not the size of the region.
+    //
+    // the channel is a blocking stream (ie: one end of a socketpair, a unix
+    // domain socket or a pipe) to a replication_receiver.  pages are read as
+    // they are sent so a page written during replicate() may be shipped with
+    // part of the write.  with bitmap tracking (writers mark after writing)
+    // that write re-dirties the page so it is shipped again, whole, by the
+    // next cycle.  with soft_dirty tracking a write which lands while the
+    // marks are collected is missed (see dirty_page_tracker) so writers must
+    // be paused across replicate() for the standby to be an exact copy.
+    //=========================================================================
+    class replication_sender :
+        non_copyable
+    {
+    public:
+
+        struct statistics
+        {
+            std::uint64_t   cycles_{0};
+            std::uint64_t   pagesSent_{0};
+            std::uint64_t   bytesSent_{0};
+        };
+
+        replication_sender
+        (
+            std::span<std::byte const>,
+            dirty_page_tracker &,
+            file_descriptor const &
+        );
+
+        // ships the pages written since the previous call.  returns the
+        // number of pages shipped or empty if the channel failed
+        std::optional<std::size_t> replicate();
+
+        std::uint64_t sequence() const;
+
+        statistics const & get_statistics() const;
+
+    private:
+
+        bool send_frame
+        (
+            std::uint32_t,
+            std::size_t,
+            std::size_t
+        );
+
+        std::span<std::byte const>      region_;
+
+        dirty_page_tracker &            dirtyPageTracker_;
+
+        std::int32_t                    fileDescriptor_{0};
+
+        std::uint64_t                   sequence_{0};
+
+        statistics                      statistics_;
+
+    }; // class replication_sender
+
+
+    //=========================================================================
+    // replication_receiver
+    //
+    // the standby end of a replication_sender.  receive() reads the frames of
+    // one cycle straight into the standby region (ie: the standby's own
+    // shared_memory) and returns the sequence of the cycle once its commit
+    // frame arrives.  the region must be the same size as the primary's.
+    // pages of a cycle are applied as they arrive so at failover the standby
+    // uses the region as of the last commit plus any part of the next cycle.
+    //=========================================================================
+    class replication_receiver :
+        non_copyable
+    {
+    public:
+
+        struct statistics
+        {
+            std::uint64_t   cycles_{0};
+            std::uint64_t   pagesReceived_{0};
+            std::uint64_t   bytesReceived_{0};
+        };
+
+        replication_receiver
+        (
+            std::span<std::byte>,
+            file_descriptor const &
+        );
+
+        // blocks until a whole cycle is applied and returns its sequence.
+        // empty if the channel closed or failed or the sender's region does
+        // not match
+        std::optional<std::uint64_t> receive();
+
+        // the sequence of the last cycle applied
+        std::uint64_t sequence() const;
+
+        statistics const & get_statistics() const;
+
+    private:
+
+        std::span<std::byte>            region_;
+
+        std::int32_t                    fileDescriptor_{0};
+
+        std::size_t                     pageSize_;
+
+        std::uint64_t                   sequence_{0};
+
+        statistics                      statistics_;
+
+    }; // class replication_receiver
+
+} // namespace bcpp::system
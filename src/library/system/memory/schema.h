@@ -0,0 +1,253 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // schema
+    //
+    // compile time description of the memory layout of a type.  the hash
+    // is of a canonical description only (never of compiler specific names)
+    // so that builds by different compilers agree: the kind of the type (ie:
+    // unsigned integer, floating point, enumeration, array, class), its size
+    // and alignment, its schema_version (if it declares a static
+    // schema_version) and, if schema_traits is specialized for the type, the
+    // explicit name and the name, offset, size and type of every listed field
+    // (recursively).  two builds which disagree on any of these produce
+    // different hashes.  a class must specialize schema_traits - either with
+    // its fields or, to be described by its size, alignment and version
+    // alone, with opaque = true (in which case a reordered or retyped member
+    // goes undetected unless schema_version is bumped).  a class with
+    // neither does not compile.
+    //
+    //      struct order
+    //      {
+    //          static std::uint32_t constexpr schema_version = 2;
+    //          std::int64_t    price_;
+    //          std::uint32_t   quantity_;
+    //      };
+    //
+    //      template <>
+    //      struct bcpp::system::schema_traits<order>
+    //      {
+    //          static constexpr std::string_view name = "order";
+    //          static constexpr auto fields = std::to_array(
+    //                  {
+    //                      BCPP_SCHEMA_FIELD(order, price_),
+    //                      BCPP_SCHEMA_FIELD(order, quantity_)
+    //                  });
+    //      };
+    //=========================================================================
+
+    struct schema_field
+    {
+        std::string_view    name_;
+        std::size_t         offset_;
+        std::size_t         size_;
+        std::uint64_t       typeHash_;
+    };
+
+    template <typename T>
+    struct schema_traits
+    {
+    };
+
+    // for diagnostics only.  the explicit schema_traits name if there is
+    // one, otherwise the (compiler specific) name of the type
+    template <typename T>
+    constexpr std::string_view schema_name();
+
+    template <typename T>
+    constexpr std::string_view type_name();
+
+    template <typename T>
+    constexpr std::uint64_t schema_hash();
+
+    template <typename T>
+    constexpr std::uint32_t schema_version();
+
+    namespace detail
+    {
+
+        //=====================================================================
+        constexpr std::uint64_t fnv1a
+        (
+            std::string_view value,
+            std::uint64_t hash = 0xcbf29ce484222325ull
+        )
+        {
+            for (auto c : value)
+                hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x100000001b3ull;
+            return hash;
+        }
+
+
+        //=====================================================================
+        constexpr std::uint64_t fnv1a
+        (
+            std::uint64_t value,
+            std::uint64_t hash
+        )
+        {
+            for (auto i = 0; i < 8; ++i, value >>= 8)
+                hash = (hash ^ (value & 0xff)) * 0x100000001b3ull;
+            return hash;
+        }
+
+        template <typename T>
+        concept has_schema_version = requires {{T::schema_version} -> std::convertible_to<std::uint32_t>;};
+
+        template <typename T>
+        concept has_schema_fields = requires {schema_traits<T>::fields;};
+
+        template <typename T>
+        concept has_schema_name = requires {{schema_traits<T>::name} -> std::convertible_to<std::string_view>;};
+
+        template <typename T>
+        concept is_schema_opaque = requires {requires (schema_traits<T>::opaque == true);};
+
+        // revised whenever the canonical description below changes
+        std::uint64_t constexpr schema_description_version = 2;
+
+        enum class schema_kind : std::uint64_t
+        {
+            boolean = 1,
+            character,
+            signed_integer,
+            unsigned_integer,
+            floating_point,
+            enumeration,
+            array,
+            class_type,
+            other
+        };
+
+
+        //=====================================================================
+        template <typename T>
+        constexpr schema_kind kind_of
+        (
+        )
+        {
+            if constexpr (std::is_same_v<T, bool>)
+                return schema_kind::boolean;
+            else if constexpr ((std::is_same_v<T, char>) || (std::is_same_v<T, char8_t>) || (std::is_same_v<T, char16_t>) ||
+                    (std::is_same_v<T, char32_t>) || (std::is_same_v<T, wchar_t>))
+                return schema_kind::character;     // whose signedness is up to the platform
+            else if constexpr (std::is_integral_v<T>)
+                return (std::is_signed_v<T> ? schema_kind::signed_integer : schema_kind::unsigned_integer);
+            else if constexpr (std::is_floating_point_v<T>)
+                return schema_kind::floating_point;
+            else if constexpr (std::is_enum_v<T>)
+                return schema_kind::enumeration;
+            else if constexpr (std::is_array_v<T>)
+                return schema_kind::array;
+            else if constexpr (std::is_class_v<T>)
+                return schema_kind::class_type;
+            else
+                return schema_kind::other;
+        }
+
+    } // namespace detail
+
+} // namespace bcpp::system
+
+
+#define BCPP_SCHEMA_FIELD(type, field) \
+        ::bcpp::system::schema_field{#field, offsetof(type, field), sizeof(type::field), \
+                ::bcpp::system::schema_hash<std::remove_cvref_t<decltype(std::declval<type>().field)>>()}
+
+
+//=============================================================================
+template <typename T>
+constexpr std::string_view bcpp::system::schema_name
+(
+)
+{
+    if constexpr (detail::has_schema_name<std::remove_cv_t<T>>)
+        return std::string_view(schema_traits<std::remove_cv_t<T>>::name);
+    else
+        return type_name<T>();
+}
+
+
+//=============================================================================
+template <typename T>
+constexpr std::string_view bcpp::system::type_name
+(
+    // the (compiler specific) name of T.  ie: "bcpp::system::thread_stats".
+    // for display only - it is not part of the schema hash
+)
+{
+    std::string_view name = __PRETTY_FUNCTION__;
+    auto begin = name.find("T = ");
+    if (begin == std::string_view::npos)
+        return name;
+    begin += 4;
+    auto end = name.find_first_of(";]", begin);
+    return name.substr(begin, end - begin);
+}
+
+
+//=============================================================================
+template <typename T>
+constexpr std::uint32_t bcpp::system::schema_version
+(
+)
+{
+    if constexpr (detail::has_schema_version<T>)
+        return static_cast<std::uint32_t>(T::schema_version);
+    else
+        return 0;
+}
+
+
+//=============================================================================
+template <typename T>
+constexpr std::uint64_t bcpp::system::schema_hash
+(
+)
+{
+    using value_type = std::remove_cv_t<T>;
+    auto hash = detail::fnv1a(detail::schema_description_version, 0xcbf29ce484222325ull);
+    hash = detail::fnv1a(static_cast<std::uint64_t>(detail::kind_of<value_type>()), hash);
+    hash = detail::fnv1a(sizeof(value_type), hash);
+    hash = detail::fnv1a(alignof(value_type), hash);
+    if constexpr (std::is_array_v<value_type>)
+    {
+        hash = detail::fnv1a(std::extent_v<value_type>, hash);
+        hash = detail::fnv1a(schema_hash<std::remove_extent_t<value_type>>(), hash);
+    }
+    else if constexpr (std::is_enum_v<value_type>)
+    {
+        hash = detail::fnv1a(schema_hash<std::underlying_type_t<value_type>>(), hash);
+    }
+    else
+    {
+        static_assert((!std::is_class_v<value_type>) || (detail::has_schema_fields<value_type>) || (detail::is_schema_opaque<value_type>),
+                "specialize schema_traits with the fields of the class (or with opaque = true)");
+        hash = detail::fnv1a(schema_version<value_type>(), hash);
+        if constexpr (detail::has_schema_name<value_type>)
+            hash = detail::fnv1a(std::string_view(schema_traits<value_type>::name), hash);
+        if constexpr (detail::has_schema_fields<value_type>)
+        {
+            for (auto const & field : schema_traits<value_type>::fields)
+            {
+                hash = detail::fnv1a(field.name_, hash);
+                hash = detail::fnv1a(field.offset_, hash);
+                hash = detail::fnv1a(field.size_, hash);
+                hash = detail::fnv1a(field.typeHash_, hash);
+            }
+        }
+    }
+    return hash;
+}
@@ -0,0 +1,469 @@
+#include "./segment_registry.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    using entry = bcpp::system::segment_registry::entry;
+    using entry_state = entry::entry_state;
+
+
+    //=========================================================================
+    std::int64_t now
+    (
+    )
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+
+    //=========================================================================
+    std::uint64_t process_start_time
+    (
+        // start time of the process in clock ticks since boot (proc(5) field 22).
+        // zero if the process does not exist
+        std::int32_t processId
+    )
+    {
+        std::ifstream statFile("/proc/" + std::to_string(processId) + "/stat");
+        std::string line;
+        if (!std::getline(statFile, line))
+            return 0;
+        // the command name may contain spaces so parse from the closing parenthesis
+        auto pos = line.rfind(')');
+        if (pos == std::string::npos)
+            return 0;
+        std::istringstream stream(line.substr(pos + 2));
+        std::string field;
+        for (auto i = 3; (i <= 22) && (stream >> field); ++i)
+            if (i == 22)
+                return std::stoull(field);
+        return 0;
+    }
+
+
+    //=========================================================================
+    bool is_alive
+    (
+        std::int32_t processId,
+        std::uint64_t startTime
+    )
+    {
+        if ((::kill(processId, 0) != 0) && (errno == ESRCH))
+            return false;
+        // the process id may have been reused by another process
+        auto currentStartTime = process_start_time(processId);
+        return ((startTime == 0) || (currentStartTime == 0) || (currentStartTime == startTime));
+    }
+
+
+    //=========================================================================
+    std::atomic_ref<entry_state> state_of
+    (
+        entry const & e
+    )
+    {
+        return std::atomic_ref(const_cast<entry_state &>(e.state_));
+    }
+
+} // namespace
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::open
+(
+) -> segment_registry
+{
+    return open(configuration{});
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::open
+(
+    // the first process to open the registry creates it.  a process which
+    // loses the race to create joins once the creator has initialized it
+    configuration const & config
+) -> segment_registry
+{
+    static auto constexpr join_attempts = 100;
+    static auto constexpr join_retry_interval = std::chrono::milliseconds(1);
+
+    segment_registry registry;
+    registry.entries_ = typed_shared_memory<entry>::create(
+            {
+                .path_ = config.path_,
+                .count_ = config.capacity_,
+                .unlinkPolicy_ = shared_memory::unlink_policy::never
+            });
+    for (auto attempt = 0; (!registry.entries_.is_valid()) && (attempt < join_attempts); ++attempt)
+    {
+        registry.entries_ = typed_shared_memory<entry>::join({.path_ = config.path_});
+        if ((registry.entries_.error() != typed_shared_memory_error::bad_magic) &&
+                (registry.entries_.error() != typed_shared_memory_error::too_small))
+            break;  // initialized (or a genuine mismatch)
+        std::this_thread::sleep_for(join_retry_interval);
+    }
+    return registry;
+}
+
+
+//=============================================================================
+bool bcpp::system::segment_registry::is_valid
+(
+) const
+{
+    return entries_.is_valid();
+}
+
+
+//=============================================================================
+std::string bcpp::system::segment_registry::path
+(
+) const
+{
+    return entries_.path();
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::segment_registry::capacity
+(
+) const
+{
+    return entries_.data().size();
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::register_segment
+(
+    // record a segment owned by the calling process.  empty if the registry
+    // is full or if an active entry with the same name exists
+    registration const & config
+) -> std::optional<entry_id>
+{
+    if ((!is_valid()) || (config.name_.empty()) || (find(config.name_).has_value()))
+        return std::nullopt;
+
+    auto processId = ::getpid();
+    auto startTime = process_start_time(processId);
+    auto entries = entries_.data();
+    for (entry_id id = 0; id < entries.size(); ++id)
+    {
+        auto & e = entries[id];
+        auto state = entry_state::free;
+        if (!state_of(e).compare_exchange_strong(state, entry_state::claimed, std::memory_order_acquire))
+            continue;
+
+        // advance the generation at once (so that a reaper which read the
+        // entry's previous claim does not release this one) and record the
+        // claimant so that reap() can recover the entry if this process dies
+        // before publishing it
+        std::atomic_ref(e.generation_).fetch_add(1, std::memory_order_acq_rel);
+        e.ownerProcessId_ = processId;
+        e.ownerStartTime_ = startTime;
+        e.createTime_ = now();
+        std::atomic_ref(e.heartbeat_).store(e.createTime_, std::memory_order_release);
+        e.size_ = config.size_;
+        e.leaseDuration_ = config.leaseDuration_.count();
+        std::fill(std::begin(e.name_), std::end(e.name_), '\0');
+        std::fill(std::begin(e.purpose_), std::end(e.purpose_), '\0');
+        config.name_.copy(e.name_, std::min(config.name_.size(), max_name_length - 1));
+        config.purpose_.copy(e.purpose_, std::min(config.purpose_.size(), max_purpose_length - 1));
+        state_of(e).store(entry_state::active, std::memory_order_seq_cst);
+
+        // another process may have registered the same name since find().  both
+        // publish before looking so at least one of them sees the other and
+        // gives way (possibly both, which is safe)
+        std::string_view name(e.name_, strnlen(e.name_, max_name_length));
+        for (entry_id other = 0; other < entries.size(); ++other)
+        {
+            if ((other == id) || (state_of(entries[other]).load(std::memory_order_seq_cst) != entry_state::active) ||
+                    (std::string_view(entries[other].name_, strnlen(entries[other].name_, max_name_length)) != name))
+                continue;
+            state_of(e).store(entry_state::free, std::memory_order_release);
+            return std::nullopt;
+        }
+        return id;
+    }
+    return std::nullopt;
+}
+
+
+//=============================================================================
+bool bcpp::system::segment_registry::unregister_segment
+(
+    // remove the entry.  does not unlink the segment
+    entry_id id
+)
+{
+    auto entries = entries_.data();
+    if (id >= entries.size())
+        return false;
+    auto & e = entries[id];
+    if (e.ownerProcessId_ != ::getpid())
+        return false;
+    auto state = entry_state::active;
+    if (!state_of(e).compare_exchange_strong(state, entry_state::claimed, std::memory_order_acquire))
+        return false;
+    state_of(e).store(entry_state::free, std::memory_order_release);
+    return true;
+}
+
+
+//=============================================================================
+bool bcpp::system::segment_registry::renew
+(
+    entry_id id
+)
+{
+    auto entries = entries_.data();
+    if ((id >= entries.size()) || (state_of(entries[id]).load(std::memory_order_acquire) != entry_state::active))
+        return false;
+    std::atomic_ref(entries[id].heartbeat_).store(now(), std::memory_order_release);
+    return true;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::segment_registry::renew_owned
+(
+    // renew the lease of every entry owned by the calling process
+)
+{
+    std::size_t count = 0;
+    auto processId = ::getpid();
+    auto entries = entries_.data();
+    for (entry_id id = 0; id < entries.size(); ++id)
+        if ((state_of(entries[id]).load(std::memory_order_acquire) == entry_state::active) && (entries[id].ownerProcessId_ == processId))
+            count += renew(id);
+    return count;
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::heartbeat
+(
+    // a thread_pool worker which renews this process's leases every interval.
+    // the worker joins the registry itself so that it remains valid however
+    // this registry is moved or destroyed
+    std::chrono::nanoseconds interval,
+    std::string_view name
+) -> thread_pool::thread_configuration
+{
+    auto registry = std::make_shared<segment_registry>();
+    if (is_valid())
+        registry->entries_ = typed_shared_memory<entry>::join({.path_ = path()});
+    return {
+                .function_ = [registry, interval](std::stop_token const & stopToken)
+                        {
+                            std::mutex mutex;
+                            std::condition_variable_any conditionVariable;
+                            std::unique_lock uniqueLock(mutex);
+                            do
+                            {
+                                registry->renew_owned();
+                            } while (!conditionVariable.wait_for(uniqueLock, stopToken, interval, [&](){return stopToken.stop_requested();}));
+                        },
+                .name_ = std::string(name)
+            };
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::read_entry
+(
+    // a consistent copy of an active entry
+    entry_id id
+) const -> std::optional<segment_info>
+{
+    auto entries = entries_.data();
+    auto const & e = entries[id];
+    auto & generation = const_cast<std::uint32_t &>(e.generation_);
+    auto generationBefore = std::atomic_ref(generation).load(std::memory_order_acquire);
+    if (state_of(e).load(std::memory_order_acquire) != entry_state::active)
+        return std::nullopt;
+
+    auto heartbeat = std::atomic_ref(const_cast<std::int64_t &>(e.heartbeat_)).load(std::memory_order_acquire);
+    segment_info info
+    {
+        .id_ = id,
+        .name_ = std::string(e.name_, strnlen(e.name_, max_name_length)),
+        .purpose_ = std::string(e.purpose_, strnlen(e.purpose_, max_purpose_length)),
+        .ownerProcessId_ = e.ownerProcessId_,
+        .size_ = e.size_,
+        .createTime_ = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(e.createTime_))),
+        .heartbeat_ = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(heartbeat))),
+        .leaseDuration_ = std::chrono::nanoseconds(e.leaseDuration_),
+        .ownerAlive_ = is_alive(e.ownerProcessId_, e.ownerStartTime_),
+        .leaseExpired_ = ((heartbeat + e.leaseDuration_) < now())
+    };
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((state_of(e).load(std::memory_order_relaxed) != entry_state::active) ||
+            (std::atomic_ref(generation).load(std::memory_order_relaxed) != generationBefore))
+        return std::nullopt;    // released or reused while being read
+    return info;
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::list
+(
+) const -> std::vector<segment_info>
+{
+    std::vector<segment_info> result;
+    if (is_valid())
+        for (entry_id id = 0; id < entries_.data().size(); ++id)
+            if (auto info = read_entry(id); info.has_value())
+                result.push_back(std::move(*info));
+    return result;
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::find
+(
+    std::string_view name
+) const -> std::optional<segment_info>
+{
+    if (is_valid())
+        for (entry_id id = 0; id < entries_.data().size(); ++id)
+            if (std::string_view(entries_.data()[id].name_, strnlen(entries_.data()[id].name_, max_name_length)) == name)
+                if (auto info = read_entry(id); (info.has_value()) && (info->name_ == name))
+                    return info;
+    return std::nullopt;
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::find_by_purpose
+(
+    std::string_view purpose
+) const -> std::vector<segment_info>
+{
+    auto result = list();
+    std::erase_if(result, [&](auto const & info){return (info.purpose_ != purpose);});
+    return result;
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::join
+(
+    // discover a segment by name and join it
+    std::string_view name,
+    io_mode ioMode
+) const -> shared_memory
+{
+    if (auto info = find(name); (info.has_value()) && (info->ownerAlive_))
+        return shared_memory::join({.path_ = info->name_, .ioMode_ = ioMode}, {});
+    return {};
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::reap
+(
+) -> std::vector<segment_info>
+{
+    return reap(reap_configuration{});
+}
+
+
+//=============================================================================
+auto bcpp::system::segment_registry::reap
+(
+    // unlink the segments of entries whose owner has died or whose lease has
+    // expired and release the entries.  entries left claimed by a process
+    // which died while registering (or reaping) are released without
+    // unlinking anything since their contents may be incomplete.  returns
+    // the entries reaped.
+    reap_configuration const & config
+) -> std::vector<segment_info>
+{
+    std::vector<segment_info> reaped;
+    if (!is_valid())
+        return reaped;
+
+    auto processId = ::getpid();
+    auto startTime = process_start_time(processId);
+    auto entries = entries_.data();
+    for (auto & info : list())
+    {
+        auto shouldReap = (((config.reapDeadOwners_) && (!info.ownerAlive_)) || ((config.reapExpiredLeases_) && (info.leaseExpired_)));
+        if (!shouldReap)
+            continue;
+        if (!config.dryRun_)
+        {
+            // claim the entry so that only one reaper unlinks it.  the
+            // reaper records itself as the claimant in case it dies here
+            auto & e = entries[info.id_];
+            auto state = entry_state::active;
+            if (!state_of(e).compare_exchange_strong(state, entry_state::claimed, std::memory_order_acquire))
+                continue;
+            if (std::string_view(e.name_, strnlen(e.name_, max_name_length)) != info.name_)
+            {
+                state_of(e).store(entry_state::active, std::memory_order_release);
+                continue;   // reused since it was read
+            }
+            e.ownerProcessId_ = processId;
+            e.ownerStartTime_ = startTime;
+            std::atomic_ref(e.heartbeat_).store(now(), std::memory_order_release);
+            ::shm_unlink(info.name_.c_str());
+            state_of(e).store(entry_state::free, std::memory_order_release);
+        }
+        reaped.push_back(std::move(info));
+    }
+
+    if (!config.reapDeadOwners_)
+        return reaped;
+    auto staleTime = (now() - std::chrono::duration_cast<std::chrono::nanoseconds>(stale_claim_timeout).count());
+    for (entry_id id = 0; id < entries.size(); ++id)
+    {
+        auto & e = entries[id];
+        if (state_of(e).load(std::memory_order_acquire) != entry_state::claimed)
+            continue;
+        auto generation = std::atomic_ref(e.generation_).load(std::memory_order_acquire);
+        auto claimTime = std::atomic_ref(e.heartbeat_).load(std::memory_order_acquire);
+        if ((claimTime > staleTime) || (is_alive(e.ownerProcessId_, e.ownerStartTime_)))
+            continue;
+        segment_info info
+        {
+            .id_ = id,
+            .name_ = std::string(e.name_, strnlen(e.name_, max_name_length)),
+            .purpose_ = std::string(e.purpose_, strnlen(e.purpose_, max_purpose_length)),
+            .ownerProcessId_ = e.ownerProcessId_,
+            .size_ = e.size_,
+            .createTime_ = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(e.createTime_))),
+            .heartbeat_ = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(claimTime))),
+            .leaseDuration_ = std::chrono::nanoseconds(e.leaseDuration_),
+            .ownerAlive_ = false,
+            .leaseExpired_ = true
+        };
+        if (!config.dryRun_)
+        {
+            // advancing the generation ensures that only one reaper releases
+            // the entry and not after it has been released and claimed anew
+            if (!std::atomic_ref(e.generation_).compare_exchange_strong(generation, generation + 1, std::memory_order_acq_rel))
+                continue;
+            state_of(e).store(entry_state::free, std::memory_order_release);
+        }
+        reaped.push_back(std::move(info));
+    }
+    return reaped;
+}
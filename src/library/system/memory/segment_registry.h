@@ -0,0 +1,209 @@
+#pragma once
+
+#include "./shared_memory.h"
+#include "./typed_shared_memory.h"
+
+#include <library/system/cache_line.h>
+#include <library/system/threading/thread_pool.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // segment_registry
+    //
+    // a directory of shared memory segments which itself lives in shared
+    // memory at a well known path.  each entry records a segment's name,
+    // owner process, purpose, size and a heartbeat lease.  joiners discover
+    // segments by name (or purpose) rather than through configuration and
+    // reap() unlinks segments whose owner has died or stopped renewing its
+    // lease so that crashed processes do not leave orphans in /dev/shm.
+    //
+    // entries are claimed and released with atomic operations on the entry
+    // itself so that any number of processes may use the registry at once.
+    // a process which dies while holding a claim leaves the entry to be
+    // recovered by a later reap().
+    //=========================================================================
+    class segment_registry :
+        non_copyable
+    {
+    public:
+
+        static auto constexpr default_path = "bcpp.registry";
+        static std::size_t constexpr default_capacity = 1024;
+        static std::size_t constexpr max_name_length = 64;
+        static std::size_t constexpr max_purpose_length = 64;
+        // a claimed entry whose claimant has died is released by reap() once
+        // it has been claimed for this long
+        static auto constexpr stale_claim_timeout = std::chrono::seconds(1);
+
+        using entry_id = std::size_t;
+
+        struct alignas(cache_line_size) entry
+        {
+            enum class entry_state : std::uint32_t
+            {
+                free,
+                claimed,    // being written or reaped (ownerProcessId_ and heartbeat_ record the claimant)
+                active
+            };
+
+            // state_, generation_ and heartbeat_ are accessed through std::atomic_ref
+            // so that entry remains trivially copyable as typed_shared_memory requires
+            entry_state                 state_;
+            std::uint32_t               generation_;        // incremented each time the entry is claimed
+            std::int32_t                ownerProcessId_;
+            std::uint64_t               ownerStartTime_;    // guards against process id reuse
+            std::uint64_t               size_;
+            std::int64_t                createTime_;        // system_clock nanoseconds
+            std::int64_t                heartbeat_;         // system_clock nanoseconds
+            std::int64_t                leaseDuration_;     // nanoseconds
+            char                        name_[max_name_length];
+            char                        purpose_[max_purpose_length];
+        };
+
+        struct configuration
+        {
+            std::string     path_{default_path};
+            std::size_t     capacity_{default_capacity};    // used only by the process which creates the registry
+        };
+
+        struct registration
+        {
+            std::string                 name_;
+            std::string                 purpose_;
+            std::size_t                 size_{0};
+            std::chrono::nanoseconds    leaseDuration_{std::chrono::seconds(10)};
+        };
+
+        struct segment_info
+        {
+            entry_id                    id_;
+            std::string                 name_;
+            std::string                 purpose_;
+            std::int32_t                ownerProcessId_;
+            std::size_t                 size_;
+            std::chrono::system_clock::time_point   createTime_;
+            std::chrono::system_clock::time_point   heartbeat_;
+            std::chrono::nanoseconds    leaseDuration_;
+            bool                        ownerAlive_;
+            bool                        leaseExpired_;
+        };
+
+        struct reap_configuration
+        {
+            bool    reapDeadOwners_{true};
+            bool    reapExpiredLeases_{true};
+            bool    dryRun_{false};
+        };
+
+        // creates the registry or joins it if it already exists
+        static segment_registry open();
+
+        static segment_registry open
+        (
+            configuration const &
+        );
+
+        segment_registry() = default;
+        segment_registry(segment_registry &&) = default;
+        segment_registry & operator = (segment_registry &&) = default;
+        ~segment_registry() = default;
+
+        bool is_valid() const;
+
+        std::string path() const;
+
+        std::size_t capacity() const;
+
+        std::optional<entry_id> register_segment
+        (
+            registration const &
+        );
+
+        bool unregister_segment
+        (
+            entry_id
+        );
+
+        bool renew
+        (
+            entry_id
+        );
+
+        std::size_t renew_owned();
+
+        thread_pool::thread_configuration heartbeat
+        (
+            std::chrono::nanoseconds,
+            std::string_view = "registry"
+        );
+
+        std::vector<segment_info> list() const;
+
+        std::optional<segment_info> find
+        (
+            std::string_view
+        ) const;
+
+        std::vector<segment_info> find_by_purpose
+        (
+            std::string_view
+        ) const;
+
+        shared_memory join
+        (
+            std::string_view,
+            io_mode = io_mode::read_write
+        ) const;
+
+        std::vector<segment_info> reap();
+
+        std::vector<segment_info> reap
+        (
+            reap_configuration const &
+        );
+
+    private:
+
+        std::optional<segment_info> read_entry
+        (
+            entry_id
+        ) const;
+
+        typed_shared_memory<entry>  entries_;
+
+    }; // class segment_registry
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <>
+struct bcpp::system::schema_traits<bcpp::system::segment_registry::entry>
+{
+    static constexpr std::string_view name = "bcpp::system::segment_registry::entry";
+    static constexpr auto fields = std::to_array(
+            {
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, state_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, generation_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, ownerProcessId_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, ownerStartTime_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, size_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, createTime_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, heartbeat_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, leaseDuration_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, name_),
+                BCPP_SCHEMA_FIELD(bcpp::system::segment_registry::entry, purpose_)
+            });
+};
@@ -71,7 +71,8 @@ bcpp::system::shared_memory::shared_memory
                             .size_ = config.size_,
                             .ioMode_ = config.ioMode_,
                             .mmapFlags_ = config.mmapFlags_ | MAP_SHARED,
-                            .alignment_ = 0
+                            .alignment_ = 0,
+                            .tag_ = config.tag_
                         },
                         {
                         }, fileDescriptor));
@@ -116,11 +117,16 @@ bcpp::system::shared_memory::shared_memory
                         .size_ = (unsigned)fileStat.st_size,
                         .ioMode_ = config.ioMode_,
                         .mmapFlags_ = config.mmapFlags_ | MAP_SHARED,
-                        .alignment_ = 0
+                        .alignment_ = 0,
+                        .tag_ = config.tag_
                     },
                     {
                     }, fileDescriptor));
-            if ((unlinkPolicy_ == unlink_policy::on_attach) || (memoryMapping_.data() == nullptr))
+            // a segment which could not be joined (ie: refused by a budget)
+            // belongs to another process and is never unlinked by this one
+            if (memoryMapping_.data() == nullptr)
+                path_ = {};
+            else if (unlinkPolicy_ == unlink_policy::on_attach)
                 unlink();
         }
     }
@@ -206,6 +212,15 @@ void bcpp::system::shared_memory::unlink
 }
 
 
+//=============================================================================
+bool bcpp::system::shared_memory::is_budget_refused
+(
+) const
+{
+    return memoryMapping_.is_budget_refused();
+}
+
+
 //=============================================================================
 std::string bcpp::system::shared_memory::path
 (
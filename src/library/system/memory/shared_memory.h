@@ -41,6 +41,7 @@ namespace bcpp::system
             io_mode         ioMode_;
             std::size_t     mmapFlags_{MAP_SHARED};
             unlink_policy   unlinkPolicy_{default_unlink_policy};
+            std::string     tag_{"shared_memory"};  // accounting tag (see mapping_registry)
         };
 
         struct join_configuration
@@ -49,6 +50,7 @@ namespace bcpp::system
             io_mode         ioMode_;
             std::size_t     mmapFlags_{MAP_SHARED};
             unlink_policy   unlinkPolicy_{default_unlink_policy};
+            std::string     tag_{"shared_memory"};  // accounting tag (see mapping_registry)
         };
 
         struct event_handlers
@@ -93,6 +95,10 @@ namespace bcpp::system
 
         bool is_valid() const;
 
+        // true if the mapping was refused by an enforced budget (see
+        // mapping_registry) rather than failed
+        bool is_budget_refused() const;
+
         void unlink();
 
         std::string path() const;
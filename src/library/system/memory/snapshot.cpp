@@ -0,0 +1,330 @@
+#include "./snapshot.h"
+#include "./memory_copy.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+    static std::uint64_t constexpr snapshot_magic = 0x746f687370616e73;   // "snapshot"
+    static std::uint32_t constexpr snapshot_version = 1;
+
+    struct snapshot_trailer
+    {
+        std::uint64_t   magic_;
+        std::uint32_t   version_;
+        std::uint32_t   reserved_;
+        std::uint64_t   size_;
+        std::int64_t    created_;       // nanoseconds since the epoch
+        char            tag_[32];
+    };
+
+
+    //=========================================================================
+    std::size_t trailer_offset
+    (
+        // the trailer follows the contents at the next page boundary
+        std::size_t size
+    )
+    {
+        auto pageSize = static_cast<std::size_t>(::getpagesize());
+        return ((size + pageSize - 1) & ~(pageSize - 1));
+    }
+
+
+    //=========================================================================
+    bool write_snapshot
+    (
+        // async signal safe (no allocation) as it is called in a forked child
+        // of a multithreaded process
+        char const * path,
+        char const * temporaryPath,
+        std::span<std::byte const> contents,
+        snapshot_trailer const & trailer,
+        bool sync
+    )
+    {
+        auto fileDescriptor = ::open(temporaryPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fileDescriptor < 0)
+            return false;
+        auto write_all = [&](void const * data, std::size_t size, off_t offset)
+                {
+                    auto const * bytes = static_cast<std::byte const *>(data);
+                    while (size > 0)
+                    {
+                        auto written = ::pwrite(fileDescriptor, bytes, std::min<std::size_t>(size, 1 << 30), offset);
+                        if ((written < 0) && (errno == EINTR))
+                            continue;
+                        if (written <= 0)
+                            return false;
+                        bytes += written;
+                        offset += written;
+                        size -= written;
+                    }
+                    return true;
+                };
+        auto success = ((write_all(contents.data(), contents.size(), 0)) &&
+                (write_all(&trailer, sizeof(trailer), static_cast<off_t>(trailer_offset(contents.size())))) &&
+                ((!sync) || (::fsync(fileDescriptor) == 0)));
+        success = ((::close(fileDescriptor) == 0) && (success));
+        return ((success) && (::rename(temporaryPath, path) == 0));
+    }
+
+
+    //=========================================================================
+    std::optional<snapshot_trailer> read_trailer
+    (
+        std::int32_t fileDescriptor
+    )
+    {
+        struct stat status;
+        if ((::fstat(fileDescriptor, &status) != 0) || (static_cast<std::size_t>(status.st_size) < sizeof(snapshot_trailer)))
+            return std::nullopt;
+        snapshot_trailer trailer;
+        auto offset = (status.st_size - sizeof(trailer));
+        if (::pread(fileDescriptor, &trailer, sizeof(trailer), offset) != sizeof(trailer))
+            return std::nullopt;
+        if ((trailer.magic_ != snapshot_magic) || (trailer.version_ != snapshot_version) || (trailer_offset(trailer.size_) != offset))
+            return std::nullopt;
+        return trailer;
+    }
+
+
+    //=========================================================================
+    bool read_all
+    (
+        std::int32_t fileDescriptor,
+        std::span<std::byte> destination
+    )
+    {
+        std::size_t offset = 0;
+        while (offset < destination.size())
+        {
+            auto bytesRead = ::pread(fileDescriptor, destination.data() + offset, destination.size() - offset, offset);
+            if ((bytesRead < 0) && (errno == EINTR))
+                continue;
+            if (bytesRead <= 0)
+                return false;
+            offset += bytesRead;
+        }
+        return true;
+    }
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::snapshot_writer::snapshot_writer
+(
+    std::span<std::byte const> contents,
+    configuration const & config
+):
+    configuration_(config)
+{
+    snapshot_trailer trailer{.magic_ = snapshot_magic, .version_ = snapshot_version, .reserved_ = 0, .size_ = contents.size(),
+            .created_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count(),
+            .tag_ = {}};
+    std::strncpy(trailer.tag_, config.tag_.c_str(), sizeof(trailer.tag_) - 1);
+    auto temporaryPath = (config.path_ + ".tmp");
+    auto start = std::chrono::steady_clock::now();
+
+    if (config.captureMethod_ == capture_method::fork)
+    {
+        childProcessId_ = ::fork();
+        if (childProcessId_ == 0)
+            ::_exit(write_snapshot(config.path_.c_str(), temporaryPath.c_str(), contents, trailer, config.sync_) ? 0 : 1);
+        if (childProcessId_ < 0)
+            childProcessId_ = 0;
+        else
+            captureDuration_ = (std::chrono::steady_clock::now() - start);
+        return;
+    }
+
+    copy_ = anonymous_mapping({.size_ = std::max<std::size_t>(contents.size(), 1), .tag_ = "snapshot"}, {});
+    if (!copy_.is_valid())
+        return;
+    copy(copy_.data(), contents.data(), contents.size());
+    captureDuration_ = (std::chrono::steady_clock::now() - start);
+    writerThread_ = std::jthread([this, temporaryPath, trailer, size = contents.size()]()
+            {
+                writerResult_ = write_snapshot(configuration_.path_.c_str(), temporaryPath.c_str(), {copy_.data(), size}, trailer, configuration_.sync_);
+                copy_.close();
+                writerComplete_.store(true, std::memory_order_release);
+            });
+}
+
+
+//=============================================================================
+bcpp::system::snapshot_writer::~snapshot_writer
+(
+)
+{
+    wait();
+}
+
+
+//=============================================================================
+bool bcpp::system::snapshot_writer::is_valid
+(
+) const
+{
+    return ((childProcessId_ > 0) || (writerThread_.joinable()) || (result_.has_value()));
+}
+
+
+//=============================================================================
+bool bcpp::system::snapshot_writer::is_complete
+(
+)
+{
+    if (result_.has_value())
+        return true;
+    if (childProcessId_ > 0)
+    {
+        std::int32_t status;
+        auto processId = ::waitpid(childProcessId_, &status, WNOHANG);
+        if (processId == 0)
+            return false;
+        result_ = ((processId == childProcessId_) && (WIFEXITED(status)) && (WEXITSTATUS(status) == 0));
+        childProcessId_ = 0;
+        return true;
+    }
+    if (writerThread_.joinable())
+    {
+        if (!writerComplete_.load(std::memory_order_acquire))
+            return false;
+        writerThread_.join();
+        result_ = writerResult_;
+        return true;
+    }
+    return false;
+}
+
+
+//=============================================================================
+bool bcpp::system::snapshot_writer::wait
+(
+)
+{
+    if (childProcessId_ > 0)
+    {
+        std::int32_t status;
+        pid_t processId;
+        while (((processId = ::waitpid(childProcessId_, &status, 0)) < 0) && (errno == EINTR))
+            ;
+        result_ = ((processId == childProcessId_) && (WIFEXITED(status)) && (WEXITSTATUS(status) == 0));
+        childProcessId_ = 0;
+    }
+    if (writerThread_.joinable())
+    {
+        writerThread_.join();
+        result_ = writerResult_;
+    }
+    return result_.value_or(false);
+}
+
+
+//=============================================================================
+std::chrono::nanoseconds bcpp::system::snapshot_writer::capture_duration
+(
+) const
+{
+    return captureDuration_;
+}
+
+
+//=============================================================================
+auto bcpp::system::get_snapshot_info
+(
+    std::string const & path
+) -> std::optional<snapshot_info>
+{
+    file_descriptor fileDescriptor(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fileDescriptor.is_valid())
+        return std::nullopt;
+    auto trailer = read_trailer(fileDescriptor.get());
+    if (!trailer)
+        return std::nullopt;
+    return snapshot_info{
+                .size_ = trailer->size_,
+                .tag_ = std::string(trailer->tag_, ::strnlen(trailer->tag_, sizeof(trailer->tag_))),
+                .created_ = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::nanoseconds(trailer->created_)))
+            };
+}
+
+
+//=============================================================================
+auto bcpp::system::map_snapshot
+(
+    std::string const & path,
+    std::string const & tag
+) -> memory_mapping
+{
+    file_descriptor fileDescriptor(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fileDescriptor.is_valid())
+        return {};
+    auto trailer = read_trailer(fileDescriptor.get());
+    if ((!trailer) || (trailer->size_ == 0))
+        return {};
+    // no alignment so that the contents (at offset zero) are at data()
+    return memory_mapping({.size_ = trailer->size_, .ioMode_ = io_mode::read_write, .mmapFlags_ = MAP_PRIVATE, .alignment_ = 0, .tag_ = tag},
+            {}, fileDescriptor);
+}
+
+
+//=============================================================================
+bool bcpp::system::remap_snapshot
+(
+    std::string const & path,
+    anonymous_mapping & destination
+)
+{
+    file_descriptor fileDescriptor(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if ((!fileDescriptor.is_valid()) || (!destination.is_valid()))
+        return false;
+    auto trailer = read_trailer(fileDescriptor.get());
+    if ((!trailer) || (trailer->size_ != destination.size()))
+        return false;
+
+    // whole pages are mapped over the destination.  a partial last page may
+    // not be (the page beyond the mapping could belong to something else) so
+    // it is read
+    auto pageSize = static_cast<std::size_t>(::getpagesize());
+    auto * address = destination.data();
+    if ((reinterpret_cast<std::uintptr_t>(address) % pageSize) != 0)
+        return restore_snapshot(path, {destination.data(), destination.size()});
+    auto mappedSize = (destination.size() & ~(pageSize - 1));
+    if ((mappedSize > 0) && (::mmap(address, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fileDescriptor.get(), 0) == MAP_FAILED))
+        return false;
+    auto remainder = destination.size() - mappedSize;
+    if (remainder == 0)
+        return true;
+    return (::pread(fileDescriptor.get(), address + mappedSize, remainder, static_cast<off_t>(mappedSize)) == static_cast<ssize_t>(remainder));
+}
+
+
+//=============================================================================
+bool bcpp::system::restore_snapshot
+(
+    std::string const & path,
+    std::span<std::byte> destination
+)
+{
+    file_descriptor fileDescriptor(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fileDescriptor.is_valid())
+        return false;
+    auto trailer = read_trailer(fileDescriptor.get());
+    if ((!trailer) || (trailer->size_ != destination.size()))
+        return false;
+    ::posix_fadvise(fileDescriptor.get(), 0, static_cast<off_t>(destination.size()), POSIX_FADV_SEQUENTIAL);
+    return read_all(fileDescriptor.get(), destination);
+}
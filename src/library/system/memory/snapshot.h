@@ -0,0 +1,153 @@
+#pragma once
+
+#include "./anonymous_mapping.h"
+#include "./memory_mapping.h"
+
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // snapshot_writer
+    //
+    // writes a consistent snapshot of a region of memory (ie: the contents of
+    // an anonymous_mapping or shared_memory) to a file in the background so
+    // that a restarted process can map its state back rather than rebuild it.
+    //
+    // the region is captured when the writer is constructed and written
+    // while the caller continues:
+    //
+    //  fork - a child process is forked and writes the region.  the child's
+    //         copy of private memory (ie: an anonymous_mapping) is copy on
+    //         write so it stays exactly as it was at the fork however the
+    //         parent modifies it.  the caller is held only for the fork
+    //         itself (which copies the page tables).  shared memory is NOT
+    //         copied on write and so is not consistent with this method.
+    //
+    //  copy - the region is copied (at memory bandwidth, streamed past the
+    //         cache) into a private buffer which a background thread then
+    //         writes.  writers of shared memory must be held (by the caller)
+    //         for the duration of the constructor.
+    //
+    // the file is written to path_ + ".tmp", synced and then renamed to
+    // path_ so that a crash while writing leaves the previous snapshot in
+    // place.  the contents are at offset zero of the file (so the file can be
+    // mapped directly) and are followed, at the next page boundary, by a
+    // trailer which identifies a complete snapshot.
+    //=========================================================================
+    class snapshot_writer :
+        non_copyable
+    {
+    public:
+
+        enum class capture_method
+        {
+            fork,
+            copy
+        };
+
+        struct configuration
+        {
+            std::string         path_;
+            capture_method      captureMethod_{capture_method::fork};
+            std::string         tag_;                   // recorded in the trailer (truncated to 31 characters)
+            bool                sync_{true};            // fsync before the rename
+        };
+
+        snapshot_writer
+        (
+            std::span<std::byte const>,
+            configuration const &
+        );
+
+        // waits for the write to complete
+        ~snapshot_writer();
+
+        // false if the capture could not be started
+        bool is_valid() const;
+
+        // does not block
+        bool is_complete();
+
+        // blocks until the snapshot is written.  true if it was written successfully
+        bool wait();
+
+        // how long the caller was held by the capture
+        std::chrono::nanoseconds capture_duration() const;
+
+    private:
+
+        configuration                   configuration_;
+
+        std::chrono::nanoseconds        captureDuration_{0};
+
+        // fork
+        pid_t                           childProcessId_{0};
+
+        // copy
+        anonymous_mapping               copy_;
+
+        std::jthread                    writerThread_;
+
+        std::optional<bool>             result_;
+
+        std::atomic<bool>               writerComplete_{false};
+
+        bool                            writerResult_{false};
+
+    }; // class snapshot_writer
+
+
+    struct snapshot_info
+    {
+        std::size_t                             size_;
+        std::string                             tag_;
+        std::chrono::system_clock::time_point   created_;
+    };
+
+    // empty if the file is not a complete snapshot
+    std::optional<snapshot_info> get_snapshot_info
+    (
+        std::string const &
+    );
+
+    // map the snapshot privately.  pages are read from the file on first
+    // access (and copied on first write) so the cost of a restart follows the
+    // working set rather than the size of the snapshot
+    memory_mapping map_snapshot
+    (
+        std::string const &,
+        std::string const & = "snapshot"
+    );
+
+    // replace the contents of a private mapping with the snapshot by mapping
+    // the file over it (lazily, as map_snapshot) at the same address.  the
+    // sizes must match.  never use on shared memory (see restore_snapshot)
+    bool remap_snapshot
+    (
+        std::string const &,
+        anonymous_mapping &
+    );
+
+    // copy the snapshot into memory (ie: shared_memory, which must remain
+    // shared and so can not be remapped).  the sizes must match
+    bool restore_snapshot
+    (
+        std::string const &,
+        std::span<std::byte>
+    );
+
+} // namespace bcpp::system
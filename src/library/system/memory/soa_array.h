@@ -0,0 +1,282 @@
+#pragma once
+
+#include <library/system/cache_line.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <numeric>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // soa_array
+    //
+    // a fixed capacity struct of arrays over caller provided storage (ie: an
+    // anonymous_mapping or shared_memory segment).  each column starts on a
+    // cache line so that a pass over one field touches only that field's
+    // lines.  partition() splits an index range into parts whose boundaries
+    // fall on cache line boundaries in every column so that workers writing
+    // disjoint parts never write the same line.
+    //
+    // columns hold trivially copyable types so that the storage may be
+    // shared between processes.  soa_array itself holds only pointers into
+    // the storage and each process constructs its own over its own mapping.
+    //
+    //      auto size = soa_array<std::int64_t, std::uint32_t>::required_size(count);
+    //      anonymous_mapping mapping({.size_ = size}, {});
+    //      soa_array<std::int64_t, std::uint32_t> orders({mapping.data(), mapping.size()}, count);
+    //      for (auto & price : orders.column<0>())
+    //          ...
+    //=========================================================================
+    template <typename ... Ts>
+    class soa_array
+    {
+    public:
+
+        static_assert(sizeof ... (Ts) > 0, "soa_array requires at least one column");
+        static_assert((std::is_trivially_copyable_v<Ts> && ...), "soa_array columns must be trivially copyable");
+        static_assert(((alignof(Ts) <= cache_line_size) && ...), "soa_array column alignment can not exceed a cache line");
+
+        static std::size_t constexpr column_count = sizeof ... (Ts);
+
+        template <std::size_t I>
+        using column_type = std::tuple_element_t<I, std::tuple<Ts ...>>;
+
+        struct range
+        {
+            std::size_t begin_;
+            std::size_t end_;
+        };
+
+        // bytes of storage needed for capacity elements
+        static constexpr std::size_t required_size
+        (
+            std::size_t
+        );
+
+        soa_array() = default;
+
+        soa_array
+        (
+            std::span<std::byte>,
+            std::size_t
+        );
+
+        bool is_valid() const noexcept;
+
+        std::size_t capacity() const noexcept;
+
+        template <std::size_t I>
+        std::span<column_type<I>> column() noexcept;
+
+        template <std::size_t I>
+        std::span<column_type<I> const> column() const noexcept;
+
+        template <std::size_t I>
+        column_type<I> & get
+        (
+            std::size_t
+        ) noexcept;
+
+        template <std::size_t I>
+        column_type<I> const & get
+        (
+            std::size_t
+        ) const noexcept;
+
+        // references to every field of one element
+        std::tuple<Ts & ...> operator []
+        (
+            std::size_t
+        ) noexcept;
+
+        std::tuple<Ts const & ...> operator []
+        (
+            std::size_t
+        ) const noexcept;
+
+        // the part'th of partCount cache line aligned ranges of [0, capacity)
+        range partition
+        (
+            std::size_t,
+            std::size_t
+        ) const noexcept;
+
+    private:
+
+        static constexpr std::size_t round_up_to_line
+        (
+            std::size_t value
+        )
+        {
+            return ((value + cache_line_size - 1) / cache_line_size) * cache_line_size;
+        }
+
+        // elements per partition boundary such that the boundary is line aligned in every column.
+        // a column of T needs a multiple of line / gcd(sizeof(T), line) elements (ie: 16 for a 12
+        // byte T) and, the line size being a power of two, each of those is a power of two so the
+        // largest is a multiple of all of them
+        static std::size_t constexpr partition_granularity = std::max({(cache_line_size / std::gcd(sizeof(Ts), cache_line_size)) ...});
+
+        std::size_t                                 capacity_{0};
+
+        std::array<std::byte *, column_count>       columns_{};
+
+    }; // class soa_array
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename ... Ts>
+inline constexpr std::size_t bcpp::system::soa_array<Ts ...>::required_size
+(
+    std::size_t capacity
+)
+{
+    // the storage may itself be only page (or cache line) aligned so allow for aligning the first column
+    return (cache_line_size + (round_up_to_line(sizeof(Ts) * capacity) + ...));
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+inline bcpp::system::soa_array<Ts ...>::soa_array
+(
+    // storage must be at least required_size(capacity) bytes.  the columns
+    // are placed in declaration order at cache line aligned offsets.  the
+    // content of the storage is left as it is so that a process can attach
+    // to an array populated by another
+    std::span<std::byte> storage,
+    std::size_t capacity
+)
+{
+    if ((storage.data() == nullptr) || (storage.size() < required_size(capacity)))
+        return;
+    auto address = round_up_to_line(reinterpret_cast<std::uintptr_t>(storage.data()));
+    std::size_t index = 0;
+    ((columns_[index++] = reinterpret_cast<std::byte *>(std::exchange(address, address + round_up_to_line(sizeof(Ts) * capacity)))), ...);
+    capacity_ = capacity;
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+inline bool bcpp::system::soa_array<Ts ...>::is_valid
+(
+) const noexcept
+{
+    return (columns_[0] != nullptr);
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+inline std::size_t bcpp::system::soa_array<Ts ...>::capacity
+(
+) const noexcept
+{
+    return capacity_;
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+template <std::size_t I>
+inline auto bcpp::system::soa_array<Ts ...>::column
+(
+) noexcept -> std::span<column_type<I>>
+{
+    return {std::launder(reinterpret_cast<column_type<I> *>(columns_[I])), capacity_};
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+template <std::size_t I>
+inline auto bcpp::system::soa_array<Ts ...>::column
+(
+) const noexcept -> std::span<column_type<I> const>
+{
+    return {std::launder(reinterpret_cast<column_type<I> const *>(columns_[I])), capacity_};
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+template <std::size_t I>
+inline auto bcpp::system::soa_array<Ts ...>::get
+(
+    std::size_t index
+) noexcept -> column_type<I> &
+{
+    return column<I>()[index];
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+template <std::size_t I>
+inline auto bcpp::system::soa_array<Ts ...>::get
+(
+    std::size_t index
+) const noexcept -> column_type<I> const &
+{
+    return column<I>()[index];
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+inline auto bcpp::system::soa_array<Ts ...>::operator []
+(
+    std::size_t index
+) noexcept -> std::tuple<Ts & ...>
+{
+    return [&]<std::size_t ... Is>(std::index_sequence<Is ...>)
+            {
+                return std::tuple<Ts & ...>(get<Is>(index) ...);
+            }(std::index_sequence_for<Ts ...>{});
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+inline auto bcpp::system::soa_array<Ts ...>::operator []
+(
+    std::size_t index
+) const noexcept -> std::tuple<Ts const & ...>
+{
+    return [&]<std::size_t ... Is>(std::index_sequence<Is ...>)
+            {
+                return std::tuple<Ts const & ...>(get<Is>(index) ...);
+            }(std::index_sequence_for<Ts ...>{});
+}
+
+
+//=============================================================================
+template <typename ... Ts>
+inline auto bcpp::system::soa_array<Ts ...>::partition
+(
+    std::size_t part,
+    std::size_t partCount
+) const noexcept -> range
+{
+    if ((partCount == 0) || (part >= partCount))
+        return {capacity_, capacity_};
+    auto granules = (capacity_ + partition_granularity - 1) / partition_granularity;
+    auto boundary = [&](auto p)
+            {
+                return std::min(((granules * p) / partCount) * partition_granularity, capacity_);
+            };
+    return {boundary(part), boundary(part + 1)};
+}
@@ -0,0 +1,63 @@
+#include "./typed_shared_memory.h"
+
+#include <sstream>
+
+
+//=============================================================================
+std::string_view bcpp::system::to_string
+(
+    typed_shared_memory_error error
+)
+{
+    switch (error)
+    {
+        case typed_shared_memory_error::none: return "none";
+        case typed_shared_memory_error::open_failed: return "failed to open shared memory";
+        case typed_shared_memory_error::too_small: return "segment is smaller than its header describes";
+        case typed_shared_memory_error::bad_magic: return "not a typed_shared_memory segment (or not yet initialized)";
+        case typed_shared_memory_error::header_version_mismatch: return "header version mismatch";
+        case typed_shared_memory_error::schema_version_mismatch: return "schema version mismatch";
+        case typed_shared_memory_error::size_mismatch: return "type size mismatch";
+        case typed_shared_memory_error::alignment_mismatch: return "type alignment mismatch";
+        case typed_shared_memory_error::schema_hash_mismatch: return "schema hash mismatch";
+    }
+    return "unknown";
+}
+
+
+//=============================================================================
+std::string bcpp::system::describe_schema_mismatch
+(
+    typed_shared_memory_error error,
+    typed_shared_memory_header const & expected,
+    typed_shared_memory_header const & found
+)
+{
+    std::ostringstream stream;
+    stream << to_string(error);
+    switch (error)
+    {
+        case typed_shared_memory_error::header_version_mismatch:
+            stream << ": segment header version " << found.headerVersion_ << " but this build expects " << typed_shared_memory_header::version;
+            break;
+        case typed_shared_memory_error::schema_version_mismatch:
+        case typed_shared_memory_error::size_mismatch:
+        case typed_shared_memory_error::alignment_mismatch:
+        case typed_shared_memory_error::schema_hash_mismatch:
+        {
+            auto describe = [&](typed_shared_memory_header const & hdr)
+                    {
+                        stream << "'" << hdr.typeName_ << "' v" << hdr.schemaVersion_ << " (size " << hdr.size_ <<
+                                ", align " << hdr.alignment_ << ", hash 0x" << std::hex << hdr.schemaHash_ << std::dec << ")";
+                    };
+            stream << ": segment holds ";
+            describe(found);
+            stream << " but this build expects ";
+            describe(expected);
+            break;
+        }
+        default:
+            break;
+    }
+    return stream.str();
+}
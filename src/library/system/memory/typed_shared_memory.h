@@ -0,0 +1,397 @@
+#pragma once
+
+#include "./shared_memory.h"
+#include "./schema.h"
+
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // typed_shared_memory_header
+    //
+    // written by the creator of a typed_shared_memory segment ahead of the
+    // data.  a joiner compares every field with its own view of T.
+    //=========================================================================
+    struct alignas(cache_line_size) typed_shared_memory_header
+    {
+        static std::uint64_t constexpr magic = 0x6570'7974'7070'6362;  // "bcpptype"
+        static std::uint32_t constexpr version = 1;
+        static std::size_t constexpr max_type_name_length = 128;
+
+        std::uint64_t   magic_;
+        std::uint32_t   headerVersion_;
+        std::uint32_t   schemaVersion_;
+        std::uint64_t   schemaHash_;
+        std::uint64_t   size_;          // sizeof(T)
+        std::uint64_t   alignment_;     // alignof(T)
+        std::uint64_t   count_;         // number of T
+        std::uint64_t   dataOffset_;    // from the start of the header
+        char            typeName_[max_type_name_length];
+    };
+
+
+    enum class typed_shared_memory_error
+    {
+        none,
+        open_failed,
+        too_small,
+        bad_magic,
+        header_version_mismatch,
+        schema_version_mismatch,
+        size_mismatch,
+        alignment_mismatch,
+        schema_hash_mismatch
+    };
+
+    std::string_view to_string
+    (
+        typed_shared_memory_error
+    );
+
+
+    //=========================================================================
+    // typed_shared_memory
+    //
+    // shared_memory holding count_ instances of T preceded by a header which
+    // describes T's layout.  join() fails (is_valid() is false and error()
+    // says why) if the segment was created by a build whose T differs in
+    // schema hash, version, size or alignment, so that deployment skew is
+    // caught at attach time rather than by silently corrupted data.  the
+    // schema hash is only as strong as T's schema_traits (see schema.h).
+    // access to the data is zero copy.  get() and operator-> require a valid
+    // segment holding at least one T.
+    //=========================================================================
+    template <typename T>
+    class typed_shared_memory :
+        non_copyable
+    {
+    public:
+
+        static_assert(std::is_trivially_copyable_v<T>, "typed_shared_memory requires a trivially copyable type");
+        static_assert(std::is_standard_layout_v<T>, "typed_shared_memory requires a standard layout type");
+        static_assert(!std::is_pointer_v<T>, "pointers are meaningless in another process");
+        static_assert(alignof(T) <= 4096, "typed_shared_memory alignment can not exceed a page");
+
+        using value_type = T;
+        using header = typed_shared_memory_header;
+
+        static std::uint64_t constexpr schema_hash = bcpp::system::schema_hash<T>();
+        static std::uint32_t constexpr schema_version = bcpp::system::schema_version<T>();
+        static std::size_t constexpr data_offset = ((sizeof(header) + alignof(T) - 1) / alignof(T)) * alignof(T);
+
+        struct create_configuration
+        {
+            std::string                     path_;
+            std::size_t                     count_{1};
+            shared_memory::unlink_policy    unlinkPolicy_{shared_memory::default_unlink_policy};
+        };
+
+        struct join_configuration
+        {
+            std::string                     path_;
+            io_mode                         ioMode_{io_mode::read_write};
+            shared_memory::unlink_policy    unlinkPolicy_{shared_memory::default_unlink_policy};
+        };
+
+        static typed_shared_memory create
+        (
+            create_configuration const &
+        );
+
+        static typed_shared_memory join
+        (
+            join_configuration const &
+        );
+
+        typed_shared_memory() = default;
+        typed_shared_memory(typed_shared_memory &&) = default;
+        typed_shared_memory & operator = (typed_shared_memory &&) = default;
+        ~typed_shared_memory() = default;
+
+        bool is_valid() const;
+
+        typed_shared_memory_error error() const;
+
+        std::string error_message() const;
+
+        std::string path() const;
+
+        T & get();
+        T const & get() const;
+
+        T * operator ->();
+        T const * operator ->() const;
+
+        std::span<T> data();
+        std::span<T const> data() const;
+
+        header const * get_header() const;
+
+        static std::size_t required_size
+        (
+            std::size_t
+        );
+
+    private:
+
+        typed_shared_memory_error   error_{typed_shared_memory_error::none};
+
+        header                      found_{};
+
+        shared_memory               sharedMemory_;
+
+    }; // class typed_shared_memory
+
+    std::string describe_schema_mismatch
+    (
+        typed_shared_memory_error,
+        typed_shared_memory_header const & expected,
+        typed_shared_memory_header const & found
+    );
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t bcpp::system::typed_shared_memory<T>::required_size
+(
+    std::size_t count
+)
+{
+    return (data_offset + (count * sizeof(T)));
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::typed_shared_memory<T>::create
+(
+    create_configuration const & config
+) -> typed_shared_memory
+{
+    typed_shared_memory result;
+    result.sharedMemory_ = shared_memory::create(
+            {
+                .path_ = config.path_,
+                .size_ = required_size(config.count_),
+                .ioMode_ = io_mode::read_write,
+                .unlinkPolicy_ = config.unlinkPolicy_
+            },
+            {});
+    if (!result.sharedMemory_.is_valid())
+    {
+        result.error_ = typed_shared_memory_error::open_failed;
+        return result;
+    }
+
+    auto * address = result.sharedMemory_.data();
+    for (std::size_t i = 0; i < config.count_; ++i)
+        new (address + data_offset + (i * sizeof(T))) T{};
+    auto * hdr = new (address) header{};
+    hdr->headerVersion_ = header::version;
+    hdr->schemaVersion_ = schema_version;
+    hdr->schemaHash_ = schema_hash;
+    hdr->size_ = sizeof(T);
+    hdr->alignment_ = alignof(T);
+    hdr->count_ = config.count_;
+    hdr->dataOffset_ = data_offset;
+    auto typeName = schema_name<T>();
+    typeName.copy(hdr->typeName_, std::min(typeName.size(), header::max_type_name_length - 1));
+    // magic is written last so that a joiner never sees a partially initialized segment
+    std::atomic_ref(hdr->magic_).store(header::magic, std::memory_order_release);
+    result.found_ = *hdr;
+    return result;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::typed_shared_memory<T>::join
+(
+    join_configuration const & config
+) -> typed_shared_memory
+{
+    typed_shared_memory result;
+    result.sharedMemory_ = shared_memory::join(
+            {
+                .path_ = config.path_,
+                .ioMode_ = config.ioMode_,
+                .unlinkPolicy_ = config.unlinkPolicy_
+            },
+            {});
+
+    auto & error = result.error_;
+    if (!result.sharedMemory_.is_valid())
+        error = typed_shared_memory_error::open_failed;
+    else if (result.sharedMemory_.size() < sizeof(header))
+        error = typed_shared_memory_error::too_small;
+
+    if (error == typed_shared_memory_error::none)
+    {
+        auto & hdr = *reinterpret_cast<header *>(result.sharedMemory_.data());
+        if (std::atomic_ref(hdr.magic_).load(std::memory_order_acquire) != header::magic)
+            error = typed_shared_memory_error::bad_magic;
+        else
+        {
+            std::memcpy(&result.found_, &hdr, sizeof(header));
+            result.found_.typeName_[header::max_type_name_length - 1] = '\0';
+            if (hdr.headerVersion_ != header::version)
+                error = typed_shared_memory_error::header_version_mismatch;
+            else if (hdr.schemaVersion_ != schema_version)
+                error = typed_shared_memory_error::schema_version_mismatch;
+            else if (hdr.size_ != sizeof(T))
+                error = typed_shared_memory_error::size_mismatch;
+            else if ((hdr.alignment_ != alignof(T)) || (hdr.dataOffset_ != data_offset))
+                error = typed_shared_memory_error::alignment_mismatch;
+            else if (hdr.schemaHash_ != schema_hash)
+                error = typed_shared_memory_error::schema_hash_mismatch;
+            else if (result.sharedMemory_.size() < required_size(hdr.count_))
+                error = typed_shared_memory_error::too_small;
+        }
+    }
+    if (error != typed_shared_memory_error::none)
+        result.sharedMemory_ = {};
+    return result;
+}
+
+
+//=============================================================================
+template <typename T>
+inline bool bcpp::system::typed_shared_memory<T>::is_valid
+(
+) const
+{
+    return sharedMemory_.is_valid();
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::typed_shared_memory<T>::error
+(
+) const -> typed_shared_memory_error
+{
+    return error_;
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::string bcpp::system::typed_shared_memory<T>::error_message
+(
+    // ie: "schema hash mismatch: segment holds 'order' v2 (size 16, align 8, hash 0x..)
+    //      but this build expects 'order' v2 (size 16, align 8, hash 0x..)"
+) const
+{
+    header expected{};
+    expected.schemaVersion_ = schema_version;
+    expected.schemaHash_ = schema_hash;
+    expected.size_ = sizeof(T);
+    expected.alignment_ = alignof(T);
+    auto typeName = schema_name<T>();
+    typeName.copy(expected.typeName_, std::min(typeName.size(), header::max_type_name_length - 1));
+    return describe_schema_mismatch(error_, expected, found_);
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::string bcpp::system::typed_shared_memory<T>::path
+(
+) const
+{
+    return sharedMemory_.path();
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::typed_shared_memory<T>::get_header
+(
+) const -> header const *
+{
+    return is_valid() ? reinterpret_cast<header const *>(sharedMemory_.data()) : nullptr;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::typed_shared_memory<T>::data
+(
+) -> std::span<T>
+{
+    if (!is_valid())
+        return {};
+    return {std::launder(reinterpret_cast<T *>(sharedMemory_.data() + data_offset)), found_.count_};
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::typed_shared_memory<T>::data
+(
+) const -> std::span<T const>
+{
+    if (!is_valid())
+        return {};
+    return {std::launder(reinterpret_cast<T const *>(sharedMemory_.data() + data_offset)), found_.count_};
+}
+
+
+//=============================================================================
+template <typename T>
+inline T & bcpp::system::typed_shared_memory<T>::get
+(
+)
+{
+    return *operator ->();
+}
+
+
+//=============================================================================
+template <typename T>
+inline T const & bcpp::system::typed_shared_memory<T>::get
+(
+) const
+{
+    return *operator ->();
+}
+
+
+//=============================================================================
+template <typename T>
+inline T * bcpp::system::typed_shared_memory<T>::operator ->
+(
+    // nullptr if the segment is invalid or empty
+)
+{
+    auto span = data();
+    return span.empty() ? nullptr : span.data();
+}
+
+
+//=============================================================================
+template <typename T>
+inline T const * bcpp::system::typed_shared_memory<T>::operator ->
+(
+    // nullptr if the segment is invalid or empty
+) const
+{
+    auto span = data();
+    return span.empty() ? nullptr : span.data();
+}
@@ -1,5 +1,12 @@
 #include "./system.h"
 
+#include <bit>
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 
 //==============================================================================
 auto bcpp::system::get_cpu_affinity
@@ -35,3 +42,63 @@ bool bcpp::system::set_cpu_affinity
 
     return false;
 }
+
+
+//==============================================================================
+auto bcpp::system::get_available_cpus
+(
+    // cpus which the calling thread is allowed to run on
+) -> std::vector<cpu_id>
+{
+    std::vector<cpu_id> cpus;
+    #ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0)
+        for (int32_t i = 0; i < CPU_SETSIZE; ++i)
+            if (CPU_ISSET(i, &cpuSet))
+                cpus.push_back(cpu_id(i));
+    #endif
+    return cpus;
+}
+
+
+//==============================================================================
+bool bcpp::system::lock_memory
+(
+    // lock all current and future pages of the process into ram so that
+    // latency sensitive threads never take major faults
+)
+{
+    return (::mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+}
+
+
+//==============================================================================
+auto bcpp::system::get_numa_node
+(
+    // the numa node to which the memory at address is bound (by mbind or by an
+    // anonymous_mapping created with a numaNode_).  empty if the memory follows
+    // the default policy or is bound to more than one node.  does not fault in
+    // the page.
+    void const * address
+) -> std::optional<std::int32_t>
+{
+    std::int32_t mode = 0;
+    unsigned long nodeMask[16] = {};
+    if (::syscall(SYS_get_mempolicy, &mode, nodeMask, sizeof(nodeMask) * 8, address, MPOL_F_ADDR) != 0)
+        return std::nullopt;
+    if ((mode != MPOL_BIND) && (mode != MPOL_PREFERRED))
+        return std::nullopt;
+    std::optional<std::int32_t> numaNode;
+    for (std::size_t i = 0; i < std::size(nodeMask); ++i)
+    {
+        if (nodeMask[i] == 0)
+            continue;
+        if ((numaNode.has_value()) || (std::popcount(nodeMask[i]) != 1))
+            return std::nullopt;
+        numaNode = static_cast<std::int32_t>((i * 64) + std::countr_zero(nodeMask[i]));
+    }
+    return numaNode;
+}
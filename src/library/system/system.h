@@ -1,9 +1,43 @@
 #pragma once
 
 #include "./cpu_id.h"
+#include "./cache_aligned.h"
 #include "./threading/thread_pool.h"
+#include "./threading/static_thread_pool.h"
+#include "./threading/elastic_worker_group.h"
+#include "./threading/spsc_queue.h"
+#include "./threading/parker.h"
+#include "./threading/intrusive_mpsc_queue.h"
+#include "./threading/bounded_mpsc_queue.h"
+#include "./threading/sharded_counter.h"
+#include "./threading/epoch_reclaimer.h"
+#include "./threading/hazard_pointer_domain.h"
+#include "./threading/pipeline.h"
+#include "./threading/parallel_executor.h"
+#include "./threading/parallel_algorithms.h"
 #include "./memory/shared_memory.h"
+#include "./memory/typed_shared_memory.h"
+#include "./memory/segment_registry.h"
 #include "./memory/memory_mapping.h"
+#include "./memory/mapping_registry.h"
+#include "./memory/memory_copy.h"
+#include "./memory/soa_array.h"
+#include "./memory/snapshot.h"
+#include "./memory/dirty_page_tracker.h"
+#include "./memory/page_replication.h"
+#include "./memory/lazy_mapping.h"
+#include "./time/tsc_clock.h"
+#include "./io/reactor.h"
+#include "./io/datagram_socket.h"
+#include "./io/zero_copy_transfer.h"
+#include "./io/zero_copy_sender.h"
+#include "./topology/cpu_topology.h"
+#include "./instrumentation/stats_segment.h"
+#include "./instrumentation/perf_counters.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 
 namespace bcpp::system
@@ -16,4 +50,13 @@ namespace bcpp::system
         cpu_id 
     );
 
+    std::vector<cpu_id> get_available_cpus();
+
+    bool lock_memory();
+
+    std::optional<std::int32_t> get_numa_node
+    (
+        void const *
+    );
+
 } // namespace bcpp::system
\ No newline at end of file
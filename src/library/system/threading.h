@@ -1,4 +1,16 @@
 #pragma once
 
 #include "./threading/thread_pool.h"
+#include "./threading/static_thread_pool.h"
+#include "./threading/elastic_worker_group.h"
+#include "./threading/spsc_queue.h"
+#include "./threading/parker.h"
+#include "./threading/intrusive_mpsc_queue.h"
+#include "./threading/bounded_mpsc_queue.h"
+#include "./threading/sharded_counter.h"
+#include "./threading/epoch_reclaimer.h"
+#include "./threading/hazard_pointer_domain.h"
+#include "./threading/pipeline.h"
+#include "./threading/parallel_executor.h"
+#include "./threading/parallel_algorithms.h"
 
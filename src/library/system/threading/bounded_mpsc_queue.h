@@ -0,0 +1,336 @@
+#pragma once
+
+#include "./parker.h"
+
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stop_token>
+#include <utility>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // bounded_mpsc_queue
+    //
+    // bounded multiple producer single consumer ring (Vyukov).  each slot
+    // carries a sequence number which says whether it is free for the
+    // producer of a given position or full for the consumer of it, so a
+    // producer claims a position with one compare exchange of the tail and
+    // then publishes its slot without touching any other shared line.  a
+    // batch push claims every position of the batch with one compare
+    // exchange.  the consumer reads no shared index at all, only the
+    // sequence of the next slot.
+    //
+    // unlike intrusive_mpsc_queue the queue owns (moves) its elements and
+    // never allocates after construction.  a full queue rejects the push
+    // rather than growing.
+    //
+    // the consumer may wait() (in a thread_pool worker, with the worker's
+    // stop_token) and every push unparks it.
+    //=========================================================================
+    template <typename T>
+    class bounded_mpsc_queue :
+        non_copyable
+    {
+    public:
+
+        using value_type = T;
+
+        explicit bounded_mpsc_queue
+        (
+            std::size_t
+        );
+
+        ~bounded_mpsc_queue();
+
+        // any thread
+        template <typename U>
+        bool try_push
+        (
+            U &&
+        );
+
+        template <typename I>
+        std::size_t push
+        (
+            I,
+            I
+        );
+
+        // consumer only
+        std::optional<T> try_pop();
+
+        template <typename F>
+        std::size_t consume
+        (
+            F &&,
+            std::size_t = std::numeric_limits<std::size_t>::max()
+        );
+
+        bool wait
+        (
+            std::stop_token const &
+        );
+
+        std::size_t size() const noexcept;
+
+        std::size_t capacity() const noexcept;
+
+        bool empty() const noexcept;
+
+    private:
+
+        struct alignas(T) slot
+        {
+            std::atomic<std::size_t>    sequence_;
+            std::byte                   bytes_[sizeof(T)];
+        };
+
+        T * at
+        (
+            std::size_t
+        ) noexcept;
+
+        // producer side
+        alignas(cache_line_size) std::atomic<std::size_t>   tail_{0};
+
+        // consumer side (atomic only so that size() may read it)
+        alignas(cache_line_size) std::atomic<std::size_t>   head_{0};
+
+        // read only after construction
+        alignas(cache_line_size) std::size_t                mask_;
+        std::unique_ptr<slot[]>                             slots_;
+
+        parker                                              parker_;
+
+    }; // class bounded_mpsc_queue
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename T>
+inline bcpp::system::bounded_mpsc_queue<T>::bounded_mpsc_queue
+(
+    // capacity is rounded up to a power of two.  the slot of position p is
+    // free for it while its sequence is p and full while it is p + 1
+    std::size_t capacity
+):
+    mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+    slots_(std::make_unique<slot[]>(mask_ + 1))
+{
+    for (std::size_t i = 0; i <= mask_; ++i)
+        slots_[i].sequence_.store(i, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+template <typename T>
+inline bcpp::system::bounded_mpsc_queue<T>::~bounded_mpsc_queue
+(
+    // destroys whatever the consumer left behind (consume releases each
+    // element as it goes so none is destroyed twice)
+)
+{
+    consume([](T &){});
+}
+
+
+//=============================================================================
+template <typename T>
+inline T * bcpp::system::bounded_mpsc_queue<T>::at
+(
+    std::size_t index
+) noexcept
+{
+    return std::launder(reinterpret_cast<T *>(slots_[index & mask_].bytes_));
+}
+
+
+//=============================================================================
+template <typename T>
+template <typename U>
+inline bool bcpp::system::bounded_mpsc_queue<T>::try_push
+(
+    U && value
+)
+{
+    auto tail = tail_.load(std::memory_order_relaxed);
+    while (true)
+    {
+        auto & s = slots_[tail & mask_];
+        auto difference = static_cast<std::intptr_t>(s.sequence_.load(std::memory_order_acquire) - tail);
+        if (difference < 0)
+            return false;       // the consumer has not yet released the slot from the previous lap
+        if (difference > 0)
+            tail = tail_.load(std::memory_order_relaxed);   // another producer claimed the position
+        else if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+            break;
+    }
+    std::construct_at(at(tail), std::forward<U>(value));
+    slots_[tail & mask_].sequence_.store(tail + 1, std::memory_order_seq_cst);
+    parker_.unpark();
+    return true;
+}
+
+
+//=============================================================================
+template <typename T>
+template <typename I>
+inline std::size_t bcpp::system::bounded_mpsc_queue<T>::push
+(
+    // moves as many elements of [first, last) as fit and returns the number
+    // pushed.  the consumer releases slots in order so the batch fits if the
+    // slot of its last position is free
+    I first,
+    I last
+)
+{
+    auto count = static_cast<std::size_t>(std::distance(first, last));
+    if (count == 0)
+        return 0;
+    if (count > (mask_ + 1))
+        return push(first, std::next(first, mask_ + 1));
+
+    auto tail = tail_.load(std::memory_order_relaxed);
+    while (true)
+    {
+        auto lastPosition = (tail + count - 1);
+        auto difference = static_cast<std::intptr_t>(slots_[lastPosition & mask_].sequence_.load(std::memory_order_acquire) - lastPosition);
+        if (difference < 0)
+        {
+            // the whole batch does not fit.  push what does one at a time
+            std::size_t pushed = 0;
+            for (; (first != last) && (try_push(std::move(*first))); ++first)
+                ++pushed;
+            return pushed;
+        }
+        if (difference > 0)
+            tail = tail_.load(std::memory_order_relaxed);
+        else if (tail_.compare_exchange_weak(tail, tail + count, std::memory_order_relaxed))
+            break;
+    }
+    for (std::size_t i = 0; i < count; ++i, ++first)
+    {
+        std::construct_at(at(tail + i), std::move(*first));
+        slots_[(tail + i) & mask_].sequence_.store(tail + i + 1, std::memory_order_seq_cst);
+    }
+    parker_.unpark();
+    return count;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::bounded_mpsc_queue<T>::try_pop
+(
+) -> std::optional<T>
+{
+    std::optional<T> result;
+    consume([&](T & value){result.emplace(std::move(value));}, 1);
+    return result;
+}
+
+
+//=============================================================================
+template <typename T>
+template <typename F>
+inline std::size_t bcpp::system::bounded_mpsc_queue<T>::consume
+(
+    // invokes function(T &) for up to maximum elements and returns the
+    // number consumed.  stops at the first position which a producer has
+    // claimed but not yet published.  each element is destroyed and its
+    // slot released (and head published) as soon as function returns, or
+    // throws, so an exception consumes the element which raised it and
+    // leaves the queue consistent
+    F && function,
+    std::size_t maximum
+)
+{
+    struct release
+    {
+        ~release()
+        {
+            std::destroy_at(queue_.at(head_));
+            // free for the producer of the same slot on the next lap
+            queue_.slots_[head_ & queue_.mask_].sequence_.store(head_ + queue_.mask_ + 1, std::memory_order_release);
+            queue_.head_.store(head_ + 1, std::memory_order_relaxed);
+        }
+        bounded_mpsc_queue &    queue_;
+        std::size_t             head_;
+    };
+
+    auto head = head_.load(std::memory_order_relaxed);
+    std::size_t count = 0;
+    for (; count < maximum; ++count, ++head)
+    {
+        if (slots_[head & mask_].sequence_.load(std::memory_order_acquire) != (head + 1))
+            break;
+        release guard{*this, head};
+        function(*at(head));
+    }
+    return count;
+}
+
+
+//=============================================================================
+template <typename T>
+inline bool bcpp::system::bounded_mpsc_queue<T>::wait
+(
+    // park until the queue is not empty.  returns false if stop was requested
+    std::stop_token const & stopToken
+)
+{
+    auto head = head_.load(std::memory_order_relaxed);
+    while (slots_[head & mask_].sequence_.load(std::memory_order_seq_cst) != (head + 1))
+        if (!parker_.park(stopToken))
+            return false;
+    return true;
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t bcpp::system::bounded_mpsc_queue<T>::size
+(
+    // approximate when called concurrently with push or consume.  includes
+    // positions claimed but not yet published
+) const noexcept
+{
+    auto head = head_.load(std::memory_order_acquire);
+    auto tail = tail_.load(std::memory_order_acquire);
+    return ((tail > head) ? (tail - head) : 0);
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t bcpp::system::bounded_mpsc_queue<T>::capacity
+(
+) const noexcept
+{
+    return (mask_ + 1);
+}
+
+
+//=============================================================================
+template <typename T>
+inline bool bcpp::system::bounded_mpsc_queue<T>::empty
+(
+) const noexcept
+{
+    return (size() == 0);
+}
@@ -0,0 +1,145 @@
+#include "./elastic_worker_group.h"
+
+#include <algorithm>
+#include <condition_variable>
+
+
+//=============================================================================
+bcpp::system::elastic_worker_group::elastic_worker_group
+(
+    thread_pool & threadPool,
+    configuration const & config
+):
+    threadPool_(threadPool),
+    configuration_(config)
+{
+    configuration_.workerConfiguration_.cpuId_ = std::nullopt;
+    configuration_.maximumThreads_ = std::max(configuration_.minimumThreads_, configuration_.maximumThreads_);
+    configuration_.scaleUpThreshold_ = std::max<std::size_t>(configuration_.scaleUpThreshold_, 1);
+
+    for (std::size_t i = 0; i < configuration_.minimumThreads_; ++i)
+        grow();
+
+    if ((configuration_.queueDepth_) && (configuration_.maximumThreads_ > configuration_.minimumThreads_))
+    {
+        auto monitorConfiguration = configuration_.monitorConfiguration_;
+        monitorConfiguration.function_ = [this](std::stop_token const & stopToken){monitor(stopToken);};
+        monitorId_ = threadPool_.add_thread(monitorConfiguration).value_or(std::numeric_limits<thread_pool::thread_id>::max());
+    }
+    else
+    {
+        monitorId_ = std::numeric_limits<thread_pool::thread_id>::max();
+    }
+}
+
+
+//=============================================================================
+bcpp::system::elastic_worker_group::~elastic_worker_group
+(
+)
+{
+    stop();
+}
+
+
+//=============================================================================
+void bcpp::system::elastic_worker_group::stop
+(
+    // stop the monitor first (so that it no longer refers to this group)
+    // and then the group's workers.  blocks until all have exited
+)
+{
+    threadPool_.remove_thread(monitorId_, synchronization_mode::blocking);
+    std::vector<thread_pool::thread_id> workerIds;
+    {
+        std::lock_guard lockGuard(mutex_);
+        std::swap(workerIds, workerIds_);
+    }
+    for (auto workerId : workerIds)
+        threadPool_.remove_thread(workerId, synchronization_mode::non_blocking);
+    for (auto workerId : workerIds)
+        threadPool_.remove_thread(workerId, synchronization_mode::blocking);
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::elastic_worker_group::size
+(
+) const
+{
+    std::lock_guard lockGuard(mutex_);
+    return workerIds_.size();
+}
+
+
+//=============================================================================
+void bcpp::system::elastic_worker_group::grow
+(
+)
+{
+    // nothing is recorded if the pool has been stopped
+    std::lock_guard lockGuard(mutex_);
+    if (auto workerId = threadPool_.add_thread(configuration_.workerConfiguration_); workerId.has_value())
+        workerIds_.push_back(*workerId);
+}
+
+
+//=============================================================================
+void bcpp::system::elastic_worker_group::shrink
+(
+    // remove the most recently added worker.  non blocking so that the
+    // monitor keeps sampling while the worker finishes its current work
+)
+{
+    thread_pool::thread_id workerId;
+    {
+        std::lock_guard lockGuard(mutex_);
+        if (workerIds_.empty())
+            return;
+        workerId = workerIds_.back();
+        workerIds_.pop_back();
+    }
+    threadPool_.remove_thread(workerId, synchronization_mode::non_blocking);
+}
+
+
+//=============================================================================
+void bcpp::system::elastic_worker_group::monitor
+(
+    std::stop_token const & stopToken
+)
+{
+    std::mutex mutex;
+    std::condition_variable_any conditionVariable;
+    std::unique_lock uniqueLock(mutex);
+
+    auto belowThresholdSince = std::chrono::steady_clock::time_point::max();
+    while (!conditionVariable.wait_for(uniqueLock, stopToken, configuration_.sampleInterval_, [&](){return stopToken.stop_requested();}))
+    {
+        auto workerCount = std::max<std::size_t>(size(), 1);
+        auto depthPerWorker = configuration_.queueDepth_() / workerCount;
+        auto now = std::chrono::steady_clock::now();
+
+        if (depthPerWorker >= configuration_.scaleUpThreshold_)
+        {
+            belowThresholdSince = std::chrono::steady_clock::time_point::max();
+            if (size() < configuration_.maximumThreads_)
+                grow();
+        }
+        else if (depthPerWorker < configuration_.scaleDownThreshold_)
+        {
+            // hysteresis: shrink only after load has stayed low for scaleDownDelay_
+            if (belowThresholdSince == std::chrono::steady_clock::time_point::max())
+                belowThresholdSince = now;
+            if (((now - belowThresholdSince) >= configuration_.scaleDownDelay_) && (size() > configuration_.minimumThreads_))
+            {
+                shrink();
+                belowThresholdSince = now;
+            }
+        }
+        else
+        {
+            belowThresholdSince = std::chrono::steady_clock::time_point::max();
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "./thread_pool.h"
+
+#include <include/non_copyable.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // elastic_worker_group
+    //
+    // a group of non pinned workers within a thread_pool which grows and
+    // shrinks with load.  a monitor (itself a worker of the pool) samples
+    // the queue depth and adds a worker while the depth per worker exceeds
+    // scaleUpThreshold_ and removes one once the depth per worker has stayed
+    // below scaleDownThreshold_ for scaleDownDelay_.  other (pinned) workers
+    // of the pool are never touched.
+    //=========================================================================
+    class elastic_worker_group :
+        non_copyable
+    {
+    public:
+
+        struct configuration
+        {
+            // template for each worker.  cpuId_ is ignored - elastic workers are never pinned
+            thread_pool::thread_configuration       workerConfiguration_;
+            std::size_t                             minimumThreads_{1};
+            std::size_t                             maximumThreads_{1};
+            std::function<std::size_t()>            queueDepth_;
+            std::size_t                             scaleUpThreshold_{4};
+            std::size_t                             scaleDownThreshold_{1};
+            std::chrono::nanoseconds                sampleInterval_{std::chrono::milliseconds(10)};
+            std::chrono::nanoseconds                scaleDownDelay_{std::chrono::milliseconds(500)};
+            thread_pool::thread_configuration       monitorConfiguration_;
+        };
+
+        elastic_worker_group
+        (
+            thread_pool &,
+            configuration const &
+        );
+
+        ~elastic_worker_group();
+
+        std::size_t size() const;
+
+        void stop();
+
+    private:
+
+        void monitor
+        (
+            std::stop_token const &
+        );
+
+        void grow();
+
+        void shrink();
+
+        thread_pool &                           threadPool_;
+
+        configuration                           configuration_;
+
+        mutable std::mutex                      mutex_;
+
+        std::vector<thread_pool::thread_id>     workerIds_;
+
+        thread_pool::thread_id                  monitorId_;
+    };
+
+} // namespace bcpp::system
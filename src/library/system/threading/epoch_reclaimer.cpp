@@ -0,0 +1,249 @@
+#include "./epoch_reclaimer.h"
+
+#include <algorithm>
+#include <utility>
+
+
+//=============================================================================
+bcpp::system::epoch_reclaimer::guard::guard
+(
+    thread_record * threadRecord
+):
+    threadRecord_(threadRecord)
+{
+}
+
+
+//=============================================================================
+bcpp::system::epoch_reclaimer::guard::guard
+(
+    guard && other
+):
+    threadRecord_(std::exchange(other.threadRecord_, nullptr))
+{
+}
+
+
+//=============================================================================
+auto bcpp::system::epoch_reclaimer::guard::operator =
+(
+    guard && other
+) -> guard &
+{
+    if (this != &other)
+    {
+        reset();
+        threadRecord_ = std::exchange(other.threadRecord_, nullptr);
+    }
+    return *this;
+}
+
+
+//=============================================================================
+bcpp::system::epoch_reclaimer::guard::~guard
+(
+)
+{
+    reset();
+}
+
+
+//=============================================================================
+void bcpp::system::epoch_reclaimer::guard::reset
+(
+    // leave the critical section
+)
+{
+    if (threadRecord_ == nullptr)
+        return;
+    if (--threadRecord_->nesting_ == 0)
+        threadRecord_->state_.store(0, std::memory_order_release);
+    threadRecord_ = nullptr;
+}
+
+
+//=============================================================================
+bcpp::system::epoch_reclaimer::epoch_reclaimer
+(
+):
+    epoch_reclaimer(configuration{})
+{
+}
+
+
+//=============================================================================
+bcpp::system::epoch_reclaimer::epoch_reclaimer
+(
+    configuration const & config
+):
+    configuration_(config),
+    threads_(
+            {
+                .create_ = [](){return new thread_record;},
+                .release_ = [](thread_record & threadRecord)
+                        {
+                            threadRecord.retireCount_ = 0;
+                            threadRecord.nesting_ = 0;
+                            threadRecord.state_.store(0, std::memory_order_release);
+                        }
+            })
+{
+    configuration_.reclaimBatchSize_ = std::max<std::size_t>(configuration_.reclaimBatchSize_, 1);
+}
+
+
+//=============================================================================
+void bcpp::system::epoch_reclaimer::register_thread
+(
+)
+{
+    threads_.get();
+}
+
+
+//=============================================================================
+void bcpp::system::epoch_reclaimer::unregister_thread
+(
+    // hand the thread's retired nodes to the other threads and release its record
+)
+{
+    threads_.unregister_thread();
+}
+
+
+//=============================================================================
+auto bcpp::system::epoch_reclaimer::attach
+(
+    thread_pool::thread_configuration threadConfiguration
+) -> thread_pool::thread_configuration
+{
+    return threads_.attach(std::move(threadConfiguration));
+}
+
+
+//=============================================================================
+auto bcpp::system::epoch_reclaimer::enter
+(
+) -> guard
+{
+    auto & threadRecord = threads_.get();
+    if (threadRecord.nesting_++ == 0)
+    {
+        // announce the epoch before any shared node is read.  an announced
+        // epoch which is already stale only delays the next advance
+        threadRecord.state_.store((epoch_.load(std::memory_order_relaxed) << 1) | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    return guard(&threadRecord);
+}
+
+
+//=============================================================================
+void bcpp::system::epoch_reclaimer::retire
+(
+    // the node must already be unreachable by any thread which is not
+    // currently within a critical section
+    void * node,
+    deleter nodeDeleter
+)
+{
+    auto & threadRecord = threads_.get();
+    threadRecord.retired_.push_back({.node_ = node, .deleter_ = nodeDeleter, .epoch_ = epoch_.load(std::memory_order_seq_cst)});
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    if (++threadRecord.retireCount_ >= configuration_.reclaimBatchSize_)
+    {
+        threadRecord.retireCount_ = 0;
+        reclaim();
+    }
+}
+
+
+//=============================================================================
+void bcpp::system::epoch_reclaimer::quiescent
+(
+)
+{
+    auto & threadRecord = threads_.get();
+    if ((!threadRecord.retired_.empty()) || (threads_.has_orphans()))
+        reclaim();
+}
+
+
+//=============================================================================
+bool bcpp::system::epoch_reclaimer::try_advance
+(
+    // the epoch advances once every thread within a critical section has
+    // announced the current epoch
+)
+{
+    auto epoch = epoch_.load(std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (auto * threadRecord = threads_.front(); threadRecord != nullptr; threadRecord = threadRecord->next_)
+    {
+        auto state = threadRecord->state_.load(std::memory_order_acquire);
+        if (((state & 1) != 0) && ((state >> 1) != epoch))
+            return false;
+    }
+    // fails only if another thread advanced it first
+    epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+    return true;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::epoch_reclaimer::reclaim
+(
+)
+{
+    auto & threadRecord = threads_.get();
+    try_advance();
+    auto reclaimed = reclaim(threadRecord.retired_);
+    return reclaimed + threads_.reclaim_orphans([this](std::vector<retired_node> & orphans){return reclaim(orphans);});
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::epoch_reclaimer::reclaim
+(
+    // delete the nodes retired at least two epochs ago and keep the rest.
+    // deleters are called on a detached list as they may retire nodes too
+    std::vector<retired_node> & retiredNodes
+)
+{
+    auto epoch = epoch_.load(std::memory_order_acquire);
+    std::vector<retired_node> candidates;
+    std::swap(candidates, retiredNodes);
+    std::size_t reclaimed = 0;
+    for (auto const & retiredNode : candidates)
+    {
+        if ((retiredNode.epoch_ + 2) <= epoch)
+        {
+            retiredNode.deleter_(retiredNode.node_);
+            ++reclaimed;
+        }
+        else
+        {
+            retiredNodes.push_back(retiredNode);
+        }
+    }
+    pending_.fetch_sub(reclaimed, std::memory_order_relaxed);
+    return reclaimed;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::epoch_reclaimer::pending
+(
+) const
+{
+    return pending_.load(std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+std::uint64_t bcpp::system::epoch_reclaimer::epoch
+(
+) const
+{
+    return epoch_.load(std::memory_order_acquire);
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "./thread_pool.h"
+#include "./thread_registry.h"
+
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // epoch_reclaimer
+    //
+    // epoch based reclamation for lock free structures.  a reader enters a
+    // critical section (enter() returns a guard) for the duration of its
+    // access to shared nodes and never blocks.  a writer which unlinks a
+    // node retire()s it rather than deleting it and the node is deleted
+    // once every thread which was in a critical section when it was retired
+    // has left it.
+    //
+    // the reclaimer keeps a global epoch which advances once every thread
+    // within a critical section has observed the current epoch.  a node
+    // retired in epoch e is deleted once the epoch reaches e + 2.  retired
+    // nodes are kept per thread and reclaimed in batches (every
+    // reclaimBatchSize_ retirements) so that the cost of scanning the
+    // threads is amortized.  a thread which stays within a critical section
+    // stalls the epoch (and so reclamation) for every thread.  see
+    // hazard_pointer_domain where that is not acceptable.
+    //
+    // threads register on first use and are unregistered as they exit (see
+    // thread_registry).  attach() adds registration to the handlers of a
+    // thread_pool worker so that a worker's retired nodes are handed on (and
+    // reclaimed by other threads) when it stops.  a worker which is idle should call
+    // quiescent() (ie: from pipeline's idleHandler_) so that its retired
+    // nodes are reclaimed even when it retires nothing further.
+    //
+    // the reclaimer must outlive every structure which retires to it.  the
+    // destructor deletes every node still retired.
+    //=========================================================================
+    class epoch_reclaimer :
+        non_copyable
+    {
+    public:
+
+        using deleter = void(*)(void *);
+
+        struct configuration
+        {
+            std::size_t     reclaimBatchSize_{64};      // retirements per thread between reclaims
+        };
+
+    private:
+
+        struct retired_node
+        {
+            void *          node_;
+            deleter         deleter_;
+            std::uint64_t   epoch_;
+        };
+
+        struct alignas(cache_line_size) thread_record
+        {
+            // (epoch << 1) | 1 while in a critical section, zero otherwise
+            std::atomic<std::uint64_t>  state_{0};
+            std::atomic<bool>           inUse_{false};
+            thread_record *             next_{nullptr};
+            // owned by the registered thread
+            std::size_t                 nesting_{0};
+            std::size_t                 retireCount_{0};
+            std::vector<retired_node>   retired_;
+        };
+
+    public:
+
+        class guard :
+            non_copyable
+        {
+        public:
+
+            guard() = default;
+
+            guard(guard &&);
+
+            guard & operator = (guard &&);
+
+            ~guard();
+
+            void reset();
+
+        private:
+
+            friend class epoch_reclaimer;
+
+            guard
+            (
+                thread_record *
+            );
+
+            thread_record * threadRecord_{nullptr};
+        };
+
+        epoch_reclaimer();
+
+        explicit epoch_reclaimer
+        (
+            configuration const &
+        );
+
+        ~epoch_reclaimer() = default;
+
+        // register (or unregister) the calling thread
+        void register_thread();
+
+        void unregister_thread();
+
+        // the worker with registration added to its handlers
+        thread_pool::thread_configuration attach
+        (
+            thread_pool::thread_configuration
+        );
+
+        // critical sections may nest
+        guard enter();
+
+        void retire
+        (
+            void *,
+            deleter
+        );
+
+        template <typename T>
+        void retire
+        (
+            T *
+        );
+
+        // reclaim the calling thread's retired nodes if any are pending
+        void quiescent();
+
+        // advance the epoch if possible and delete the calling thread's (and
+        // exited threads') retired nodes which are safe to delete.  returns
+        // the number deleted
+        std::size_t reclaim();
+
+        // nodes retired and not yet deleted (by every thread)
+        std::size_t pending() const;
+
+        std::uint64_t epoch() const;
+
+    private:
+
+        bool try_advance();
+
+        std::size_t reclaim
+        (
+            std::vector<retired_node> &
+        );
+
+        configuration                   configuration_;
+
+        alignas(cache_line_size) std::atomic<std::uint64_t> epoch_{1};
+
+        std::atomic<std::size_t>        pending_{0};
+
+        thread_registry<thread_record, retired_node>    threads_;
+
+    }; // class epoch_reclaimer
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename T>
+inline void bcpp::system::epoch_reclaimer::retire
+(
+    T * node
+)
+{
+    retire(node, [](void * node){delete static_cast<T *>(node);});
+}
@@ -0,0 +1,258 @@
+#include "./hazard_pointer_domain.h"
+
+#include <algorithm>
+#include <utility>
+
+
+//=============================================================================
+bcpp::system::hazard_pointer_domain::hazard_pointer::hazard_pointer
+(
+    thread_record * threadRecord,
+    std::size_t index
+):
+    threadRecord_(threadRecord),
+    index_(index)
+{
+}
+
+
+//=============================================================================
+bcpp::system::hazard_pointer_domain::hazard_pointer::hazard_pointer
+(
+    hazard_pointer && other
+):
+    threadRecord_(std::exchange(other.threadRecord_, nullptr)),
+    index_(other.index_)
+{
+}
+
+
+//=============================================================================
+auto bcpp::system::hazard_pointer_domain::hazard_pointer::operator =
+(
+    hazard_pointer && other
+) -> hazard_pointer &
+{
+    if (this != &other)
+    {
+        release();
+        threadRecord_ = std::exchange(other.threadRecord_, nullptr);
+        index_ = other.index_;
+    }
+    return *this;
+}
+
+
+//=============================================================================
+bcpp::system::hazard_pointer_domain::hazard_pointer::~hazard_pointer
+(
+)
+{
+    release();
+}
+
+
+//=============================================================================
+bool bcpp::system::hazard_pointer_domain::hazard_pointer::is_valid
+(
+) const
+{
+    return (threadRecord_ != nullptr);
+}
+
+
+//=============================================================================
+void bcpp::system::hazard_pointer_domain::hazard_pointer::reset
+(
+)
+{
+    if (threadRecord_ != nullptr)
+        threadRecord_->hazards_[index_].store(nullptr, std::memory_order_release);
+}
+
+
+//=============================================================================
+void bcpp::system::hazard_pointer_domain::hazard_pointer::release
+(
+    // clear the hazard and return it to the thread
+)
+{
+    if (threadRecord_ == nullptr)
+        return;
+    reset();
+    threadRecord_->held_[index_] = false;
+    threadRecord_ = nullptr;
+}
+
+
+//=============================================================================
+bcpp::system::hazard_pointer_domain::hazard_pointer_domain
+(
+):
+    hazard_pointer_domain(configuration{})
+{
+}
+
+
+//=============================================================================
+bcpp::system::hazard_pointer_domain::hazard_pointer_domain
+(
+    configuration const & config
+):
+    configuration_(config),
+    threads_(
+            {
+                .create_ = [this]()
+                        {
+                            auto * threadRecord = new thread_record;
+                            threadRecord->hazards_ = std::make_unique<std::atomic<void const *>[]>(configuration_.hazardsPerThread_);
+                            for (std::size_t i = 0; i < configuration_.hazardsPerThread_; ++i)
+                                threadRecord->hazards_[i].store(nullptr, std::memory_order_relaxed);
+                            threadRecord->held_.assign(configuration_.hazardsPerThread_, false);
+                            return threadRecord;
+                        },
+                // the thread's hazard pointers must already be destroyed
+                .release_ = [this](thread_record & threadRecord)
+                        {
+                            for (std::size_t i = 0; i < configuration_.hazardsPerThread_; ++i)
+                                threadRecord.hazards_[i].store(nullptr, std::memory_order_release);
+                            threadRecord.held_.assign(configuration_.hazardsPerThread_, false);
+                        }
+            })
+{
+    configuration_.hazardsPerThread_ = std::max<std::size_t>(configuration_.hazardsPerThread_, 1);
+    configuration_.reclaimThreshold_ = std::max<std::size_t>(configuration_.reclaimThreshold_, 1);
+}
+
+
+//=============================================================================
+void bcpp::system::hazard_pointer_domain::register_thread
+(
+)
+{
+    threads_.get();
+}
+
+
+//=============================================================================
+void bcpp::system::hazard_pointer_domain::unregister_thread
+(
+    // hand the thread's retired nodes to the other threads and release its
+    // record.  the thread's hazard pointers must already be destroyed
+)
+{
+    threads_.unregister_thread();
+}
+
+
+//=============================================================================
+auto bcpp::system::hazard_pointer_domain::attach
+(
+    thread_pool::thread_configuration threadConfiguration
+) -> thread_pool::thread_configuration
+{
+    return threads_.attach(std::move(threadConfiguration));
+}
+
+
+//=============================================================================
+auto bcpp::system::hazard_pointer_domain::make_hazard_pointer
+(
+) -> hazard_pointer
+{
+    auto & threadRecord = threads_.get();
+    auto iter = std::find(threadRecord.held_.begin(), threadRecord.held_.end(), false);
+    if (iter == threadRecord.held_.end())
+        return {};
+    *iter = true;
+    return hazard_pointer(&threadRecord, static_cast<std::size_t>(iter - threadRecord.held_.begin()));
+}
+
+
+//=============================================================================
+void bcpp::system::hazard_pointer_domain::retire
+(
+    // the node must already be unreachable from the shared structure
+    void * node,
+    deleter nodeDeleter
+)
+{
+    auto & threadRecord = threads_.get();
+    threadRecord.retired_.push_back({.node_ = node, .deleter_ = nodeDeleter});
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    // scanning less often than there are hazards can not amortize the scan
+    auto threshold = std::max(configuration_.reclaimThreshold_,
+            2 * configuration_.hazardsPerThread_ * threads_.size());
+    if (threadRecord.retired_.size() >= threshold)
+        reclaim();
+}
+
+
+//=============================================================================
+void bcpp::system::hazard_pointer_domain::quiescent
+(
+)
+{
+    auto & threadRecord = threads_.get();
+    if ((!threadRecord.retired_.empty()) || (threads_.has_orphans()))
+        reclaim();
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::hazard_pointer_domain::reclaim
+(
+)
+{
+    auto & threadRecord = threads_.get();
+
+    // every published hazard (ordered after the unlinking of the retired nodes)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::vector<void const *> hazards;
+    for (auto * record = threads_.front(); record != nullptr; record = record->next_)
+        for (std::size_t i = 0; i < configuration_.hazardsPerThread_; ++i)
+            if (auto * hazard = record->hazards_[i].load(std::memory_order_seq_cst); hazard != nullptr)
+                hazards.push_back(hazard);
+    std::sort(hazards.begin(), hazards.end());
+
+    auto reclaimed = reclaim(threadRecord.retired_, hazards);
+    return reclaimed + threads_.reclaim_orphans([&](std::vector<retired_node> & orphans){return reclaim(orphans, hazards);});
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::hazard_pointer_domain::reclaim
+(
+    // delete the nodes which are not hazards and keep the rest.  deleters
+    // are called on a detached list as they may retire nodes too
+    std::vector<retired_node> & retiredNodes,
+    std::vector<void const *> const & hazards
+)
+{
+    std::vector<retired_node> candidates;
+    std::swap(candidates, retiredNodes);
+    std::size_t reclaimed = 0;
+    for (auto const & retiredNode : candidates)
+    {
+        if (std::binary_search(hazards.begin(), hazards.end(), static_cast<void const *>(retiredNode.node_)))
+        {
+            retiredNodes.push_back(retiredNode);
+        }
+        else
+        {
+            retiredNode.deleter_(retiredNode.node_);
+            ++reclaimed;
+        }
+    }
+    pending_.fetch_sub(reclaimed, std::memory_order_relaxed);
+    return reclaimed;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::hazard_pointer_domain::pending
+(
+) const
+{
+    return pending_.load(std::memory_order_relaxed);
+}
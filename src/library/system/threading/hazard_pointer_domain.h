@@ -0,0 +1,205 @@
+#pragma once
+
+#include "./thread_pool.h"
+#include "./thread_registry.h"
+
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // hazard_pointer_domain
+    //
+    // hazard pointer reclamation for lock free structures.  a reader
+    // publishes each node it is about to access in a hazard_pointer
+    // (protect()) and a retired node is deleted only once no hazard pointer
+    // refers to it.  unlike epoch_reclaimer a stalled reader holds back only
+    // the nodes it protects so the number of nodes which are retired but
+    // not deleted is bounded (by reclaimThreshold_ per thread plus the
+    // number of hazard pointers) however long a reader takes.  the price is
+    // a store and a full fence for every node a reader visits.
+    //
+    // each thread has hazardsPerThread_ hazard pointers.  retired nodes are
+    // kept per thread and a thread scans the hazard pointers of every
+    // thread once it has retired reclaimThreshold_ nodes (or twice the
+    // number of hazard pointers if that is greater).
+    //
+    // registration of threads is as for epoch_reclaimer (including
+    // attach() and quiescent()).
+    //=========================================================================
+    class hazard_pointer_domain :
+        non_copyable
+    {
+    public:
+
+        using deleter = void(*)(void *);
+
+        struct configuration
+        {
+            std::size_t     hazardsPerThread_{4};
+            std::size_t     reclaimThreshold_{64};
+        };
+
+    private:
+
+        struct retired_node
+        {
+            void *          node_;
+            deleter         deleter_;
+        };
+
+        struct alignas(cache_line_size) thread_record
+        {
+            std::unique_ptr<std::atomic<void const *>[]>    hazards_;
+            std::atomic<bool>                               inUse_{false};
+            thread_record *                                 next_{nullptr};
+            // owned by the registered thread
+            std::vector<bool>                               held_;
+            std::vector<retired_node>                       retired_;
+        };
+
+    public:
+
+        class hazard_pointer :
+            non_copyable
+        {
+        public:
+
+            hazard_pointer() = default;
+
+            hazard_pointer(hazard_pointer &&);
+
+            hazard_pointer & operator = (hazard_pointer &&);
+
+            ~hazard_pointer();
+
+            // false if every hazard pointer of the thread was already held
+            bool is_valid() const;
+
+            // load the source and publish it.  the returned node (if any) may
+            // be accessed until the hazard pointer is reset or protects another
+            template <typename T>
+            T * protect
+            (
+                std::atomic<T *> const &
+            );
+
+            void reset();
+
+        private:
+
+            friend class hazard_pointer_domain;
+
+            hazard_pointer
+            (
+                thread_record *,
+                std::size_t
+            );
+
+            void release();
+
+            thread_record *     threadRecord_{nullptr};
+            std::size_t         index_{0};
+        };
+
+        hazard_pointer_domain();
+
+        explicit hazard_pointer_domain
+        (
+            configuration const &
+        );
+
+        ~hazard_pointer_domain() = default;
+
+        void register_thread();
+
+        void unregister_thread();
+
+        thread_pool::thread_configuration attach
+        (
+            thread_pool::thread_configuration
+        );
+
+        // one of the calling thread's hazard pointers.  must be destroyed by the same thread
+        hazard_pointer make_hazard_pointer();
+
+        void retire
+        (
+            void *,
+            deleter
+        );
+
+        template <typename T>
+        void retire
+        (
+            T *
+        );
+
+        void quiescent();
+
+        // delete the retired nodes of the calling thread (and of exited
+        // threads) which no hazard pointer protects.  returns the number deleted
+        std::size_t reclaim();
+
+        std::size_t pending() const;
+
+    private:
+
+        std::size_t reclaim
+        (
+            std::vector<retired_node> &,
+            std::vector<void const *> const &
+        );
+
+        configuration                   configuration_;
+
+        std::atomic<std::size_t>        pending_{0};
+
+        thread_registry<thread_record, retired_node>    threads_;
+
+    }; // class hazard_pointer_domain
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename T>
+inline T * bcpp::system::hazard_pointer_domain::hazard_pointer::protect
+(
+    // publish then confirm that the source still refers to the node.  if it
+    // does the node can not have been retired before it was published
+    std::atomic<T *> const & source
+)
+{
+    auto & hazard = threadRecord_->hazards_[index_];
+    auto * node = source.load(std::memory_order_relaxed);
+    while (true)
+    {
+        hazard.store(node, std::memory_order_seq_cst);
+        auto * current = source.load(std::memory_order_seq_cst);
+        if (current == node)
+            return node;
+        node = current;
+    }
+}
+
+
+//=============================================================================
+template <typename T>
+inline void bcpp::system::hazard_pointer_domain::retire
+(
+    T * node
+)
+{
+    retire(node, [](void * node){delete static_cast<T *>(node);});
+}
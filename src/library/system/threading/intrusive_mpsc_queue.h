@@ -0,0 +1,245 @@
+#pragma once
+
+#include "./parker.h"
+
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <stop_token>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // mpsc_queue_node
+    //
+    // base of the elements of an intrusive_mpsc_queue.  copying a node does
+    // not copy its link
+    //=========================================================================
+    struct mpsc_queue_node
+    {
+        mpsc_queue_node() = default;
+
+        mpsc_queue_node
+        (
+            mpsc_queue_node const &
+        )
+        {
+        }
+
+        mpsc_queue_node & operator =
+        (
+            mpsc_queue_node const &
+        )
+        {
+            return *this;
+        }
+
+        std::atomic<mpsc_queue_node *>  next_{nullptr};
+    };
+
+
+    //=========================================================================
+    // intrusive_mpsc_queue
+    //
+    // unbounded multiple producer single consumer queue of nodes owned by the
+    // caller (Vyukov).  push() is wait free: a single exchange of the head
+    // followed by a store which links the previous node, so producers never
+    // wait for one another or for the consumer.  a push which has exchanged
+    // the head but not yet linked is invisible to the consumer (pop()
+    // returns nothing) until the link is stored, which is a matter of
+    // instructions.
+    //
+    // the queue never allocates.  a node belongs to the queue from push()
+    // until the consumer pops (or consumes) it and may then be reused.
+    //
+    // the consumer may wait() (in a thread_pool worker, with the worker's
+    // stop_token) and every push() unparks it.
+    //=========================================================================
+    template <typename T>
+    requires std::derived_from<T, mpsc_queue_node>
+    class intrusive_mpsc_queue :
+        non_copyable
+    {
+    public:
+
+        using value_type = T;
+
+        intrusive_mpsc_queue();
+
+        // any thread
+        void push
+        (
+            T *
+        );
+
+        // consumer only
+        T * pop();
+
+        template <typename F>
+        std::size_t consume
+        (
+            F &&,
+            std::size_t = std::numeric_limits<std::size_t>::max()
+        );
+
+        bool wait
+        (
+            std::stop_token const &
+        );
+
+        // approximate when called concurrently with push
+        bool empty() const;
+
+    private:
+
+        void push_node
+        (
+            mpsc_queue_node *
+        );
+
+        // producer side
+        alignas(cache_line_size) std::atomic<mpsc_queue_node *> head_;
+
+        // consumer side
+        alignas(cache_line_size) mpsc_queue_node *              tail_;
+        mpsc_queue_node                                         stub_;
+
+        parker                                                  parker_;
+
+    }; // class intrusive_mpsc_queue
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename T>
+requires std::derived_from<T, bcpp::system::mpsc_queue_node>
+inline bcpp::system::intrusive_mpsc_queue<T>::intrusive_mpsc_queue
+(
+):
+    head_(&stub_),
+    tail_(&stub_)
+{
+}
+
+
+//=============================================================================
+template <typename T>
+requires std::derived_from<T, bcpp::system::mpsc_queue_node>
+inline void bcpp::system::intrusive_mpsc_queue<T>::push_node
+(
+    mpsc_queue_node * node
+)
+{
+    node->next_.store(nullptr, std::memory_order_relaxed);
+    // seq_cst (with the parker) so that a consumer about to park sees this node or is unparked
+    auto * previous = head_.exchange(node, std::memory_order_seq_cst);
+    previous->next_.store(node, std::memory_order_release);
+}
+
+
+//=============================================================================
+template <typename T>
+requires std::derived_from<T, bcpp::system::mpsc_queue_node>
+inline void bcpp::system::intrusive_mpsc_queue<T>::push
+(
+    T * value
+)
+{
+    push_node(value);
+    parker_.unpark();
+}
+
+
+//=============================================================================
+template <typename T>
+requires std::derived_from<T, bcpp::system::mpsc_queue_node>
+inline T * bcpp::system::intrusive_mpsc_queue<T>::pop
+(
+    // nullptr if the queue is empty (or the next node is not yet linked)
+)
+{
+    auto * tail = tail_;
+    auto * next = tail->next_.load(std::memory_order_acquire);
+    if (tail == &stub_)
+    {
+        // the stub is skipped
+        if (next == nullptr)
+            return nullptr;
+        tail_ = tail = next;
+        next = next->next_.load(std::memory_order_acquire);
+    }
+    if (next != nullptr)
+    {
+        tail_ = next;
+        return static_cast<T *>(tail);
+    }
+    // tail is the last linked node.  unless a producer is between its
+    // exchange and its link, re-insert the stub behind it so it can be popped
+    if (tail != head_.load(std::memory_order_acquire))
+        return nullptr;
+    push_node(&stub_);
+    next = tail->next_.load(std::memory_order_acquire);
+    if (next == nullptr)
+        return nullptr;
+    tail_ = next;
+    return static_cast<T *>(tail);
+}
+
+
+//=============================================================================
+template <typename T>
+requires std::derived_from<T, bcpp::system::mpsc_queue_node>
+template <typename F>
+inline std::size_t bcpp::system::intrusive_mpsc_queue<T>::consume
+(
+    // invokes function(T *) for up to maximum nodes and returns the number
+    // consumed.  the node belongs to the function
+    F && function,
+    std::size_t maximum
+)
+{
+    std::size_t count = 0;
+    for (; count < maximum; ++count)
+    {
+        auto * value = pop();
+        if (value == nullptr)
+            break;
+        function(value);
+    }
+    return count;
+}
+
+
+//=============================================================================
+template <typename T>
+requires std::derived_from<T, bcpp::system::mpsc_queue_node>
+inline bool bcpp::system::intrusive_mpsc_queue<T>::wait
+(
+    // park until the queue is not empty.  returns false if stop was requested
+    std::stop_token const & stopToken
+)
+{
+    while (empty())
+        if (!parker_.park(stopToken))
+            return false;
+    return true;
+}
+
+
+//=============================================================================
+template <typename T>
+requires std::derived_from<T, bcpp::system::mpsc_queue_node>
+inline bool bcpp::system::intrusive_mpsc_queue<T>::empty
+(
+) const
+{
+    // the stub is the tail only once every node before it has been popped
+    return ((tail_ == &stub_) && (head_.load(std::memory_order_seq_cst) == &stub_));
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include "./parallel_executor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+
+//=============================================================================
+// parallel algorithms which run on the workers of a parallel_executor rather
+// than on threads created by the standard library's backend.  ranges are
+// split into chunks sized by parallel_executor::chunk_size.  if the input of
+// an algorithm is numa bound memory (ie: an anonymous_mapping created with a
+// numaNode_) the work runs only on the executor's workers on that node.
+//=============================================================================
+namespace bcpp::system::parallel
+{
+
+    template <std::random_access_iterator I, typename F>
+    void for_each
+    (
+        parallel_executor &,
+        I,
+        I,
+        F
+    );
+
+    template <std::random_access_iterator I, std::random_access_iterator O, typename F>
+    O transform
+    (
+        parallel_executor &,
+        I,
+        I,
+        O,
+        F
+    );
+
+    template <std::random_access_iterator I, typename T, typename F = std::plus<>>
+    T reduce
+    (
+        parallel_executor &,
+        I,
+        I,
+        T,
+        F = {}
+    );
+
+    template <std::random_access_iterator I, std::random_access_iterator O, typename F = std::plus<>>
+    O inclusive_scan
+    (
+        parallel_executor &,
+        I,
+        I,
+        O,
+        F = {}
+    );
+
+    template <std::random_access_iterator I, std::random_access_iterator O, typename T, typename F = std::plus<>>
+    O exclusive_scan
+    (
+        parallel_executor &,
+        I,
+        I,
+        O,
+        T,
+        F = {}
+    );
+
+    template <std::random_access_iterator I, typename F = std::less<>>
+    void sort
+    (
+        parallel_executor &,
+        I,
+        I,
+        F = {}
+    );
+
+    namespace detail
+    {
+
+        //=====================================================================
+        template <typename I>
+        std::optional<std::int32_t> numa_node_of
+        (
+            I iter
+        )
+        {
+            if constexpr (std::contiguous_iterator<I>)
+                return parallel_executor::numa_node_of(std::to_address(iter));
+            else
+                return std::nullopt;
+        }
+
+
+        //=====================================================================
+        template <typename I, typename F>
+        std::size_t for_each_chunk
+        (
+            // invoke function(chunkIndex, chunkBegin, chunkEnd) for each
+            // chunk of [first, last).  returns the number of chunks.
+            parallel_executor & executor,
+            I first,
+            I last,
+            std::size_t elementSize,
+            F && function
+        )
+        {
+            auto count = static_cast<std::size_t>(std::distance(first, last));
+            if (count == 0)
+                return 0;
+            auto numaNode = numa_node_of(first);
+            auto chunkSize = executor.chunk_size(count, elementSize, numaNode);
+            auto chunkCount = (count + chunkSize - 1) / chunkSize;
+            executor.execute(chunkCount, [&](std::size_t chunk)
+                    {
+                        auto begin = chunk * chunkSize;
+                        auto end = std::min(begin + chunkSize, count);
+                        function(chunk, first + begin, first + end);
+                    }, numaNode);
+            return chunkCount;
+        }
+
+
+        //=====================================================================
+        template <typename I>
+        std::size_t chunk_count
+        (
+            parallel_executor & executor,
+            I first,
+            I last,
+            std::size_t elementSize
+        )
+        {
+            auto count = static_cast<std::size_t>(std::distance(first, last));
+            if (count == 0)
+                return 0;
+            auto chunkSize = executor.chunk_size(count, elementSize, numa_node_of(first));
+            return (count + chunkSize - 1) / chunkSize;
+        }
+
+    } // namespace detail
+
+} // namespace bcpp::system::parallel
+
+
+//=============================================================================
+template <std::random_access_iterator I, typename F>
+inline void bcpp::system::parallel::for_each
+(
+    parallel_executor & executor,
+    I first,
+    I last,
+    F function
+)
+{
+    detail::for_each_chunk(executor, first, last, sizeof(std::iter_value_t<I>), [&](auto, I begin, I end)
+            {
+                std::for_each(begin, end, function);
+            });
+}
+
+
+//=============================================================================
+template <std::random_access_iterator I, std::random_access_iterator O, typename F>
+inline O bcpp::system::parallel::transform
+(
+    parallel_executor & executor,
+    I first,
+    I last,
+    O output,
+    F function
+)
+{
+    detail::for_each_chunk(executor, first, last, sizeof(std::iter_value_t<I>) + sizeof(std::iter_value_t<O>), [&](auto, I begin, I end)
+            {
+                std::transform(begin, end, output + std::distance(first, begin), function);
+            });
+    return output + std::distance(first, last);
+}
+
+
+//=============================================================================
+template <std::random_access_iterator I, typename T, typename F>
+inline T bcpp::system::parallel::reduce
+(
+    // function must be associative.  chunks are combined in order so it need not be commutative
+    parallel_executor & executor,
+    I first,
+    I last,
+    T init,
+    F function
+)
+{
+    std::vector<std::optional<T>> partials(detail::chunk_count(executor, first, last, sizeof(std::iter_value_t<I>)));
+    detail::for_each_chunk(executor, first, last, sizeof(std::iter_value_t<I>), [&](std::size_t chunk, I begin, I end)
+            {
+                T partial = *begin;
+                for (++begin; begin != end; ++begin)
+                    partial = function(std::move(partial), *begin);
+                partials[chunk] = std::move(partial);
+            });
+    for (auto & partial : partials)
+        init = function(std::move(init), std::move(*partial));
+    return init;
+}
+
+
+//=============================================================================
+template <std::random_access_iterator I, std::random_access_iterator O, typename F>
+inline O bcpp::system::parallel::inclusive_scan
+(
+    // two passes: each chunk is reduced, the chunk totals are scanned serially
+    // and then each chunk is scanned from its offset.  output may equal first.
+    // function must be associative.  every fold is in order so it need not be
+    // commutative
+    parallel_executor & executor,
+    I first,
+    I last,
+    O output,
+    F function
+)
+{
+    using value_type = std::iter_value_t<I>;
+    auto chunkCount = detail::chunk_count(executor, first, last, sizeof(value_type) * 2);
+    std::vector<std::optional<value_type>> offsets(chunkCount);
+    detail::for_each_chunk(executor, first, last, sizeof(value_type) * 2, [&](std::size_t chunk, I begin, I end)
+            {
+                if ((chunk + 1) < chunkCount)
+                    offsets[chunk + 1] = std::accumulate(std::next(begin), end, value_type(*begin), function);
+            });
+    for (std::size_t chunk = 2; chunk < chunkCount; ++chunk)
+        offsets[chunk] = function(*offsets[chunk - 1], std::move(*offsets[chunk]));
+    detail::for_each_chunk(executor, first, last, sizeof(value_type) * 2, [&](std::size_t chunk, I begin, I end)
+            {
+                auto chunkOutput = output + std::distance(first, begin);
+                if (chunk == 0)
+                    std::inclusive_scan(begin, end, chunkOutput, function);
+                else
+                    std::inclusive_scan(begin, end, chunkOutput, function, *offsets[chunk]);
+            });
+    return output + std::distance(first, last);
+}
+
+
+//=============================================================================
+template <std::random_access_iterator I, std::random_access_iterator O, typename T, typename F>
+inline O bcpp::system::parallel::exclusive_scan
+(
+    // as inclusive_scan but with init as the first offset
+    parallel_executor & executor,
+    I first,
+    I last,
+    O output,
+    T init,
+    F function
+)
+{
+    auto elementSize = sizeof(std::iter_value_t<I>) * 2;
+    auto chunkCount = detail::chunk_count(executor, first, last, elementSize);
+    std::vector<std::optional<T>> offsets(chunkCount);
+    detail::for_each_chunk(executor, first, last, elementSize, [&](std::size_t chunk, I begin, I end)
+            {
+                if ((chunk + 1) < chunkCount)
+                    offsets[chunk + 1] = std::accumulate(std::next(begin), end, T(*begin), function);
+            });
+    if (chunkCount > 0)
+        offsets[0] = std::move(init);
+    for (std::size_t chunk = 1; chunk < chunkCount; ++chunk)
+        offsets[chunk] = function(*offsets[chunk - 1], std::move(*offsets[chunk]));
+    detail::for_each_chunk(executor, first, last, elementSize, [&](std::size_t chunk, I begin, I end)
+            {
+                std::exclusive_scan(begin, end, output + std::distance(first, begin), *offsets[chunk], function);
+            });
+    return output + std::distance(first, last);
+}
+
+
+//=============================================================================
+template <std::random_access_iterator I, typename F>
+inline void bcpp::system::parallel::sort
+(
+    // chunks are sorted in parallel and then merged pairwise, in parallel,
+    // doubling the run length each round.  not stable.
+    parallel_executor & executor,
+    I first,
+    I last,
+    F compare
+)
+{
+    auto count = static_cast<std::size_t>(std::distance(first, last));
+    auto numaNode = detail::numa_node_of(first);
+    // must match the chunking of for_each_chunk
+    auto runLength = executor.chunk_size(count, sizeof(std::iter_value_t<I>), numaNode);
+    detail::for_each_chunk(executor, first, last, sizeof(std::iter_value_t<I>), [&](auto, I begin, I end)
+            {
+                std::sort(begin, end, compare);
+            });
+
+    for (; runLength < count; runLength *= 2)
+    {
+        auto mergeCount = (count + (runLength * 2) - 1) / (runLength * 2);
+        executor.execute(mergeCount, [&](std::size_t merge)
+                {
+                    auto begin = merge * runLength * 2;
+                    auto middle = std::min(begin + runLength, count);
+                    auto end = std::min(begin + (runLength * 2), count);
+                    if (middle < end)
+                        std::inplace_merge(first + begin, first + middle, first + end, compare);
+                }, numaNode);
+    }
+}
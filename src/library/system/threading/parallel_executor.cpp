@@ -0,0 +1,306 @@
+#include "./parallel_executor.h"
+
+#include <library/system.h>
+
+#include <algorithm>
+
+
+namespace
+{
+
+    // the executor whose task the calling thread is running.  used to run
+    // nested parallel algorithms serially rather than deadlock
+    thread_local bcpp::system::parallel_executor const * currentExecutor = nullptr;
+
+} // namespace
+
+
+//=============================================================================
+bcpp::system::parallel_executor::parallel_executor
+(
+    thread_pool & threadPool,
+    configuration const & config
+):
+    threadPool_(threadPool),
+    cpus_(select_cpus(threadPool, config))
+{
+    auto const & cpuTopology = cpu_topology::get();
+    // reserved so that the workers already started are never affected by growth
+    numaNodes_.reserve(cpus_.size());
+    for (auto cpuId : cpus_)
+    {
+        auto numaNode = cpuTopology.numa_node(cpuId);
+        auto workerConfiguration = config.workerConfiguration_;
+        workerConfiguration.cpuId_ = cpuId;
+        if (workerConfiguration.name_.empty())
+            workerConfiguration.name_ = "parallel_" + std::to_string(cpuId);
+        auto worker = numaNodes_.size();
+        workerConfiguration.function_ = [this, worker, numaNode](std::stop_token const & stopToken){run_worker(stopToken, worker, numaNode);};
+        {
+            // counted as live from the start so that an execute() does not run serially
+            // merely because the worker has yet to be scheduled
+            std::lock_guard lockGuard(mutex_);
+            numaNodes_.push_back(numaNode);
+            live_.push_back(true);
+        }
+        if (auto workerId = threadPool_.add_thread(workerConfiguration); workerId.has_value())
+        {
+            workerIds_.push_back(*workerId);
+        }
+        else
+        {
+            std::lock_guard lockGuard(mutex_);
+            numaNodes_.pop_back();
+            live_.pop_back();
+        }
+    }
+}
+
+
+//=============================================================================
+bcpp::system::parallel_executor::~parallel_executor
+(
+)
+{
+    for (auto workerId : workerIds_)
+        threadPool_.remove_thread(workerId, synchronization_mode::blocking);
+}
+
+
+//=============================================================================
+auto bcpp::system::parallel_executor::select_cpus
+(
+    thread_pool const & threadPool,
+    configuration const & config
+) -> std::vector<cpu_id>
+{
+    if (!config.cpus_.empty())
+        return config.cpus_;
+
+    auto const & cpuTopology = cpu_topology::get();
+    std::vector<cpu_id> reserved(cpuTopology.isolated_cpus());
+    reserved.insert(reserved.end(), cpuTopology.nohz_full_cpus().begin(), cpuTopology.nohz_full_cpus().end());
+    for (auto cpuId : threadPool.get_pinned_cpus())
+    {
+        // a hyper thread sibling shares the core (and its caches) with the latency critical thread
+        reserved.push_back(cpuId);
+        if (auto cpu = cpuTopology.find(cpuId); cpu != nullptr)
+            reserved.insert(reserved.end(), cpu->threadSiblings_.begin(), cpu->threadSiblings_.end());
+    }
+
+    std::vector<cpu_id> cpus;
+    for (auto cpuId : get_available_cpus())
+    {
+        if (std::find(reserved.begin(), reserved.end(), cpuId) != reserved.end())
+            continue;
+        if ((config.numaNode_.has_value()) && (cpuTopology.numa_node(cpuId) != *config.numaNode_))
+            continue;
+        if (cpus.size() < config.maximumThreads_)
+            cpus.push_back(cpuId);
+    }
+    return cpus;
+}
+
+
+//=============================================================================
+void bcpp::system::parallel_executor::run_worker
+(
+    std::stop_token const & stopToken,
+    std::size_t worker,
+    std::int32_t numaNode
+)
+{
+    // marks the worker as no longer live however it exits so that execute() does
+    // not wait on a worker which will never claim another task
+    struct exit_guard
+    {
+        ~exit_guard()
+        {
+            {
+                std::lock_guard lockGuard(executor_.mutex_);
+                executor_.live_[worker_] = false;
+            }
+            executor_.completeCondition_.notify_all();
+        }
+        parallel_executor & executor_;
+        std::size_t         worker_;
+    };
+
+    {
+        std::lock_guard lockGuard(mutex_);
+        live_[worker] = true;   // again if restarted
+    }
+    exit_guard exitGuard{*this, worker};
+    currentExecutor = this;
+    std::uint64_t generation = 0;
+    while (true)
+    {
+        std::shared_ptr<job> currentJob;
+        {
+            std::unique_lock uniqueLock(mutex_);
+            if (!conditionVariable_.wait(uniqueLock, stopToken, [&](){return ((job_) && (job_->generation_ != generation));}))
+                return;
+            currentJob = job_;
+        }
+        generation = currentJob->generation_;
+        if ((!currentJob->numaNode_.has_value()) || (*currentJob->numaNode_ == numaNode))
+            run_tasks(*currentJob);
+    }
+}
+
+
+//=============================================================================
+void bcpp::system::parallel_executor::run_tasks
+(
+    // claim and run tasks until none remain
+    job & currentJob
+)
+{
+    for (auto index = currentJob.nextTask_++; index < currentJob.taskCount_; index = currentJob.nextTask_++)
+    {
+        try
+        {
+            (*currentJob.task_)(index);
+        }
+        catch (...)
+        {
+            std::lock_guard lockGuard(currentJob.exceptionMutex_);
+            if (!currentJob.exception_)
+                currentJob.exception_ = std::current_exception();
+        }
+        if (--currentJob.remainingTasks_ == 0)
+        {
+            // under the mutex so that the notification can not fall between
+            // execute() testing the count and waiting
+            std::lock_guard lockGuard(mutex_);
+            completeCondition_.notify_all();
+        }
+    }
+}
+
+
+//=============================================================================
+void bcpp::system::parallel_executor::execute
+(
+    // the calling thread only waits - it does not run tasks itself as it may
+    // be pinned to a cpu which is not meant to take part.  if called from
+    // within a task, or if no worker can take the tasks, they run serially on
+    // the calling thread.  should the workers exit (ie: the thread_pool is
+    // stopped) while the tasks run, the calling thread runs those remaining.
+    // rethrows the first exception thrown by a task.
+    std::size_t taskCount,
+    std::function<void(std::size_t)> const & task,
+    std::optional<std::int32_t> numaNode
+)
+{
+    if (taskCount == 0)
+        return;
+    if ((numaNode.has_value()) && (concurrency(numaNode) == 0))
+        numaNode = std::nullopt;    // no workers on the node.  better remote than serial
+    if ((currentExecutor == this) || (concurrency(numaNode) == 0) || (taskCount == 1))
+    {
+        for (std::size_t i = 0; i < taskCount; ++i)
+            task(i);
+        return;
+    }
+
+    std::lock_guard executeLockGuard(executeMutex_);
+    auto newJob = std::make_shared<job>();
+    newJob->task_ = &task;
+    newJob->taskCount_ = taskCount;
+    newJob->numaNode_ = numaNode;
+    newJob->remainingTasks_ = taskCount;
+    {
+        std::lock_guard lockGuard(mutex_);
+        newJob->generation_ = (job_ ? job_->generation_ : 0) + 1;
+        job_ = newJob;
+    }
+    conditionVariable_.notify_all();
+
+    bool complete = false;
+    {
+        std::unique_lock uniqueLock(mutex_);
+        completeCondition_.wait(uniqueLock, [&](){return ((newJob->remainingTasks_ == 0) || (live_workers(numaNode) == 0));});
+        complete = (newJob->remainingTasks_ == 0);
+    }
+    if (!complete)
+    {
+        // tasks claimed by a worker before it exited have run so only the unclaimed remain
+        run_tasks(*newJob);
+        std::unique_lock uniqueLock(mutex_);
+        completeCondition_.wait(uniqueLock, [&](){return (newJob->remainingTasks_ == 0);});
+    }
+
+    if (newJob->exception_)
+        std::rethrow_exception(newJob->exception_);
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::parallel_executor::concurrency
+(
+    // number of workers which take part in tasks for the numa node (or all nodes)
+    std::optional<std::int32_t> numaNode
+) const
+{
+    std::lock_guard lockGuard(mutex_);
+    return live_workers(numaNode);
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::parallel_executor::live_workers
+(
+    std::optional<std::int32_t> numaNode
+) const
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < live_.size(); ++i)
+        count += ((live_[i]) && ((!numaNode.has_value()) || (numaNodes_[i] == *numaNode)));
+    return count;
+}
+
+
+//=============================================================================
+auto bcpp::system::parallel_executor::cpus
+(
+) const -> std::vector<cpu_id> const &
+{
+    return cpus_;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::parallel_executor::chunk_size
+(
+    // a chunk's input and output fit together in half of the worker's L2 so
+    // that a chunk which is revisited (ie: by a second pass) is still cache
+    // resident.  chunks are made smaller (but no smaller than a page) when
+    // needed to give each worker at least four chunks to balance load.
+    std::size_t count,
+    std::size_t elementSize,
+    std::optional<std::int32_t> numaNode
+) const
+{
+    static std::size_t constexpr default_l2_size = (256 << 10);
+    static std::size_t constexpr page_size = 4096;
+    static std::size_t constexpr chunks_per_worker = 4;
+
+    elementSize = std::max<std::size_t>(elementSize, 1);
+    auto l2Size = cpus_.empty() ? 0 : cpu_topology::get().cache_size(2, cpus_.front());
+    auto cacheChunk = std::max<std::size_t>(((l2Size ? l2Size : default_l2_size) / 4) / elementSize, 1);
+    auto workerCount = std::max<std::size_t>(concurrency(numaNode), 1);
+    auto balancedChunk = (count + (workerCount * chunks_per_worker) - 1) / (workerCount * chunks_per_worker);
+    auto minimumChunk = std::max<std::size_t>(page_size / elementSize, 1);
+    return std::max<std::size_t>(std::min({count, cacheChunk, std::max(balancedChunk, minimumChunk)}), 1);
+}
+
+
+//=============================================================================
+auto bcpp::system::parallel_executor::numa_node_of
+(
+    void const * address
+) -> std::optional<std::int32_t>
+{
+    return get_numa_node(address);
+}
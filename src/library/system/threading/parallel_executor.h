@@ -0,0 +1,153 @@
+#pragma once
+
+#include "./thread_pool.h"
+
+#include <library/system/cpu_id.h>
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // parallel_executor
+    //
+    // a set of pinned workers added to an existing thread_pool which execute
+    // indexed tasks on behalf of the parallel algorithms.  unless cpus are
+    // given explicitly the workers avoid every cpu already reserved for
+    // latency critical threads - cpus to which workers of the pool are
+    // pinned (and their hyper thread siblings), isolated cpus and nohz_full
+    // cpus.  a task set may be restricted to the workers on one numa node so
+    // that work stays next to numa bound data.
+    //
+    // workers which have exited (ie: the thread_pool has been stopped) take
+    // no part.  with none left execute() runs the tasks on the calling
+    // thread rather than wait for workers which will never come.
+    //=========================================================================
+    class parallel_executor :
+        non_copyable
+    {
+    public:
+
+        struct configuration
+        {
+            // cpus for the workers.  if empty they are chosen as described above
+            std::vector<cpu_id>                 cpus_;
+            // restrict automatically chosen cpus to a numa node
+            std::optional<std::int32_t>         numaNode_;
+            // cap the number of automatically chosen cpus
+            std::size_t                         maximumThreads_{~std::size_t(0)};
+            // template for every worker.  function_ and cpuId_ are set by the executor
+            thread_pool::thread_configuration   workerConfiguration_;
+        };
+
+        parallel_executor
+        (
+            thread_pool &,
+            configuration const &
+        );
+
+        ~parallel_executor();
+
+        // blocks until task(i) has run for every i in [0, taskCount)
+        void execute
+        (
+            std::size_t taskCount,
+            std::function<void(std::size_t)> const & task,
+            std::optional<std::int32_t> numaNode = std::nullopt
+        );
+
+        std::size_t concurrency
+        (
+            std::optional<std::int32_t> numaNode = std::nullopt
+        ) const;
+
+        std::vector<cpu_id> const & cpus() const;
+
+        // elements per task for count elements of elementSize bytes
+        std::size_t chunk_size
+        (
+            std::size_t count,
+            std::size_t elementSize,
+            std::optional<std::int32_t> numaNode = std::nullopt
+        ) const;
+
+        // the numa node to which the memory at address is bound, if any
+        static std::optional<std::int32_t> numa_node_of
+        (
+            void const *
+        );
+
+    private:
+
+        struct job
+        {
+            std::function<void(std::size_t)> const *    task_;
+            std::size_t                                 taskCount_;
+            std::optional<std::int32_t>                 numaNode_;
+            std::uint64_t                               generation_;
+            alignas(cache_line_size) std::atomic<std::size_t>   nextTask_{0};
+            alignas(cache_line_size) std::atomic<std::size_t>   remainingTasks_;
+            std::mutex                                  exceptionMutex_;
+            std::exception_ptr                          exception_;
+        };
+
+        void run_worker
+        (
+            std::stop_token const &,
+            std::size_t,
+            std::int32_t
+        );
+
+        void run_tasks
+        (
+            job &
+        );
+
+        // live workers on the numa node (or all nodes).  requires mutex_
+        std::size_t live_workers
+        (
+            std::optional<std::int32_t>
+        ) const;
+
+        static std::vector<cpu_id> select_cpus
+        (
+            thread_pool const &,
+            configuration const &
+        );
+
+        thread_pool &                           threadPool_;
+
+        std::vector<cpu_id>                     cpus_;
+
+        std::vector<std::int32_t>               numaNodes_;
+
+        std::vector<bool>                       live_;          // per worker, guarded by mutex_
+
+        std::vector<thread_pool::thread_id>     workerIds_;
+
+        std::mutex                              executeMutex_;
+
+        mutable std::mutex                      mutex_;
+
+        std::condition_variable_any             conditionVariable_;
+
+        // notified as a job completes and as workers exit
+        std::condition_variable                 completeCondition_;
+
+        std::shared_ptr<job>                    job_;
+
+    }; // class parallel_executor
+
+} // namespace bcpp::system
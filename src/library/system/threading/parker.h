@@ -0,0 +1,107 @@
+#pragma once
+
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <cstdint>
+#include <stop_token>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // parker
+    //
+    // blocks one consumer thread until another thread unparks it (a futex
+    // through std::atomic::wait).  an unpark which arrives before the park
+    // is not lost: it leaves a token which the next park() consumes and
+    // returns immediately.  park() may also return spuriously so the
+    // consumer rechecks its condition:
+    //
+    //      while (queue.empty())
+    //          parker.park(stopToken);
+    //
+    // unpark() is cheap while the token is already set (a load of a line
+    // which is only written when the consumer parks) so producers may call
+    // it after every push without contending on it.
+    //=========================================================================
+    class parker :
+        non_copyable
+    {
+    public:
+
+        void park();
+
+        // returns false if stop was requested
+        bool park
+        (
+            std::stop_token const &
+        );
+
+        void unpark();
+
+    private:
+
+        static std::uint32_t constexpr empty = 0;
+        static std::uint32_t constexpr notified = 1;
+        static std::uint32_t constexpr parked = 2;
+
+        alignas(cache_line_size) std::atomic<std::uint32_t> state_{empty};
+
+    }; // class parker
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+inline void bcpp::system::parker::park
+(
+)
+{
+    // consume a pending token.  seq_cst with respect to the consumer's check
+    // of its condition and the producer's publication of the change
+    if (state_.exchange(empty, std::memory_order_seq_cst) == notified)
+        return;
+    auto state = empty;
+    if (!state_.compare_exchange_strong(state, parked, std::memory_order_seq_cst))
+    {
+        // unparked in the meantime
+        state_.store(empty, std::memory_order_relaxed);
+        return;
+    }
+    while (true)
+    {
+        state_.wait(parked, std::memory_order_acquire);
+        state = notified;
+        if (state_.compare_exchange_strong(state, empty, std::memory_order_acquire))
+            return;
+    }
+}
+
+
+//=============================================================================
+inline bool bcpp::system::parker::park
+(
+    std::stop_token const & stopToken
+)
+{
+    if (stopToken.stop_requested())
+        return false;
+    std::stop_callback stopCallback(stopToken, [this](){unpark();});
+    park();
+    return !stopToken.stop_requested();
+}
+
+
+//=============================================================================
+inline void bcpp::system::parker::unpark
+(
+)
+{
+    if (state_.load(std::memory_order_seq_cst) == notified)
+        return;
+    if (state_.exchange(notified, std::memory_order_seq_cst) == parked)
+        state_.notify_one();
+}
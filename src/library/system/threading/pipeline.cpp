@@ -0,0 +1,290 @@
+#include "./pipeline.h"
+
+#include <algorithm>
+#include <map>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#endif
+
+
+//=============================================================================
+bcpp::system::pipeline::pipeline
+(
+    configuration const & config
+):
+    configuration_(config)
+{
+}
+
+
+//=============================================================================
+bcpp::system::pipeline::~pipeline
+(
+)
+{
+    stop();
+}
+
+
+//=============================================================================
+bool bcpp::system::pipeline::start
+(
+    // create one worker per distinct cpu (fusing the stages pinned to it)
+    // and one unpinned worker for each stage without a cpu
+)
+{
+    if ((threadPool_) || (stages_.empty()))
+        return false;
+    stoppedPool_.reset();
+
+    std::map<cpu_id, std::vector<stage_base *>> pinnedStages;
+    std::vector<std::vector<stage_base *>> workerStages;
+    std::vector<std::optional<cpu_id>> workerCpus;
+    for (auto & stage : stages_)
+    {
+        if (stage->configuration_.cpuId_.has_value())
+        {
+            pinnedStages[*stage->configuration_.cpuId_].push_back(stage.get());
+        }
+        else
+        {
+            workerStages.push_back({stage.get()});
+            workerCpus.push_back(std::nullopt);
+        }
+    }
+    for (auto & [cpuId, stages] : pinnedStages)
+    {
+        workerStages.push_back(stages);
+        workerCpus.push_back(cpuId);
+    }
+
+    draining_ = false;
+    workerStages_ = workerStages;
+    workerGroups_ = get_worker_groups();
+    std::vector<thread_pool::thread_configuration> threadConfigurations;
+    for (std::size_t i = 0; i < workerStages.size(); ++i)
+    {
+        auto threadConfiguration = configuration_.workerConfiguration_;
+        threadConfiguration.cpuId_ = workerCpus[i];
+        if (threadConfiguration.name_.empty())
+            threadConfiguration.name_ = workerStages[i].front()->configuration_.name_;
+        threadConfiguration.stopGroup_ = "pipeline_" + std::to_string(workerGroups_[i]);
+        threadConfiguration.isDrained_ = [stages = workerStages[i]]()
+                {
+                    return std::all_of(stages.begin(), stages.end(), [](auto stage){return stage->is_drained();});
+                };
+        threadConfiguration.function_ = [this, stages = workerStages[i]](std::stop_token const & stopToken)
+                {
+                    run_worker(stopToken, stages);
+                };
+        threadConfigurations.push_back(threadConfiguration);
+    }
+    threadPool_ = std::make_unique<thread_pool>(threadConfigurations);
+    return true;
+}
+
+
+//=============================================================================
+void bcpp::system::pipeline::run_worker
+(
+    std::stop_token const & stopToken,
+    std::vector<stage_base *> const & stages
+) const
+{
+    std::size_t idleCount = 0;
+    while (!stopToken.stop_requested())
+    {
+        auto progress = false;
+        for (auto stage : stages)
+            progress |= stage->poll();
+
+        if (progress)
+        {
+            idleCount = 0;
+            continue;
+        }
+        if (configuration_.idleHandler_)
+            configuration_.idleHandler_();
+        if ((configuration_.idleSpinCount_ > 0) && (++idleCount >= configuration_.idleSpinCount_))
+        {
+            idleCount = 0;
+            std::this_thread::yield();
+        }
+        else
+        {
+            #if defined(__x86_64__) || defined(__i386__)
+                _mm_pause();
+            #elif defined(__aarch64__)
+                asm volatile("yield");
+            #endif
+        }
+    }
+
+    // hand on whatever is still pending.  while draining, the workers
+    // downstream are not stopped until this one exits so keep flushing (and
+    // polling, which runs any fused downstream stages and produces nothing
+    // new from sources) until everything is taken or the stop timeout passes
+    // (ie: the worker downstream has given up and exited)
+    auto flushDeadline = (std::chrono::steady_clock::now() + flushTimeout_);
+    while (true)
+    {
+        auto flushed = true;
+        for (auto stage : stages)
+            flushed &= stage->flush_output();
+        if ((flushed) || (!draining_.load(std::memory_order_acquire)) || (std::chrono::steady_clock::now() >= flushDeadline))
+            break;
+        auto progress = false;
+        for (auto stage : stages)
+            progress |= stage->poll();
+        if (!progress)
+            std::this_thread::yield();
+    }
+}
+
+
+//=============================================================================
+void bcpp::system::pipeline::stop
+(
+    // non_blocking keeps the stopped pool until start() or a blocking stop
+    // as its workers still poll the stages until they exit
+    synchronization_mode stopMode
+)
+{
+    draining_ = false;
+    if (threadPool_)
+    {
+        threadPool_->stop(stopMode);
+        stoppedPool_ = std::move(threadPool_);
+    }
+    if (stopMode == synchronization_mode::blocking)
+        stoppedPool_.reset();
+}
+
+
+//=============================================================================
+auto bcpp::system::pipeline::drain_and_stop
+(
+    // stop the sources and then stop each worker once everything upstream of
+    // it has stopped and its input queues are empty (or drainTimeout passes)
+    std::chrono::nanoseconds drainTimeout,
+    std::chrono::nanoseconds stopTimeout
+) -> thread_pool::stop_report
+{
+    if (!threadPool_)
+        return {.complete_ = true};
+    flushTimeout_ = stopTimeout;
+    draining_ = true;
+    auto report = threadPool_->ordered_stop(get_stop_groups(drainTimeout, stopTimeout));
+    if (report.complete_)
+        threadPool_.reset();
+    return report;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::pipeline::worker_of
+(
+    stage_base const * stage
+) const
+{
+    for (std::size_t i = 0; i < workerStages_.size(); ++i)
+        if (std::find(workerStages_[i].begin(), workerStages_[i].end(), stage) != workerStages_[i].end())
+            return i;
+    return workerStages_.size();
+}
+
+
+//=============================================================================
+auto bcpp::system::pipeline::get_worker_groups
+(
+    // the stop group of each worker.  workers which feed one another can not
+    // be stopped one after the other (each would wait for the other) so they
+    // share the group of the lowest numbered worker among them
+) const -> std::vector<std::size_t>
+{
+    auto workerCount = workerStages_.size();
+    // reaches[i][j] once the output of worker i reaches worker j
+    std::vector<std::vector<bool>> reaches(workerCount, std::vector<bool>(workerCount, false));
+    for (std::size_t i = 0; i < workerCount; ++i)
+    {
+        reaches[i][i] = true;
+        for (auto stage : workerStages_[i])
+            if (stage->upstream_.has_value())
+                reaches[worker_of(stages_[*stage->upstream_].get())][i] = true;
+    }
+    for (std::size_t k = 0; k < workerCount; ++k)
+        for (std::size_t i = 0; i < workerCount; ++i)
+            if (reaches[i][k])
+                for (std::size_t j = 0; j < workerCount; ++j)
+                    if (reaches[k][j])
+                        reaches[i][j] = true;
+
+    std::vector<std::size_t> workerGroups(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i)
+    {
+        auto j = std::size_t{0};
+        while ((!reaches[i][j]) || (!reaches[j][i]))
+            ++j;
+        workerGroups[i] = j;
+    }
+    return workerGroups;
+}
+
+
+//=============================================================================
+auto bcpp::system::pipeline::get_stop_groups
+(
+    // one group per set of workers which feed one another, ordered after the
+    // groups which feed it.  as the sets absorb every cycle the order is total
+    std::chrono::nanoseconds drainTimeout,
+    std::chrono::nanoseconds stopTimeout
+) const -> std::vector<thread_pool::stop_group>
+{
+    std::vector<thread_pool::stop_group> stopGroups;
+    for (std::size_t i = 0; i < workerStages_.size(); ++i)
+    {
+        if (workerGroups_[i] != i)
+            continue;
+        thread_pool::stop_group stopGroup{.name_ = "pipeline_" + std::to_string(i), .drainTimeout_ = drainTimeout, .stopTimeout_ = stopTimeout};
+        for (std::size_t j = 0; j < workerStages_.size(); ++j)
+            if (workerGroups_[j] == i)
+                for (auto stage : workerStages_[j])
+                    if (stage->upstream_.has_value())
+                        if (auto upstreamGroup = workerGroups_[worker_of(stages_[*stage->upstream_].get())]; upstreamGroup != i)
+                            stopGroup.after_.push_back("pipeline_" + std::to_string(upstreamGroup));
+        stopGroups.push_back(stopGroup);
+    }
+    return stopGroups;
+}
+
+
+//=============================================================================
+bool bcpp::system::pipeline::is_running
+(
+) const
+{
+    return (bool)threadPool_;
+}
+
+
+//=============================================================================
+auto bcpp::system::pipeline::get_stage_stats
+(
+    // may be called while the pipeline is running
+) const -> std::vector<stage_stats>
+{
+    std::vector<stage_stats> result;
+    for (auto const & stage : stages_)
+        result.push_back(
+                {
+                    .name_ = stage->configuration_.name_,
+                    .cpuId_ = stage->configuration_.cpuId_,
+                    .processed_ = stage->processed_.load(std::memory_order_relaxed),
+                    .batches_ = stage->batches_.load(std::memory_order_relaxed),
+                    .blocked_ = stage->blocked_.load(std::memory_order_relaxed),
+                    .queueDepth_ = stage->queue_depth()
+                });
+    return result;
+}
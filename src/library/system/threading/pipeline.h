@@ -0,0 +1,533 @@
+#pragma once
+
+#include "./thread_pool.h"
+#include "./spsc_queue.h"
+
+#include <library/system/cpu_id.h>
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+#include <include/synchronization_mode.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // pipeline
+    //
+    // a graph of stages connected by bounded spsc queues.  each stage runs
+    // on a pinned worker of an internal thread_pool.  stages which share a
+    // cpuId_ are fused and polled in turn by a single worker.  stages are
+    // passed batches of up to batchSize_ inputs.  a stage which can not
+    // hand all of its output downstream is not run again until it has, so a
+    // slow stage backs up the queues behind it all the way to the source
+    // rather than growing memory or dropping data.
+    //
+    // stages must be added before start().  the output of a stage may feed
+    // several downstream stages (each gets its own queue and a copy of
+    // every element).  drain_and_stop() stops the sources and then stops the
+    // workers upstream first, each once the queues into it are empty, so
+    // that no element in flight is lost.  workers which feed one another
+    // (ie: a -> b -> c with a and c fused on one cpu and b on another) are
+    // drained and stopped together.  a worker stopped by drain_and_stop()
+    // keeps flushing until its stages' output has all been taken downstream
+    // or stopTimeout passes.  stop() makes one last attempt and may drop
+    // elements in flight.  after stop(non_blocking) the pipeline is no
+    // longer running and start() first waits for the old workers to exit.
+    //=========================================================================
+    class pipeline :
+        non_copyable
+    {
+    public:
+
+        struct configuration
+        {
+            // template for every worker.  function_, cpuId_ and (if empty) name_ are set by the pipeline
+            thread_pool::thread_configuration   workerConfiguration_;
+            // polls without progress before a worker yields its cpu.  zero never yields
+            std::size_t                         idleSpinCount_{0};
+            // called by a worker whenever a poll of its stages makes no progress
+            // (ie: to report a quiescent state to an epoch_reclaimer)
+            std::function<void()>               idleHandler_;
+        };
+
+        struct stage_configuration
+        {
+            std::string             name_;
+            std::optional<cpu_id>   cpuId_;             // stages on the same cpu are fused onto one worker
+            std::size_t             batchSize_{64};
+            std::size_t             queueCapacity_{1024};  // capacity of the stage's input queue
+        };
+
+        struct stage_stats
+        {
+            std::string             name_;
+            std::optional<cpu_id>   cpuId_;
+            std::uint64_t           processed_;         // elements consumed (sources: elements produced)
+            std::uint64_t           batches_;
+            std::uint64_t           blocked_;           // polls skipped due to a full downstream queue
+            std::size_t             queueDepth_;
+        };
+
+        template <typename T>
+        class output
+        {
+        public:
+
+            void push
+            (
+                T const & value
+            )
+            {
+                pending_.push_back(value);
+            }
+
+            void push
+            (
+                T && value
+            )
+            {
+                pending_.push_back(std::move(value));
+            }
+
+            std::size_t size() const
+            {
+                return pending_.size();
+            }
+
+        private:
+
+            friend class pipeline;
+
+            bool flush();
+
+            std::vector<T>                                  pending_;
+            std::vector<std::size_t>                        offsets_;
+            std::vector<std::shared_ptr<spsc_queue<T>>>     queues_;
+        };
+
+        template <typename T>
+        struct stage_handle
+        {
+            std::size_t index_;
+        };
+
+        pipeline() = default;
+
+        pipeline
+        (
+            configuration const &
+        );
+
+        ~pipeline();
+
+        template <typename O>
+        stage_handle<O> add_source
+        (
+            stage_configuration const &,
+            std::function<void(output<O> &)>
+        );
+
+        template <typename I, typename O>
+        stage_handle<O> add_stage
+        (
+            stage_handle<I>,
+            stage_configuration const &,
+            std::function<void(std::span<I>, output<O> &)>
+        );
+
+        template <typename I>
+        void add_sink
+        (
+            stage_handle<I>,
+            stage_configuration const &,
+            std::function<void(std::span<I>)>
+        );
+
+        bool start();
+
+        void stop
+        (
+            synchronization_mode = synchronization_mode::blocking
+        );
+
+        thread_pool::stop_report drain_and_stop
+        (
+            std::chrono::nanoseconds drainTimeout,
+            std::chrono::nanoseconds stopTimeout = std::chrono::seconds(5)
+        );
+
+        bool is_running() const;
+
+        std::vector<stage_stats> get_stage_stats() const;
+
+    private:
+
+        struct alignas(cache_line_size) stage_base
+        {
+            stage_base
+            (
+                stage_configuration const & config
+            ):
+                configuration_(config)
+            {
+            }
+
+            virtual ~stage_base() = default;
+
+            // returns true if any progress was made
+            virtual bool poll() = 0;
+
+            virtual std::size_t queue_depth() const
+            {
+                return 0;
+            }
+
+            // hand pending output downstream.  true once none is pending
+            virtual bool flush_output()
+            {
+                return true;
+            }
+
+            // nothing queued for, being processed by or pending within the
+            // stage.  the queue is read first: a stage clears flushed_ before
+            // it takes a batch from its queue so a batch which has left the
+            // queue is seen as in flight
+            bool is_drained() const
+            {
+                return ((queue_depth() == 0) && (flushed_.load(std::memory_order_seq_cst)));
+            }
+
+            void add
+            (
+                std::atomic<std::uint64_t> & value,
+                std::uint64_t amount
+            )
+            {
+                value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+
+            stage_configuration         configuration_;
+            std::optional<std::size_t>  upstream_;
+            std::atomic<bool> const *   draining_{nullptr};
+            std::atomic<bool>           flushed_{true};       // false while a batch is processed or output is pending
+            std::atomic<std::uint64_t>  processed_{0};
+            std::atomic<std::uint64_t>  batches_{0};
+            std::atomic<std::uint64_t>  blocked_{0};
+        };
+
+        template <typename O>
+        struct producer : stage_base
+        {
+            using stage_base::stage_base;
+
+            bool flush()
+            {
+                auto flushed = output_.flush();
+                flushed_.store(flushed, std::memory_order_release);
+                return flushed;
+            }
+
+            bool flush_output() override
+            {
+                return flush();
+            }
+
+            output<O>   output_;
+        };
+
+        template <typename O>
+        struct source_stage;
+
+        template <typename I, typename O>
+        struct transform_stage;
+
+        template <typename I>
+        struct sink_stage;
+
+        template <typename I>
+        std::shared_ptr<spsc_queue<I>> connect
+        (
+            stage_handle<I>,
+            stage_configuration const &
+        );
+
+        void run_worker
+        (
+            std::stop_token const &,
+            std::vector<stage_base *> const &
+        ) const;
+
+        std::size_t worker_of
+        (
+            stage_base const *
+        ) const;
+
+        std::vector<std::size_t> get_worker_groups() const;
+
+        std::vector<thread_pool::stop_group> get_stop_groups
+        (
+            std::chrono::nanoseconds,
+            std::chrono::nanoseconds
+        ) const;
+
+        configuration                               configuration_;
+
+        std::vector<std::unique_ptr<stage_base>>    stages_;
+
+        std::vector<std::vector<stage_base *>>      workerStages_;
+
+        std::vector<std::size_t>                    workerGroups_;      // stop group of each worker
+
+        std::atomic<bool>                           draining_{false};
+
+        std::chrono::nanoseconds                    flushTimeout_{0};   // set before draining_
+
+        std::unique_ptr<thread_pool>                threadPool_;
+
+        std::unique_ptr<thread_pool>                stoppedPool_;       // stopped without waiting for its workers
+
+    }; // class pipeline
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename O>
+struct bcpp::system::pipeline::source_stage : producer<O>
+{
+    source_stage
+    (
+        stage_configuration const & config,
+        std::function<void(output<O> &)> function
+    ):
+        producer<O>(config),
+        function_(std::move(function))
+    {
+    }
+
+    bool poll() override
+    {
+        if (!this->flush())
+        {
+            this->add(this->blocked_, 1);
+            return false;
+        }
+        if (this->draining_->load(std::memory_order_relaxed))
+            return false;
+        this->flushed_.store(false, std::memory_order_seq_cst);
+        function_(this->output_);
+        auto produced = this->output_.size();
+        if (produced == 0)
+        {
+            this->flushed_.store(true, std::memory_order_release);
+            return false;
+        }
+        this->add(this->processed_, produced);
+        this->add(this->batches_, 1);
+        this->flush();
+        return true;
+    }
+
+    std::function<void(output<O> &)>   function_;
+};
+
+
+//=============================================================================
+template <typename I, typename O>
+struct bcpp::system::pipeline::transform_stage : producer<O>
+{
+    transform_stage
+    (
+        stage_configuration const & config,
+        std::shared_ptr<spsc_queue<I>> input,
+        std::function<void(std::span<I>, output<O> &)> function
+    ):
+        producer<O>(config),
+        input_(std::move(input)),
+        function_(std::move(function))
+    {
+        batch_.reserve(config.batchSize_);
+    }
+
+    bool poll() override
+    {
+        if (!this->flush())
+        {
+            this->add(this->blocked_, 1);
+            return false;
+        }
+        batch_.clear();
+        this->flushed_.store(false, std::memory_order_seq_cst);
+        if (input_->consume([this](I & value){batch_.push_back(std::move(value));}, this->configuration_.batchSize_) == 0)
+        {
+            this->flushed_.store(true, std::memory_order_release);
+            return false;
+        }
+        function_(std::span<I>(batch_), this->output_);
+        this->add(this->processed_, batch_.size());
+        this->add(this->batches_, 1);
+        this->flush();
+        return true;
+    }
+
+    std::size_t queue_depth() const override
+    {
+        return input_->size();
+    }
+
+    std::shared_ptr<spsc_queue<I>>                      input_;
+    std::function<void(std::span<I>, output<O> &)>      function_;
+    std::vector<I>                                      batch_;
+};
+
+
+//=============================================================================
+template <typename I>
+struct bcpp::system::pipeline::sink_stage : stage_base
+{
+    sink_stage
+    (
+        stage_configuration const & config,
+        std::shared_ptr<spsc_queue<I>> input,
+        std::function<void(std::span<I>)> function
+    ):
+        stage_base(config),
+        input_(std::move(input)),
+        function_(std::move(function))
+    {
+        batch_.reserve(config.batchSize_);
+    }
+
+    bool poll() override
+    {
+        batch_.clear();
+        flushed_.store(false, std::memory_order_seq_cst);
+        if (input_->consume([this](I & value){batch_.push_back(std::move(value));}, configuration_.batchSize_) == 0)
+        {
+            flushed_.store(true, std::memory_order_release);
+            return false;
+        }
+        function_(std::span<I>(batch_));
+        add(processed_, batch_.size());
+        add(batches_, 1);
+        flushed_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t queue_depth() const override
+    {
+        return input_->size();
+    }
+
+    std::shared_ptr<spsc_queue<I>>          input_;
+    std::function<void(std::span<I>)>       function_;
+    std::vector<I>                          batch_;
+};
+
+
+//=============================================================================
+template <typename T>
+inline bool bcpp::system::pipeline::output<T>::flush
+(
+    // hand pending elements downstream.  returns true once every downstream
+    // queue has taken all of them.  with a single downstream queue elements
+    // are moved, otherwise each queue receives a copy.
+)
+{
+    if (pending_.empty())
+        return true;
+    auto complete = true;
+    for (std::size_t i = 0; i < queues_.size(); ++i)
+    {
+        auto & offset = offsets_[i];
+        if (offset == pending_.size())
+            continue;
+        if (queues_.size() == 1)
+            offset += queues_[i]->push(pending_.begin() + offset, pending_.end());
+        else
+            offset += queues_[i]->push(pending_.cbegin() + offset, pending_.cend());
+        complete &= (offset == pending_.size());
+    }
+    if (complete)
+    {
+        pending_.clear();
+        std::fill(offsets_.begin(), offsets_.end(), 0);
+    }
+    return complete;
+}
+
+
+//=============================================================================
+template <typename I>
+inline auto bcpp::system::pipeline::connect
+(
+    // create a queue from the upstream stage's output to a new stage
+    stage_handle<I> upstream,
+    stage_configuration const & config
+) -> std::shared_ptr<spsc_queue<I>>
+{
+    auto queue = std::make_shared<spsc_queue<I>>(config.queueCapacity_);
+    auto & upstreamOutput = static_cast<producer<I> &>(*stages_[upstream.index_]).output_;
+    upstreamOutput.queues_.push_back(queue);
+    upstreamOutput.offsets_.push_back(0);
+    return queue;
+}
+
+
+//=============================================================================
+template <typename O>
+inline auto bcpp::system::pipeline::add_source
+(
+    // function is called repeatedly and pushes zero or more elements to its output
+    stage_configuration const & config,
+    std::function<void(output<O> &)> function
+) -> stage_handle<O>
+{
+    stages_.push_back(std::make_unique<source_stage<O>>(config, std::move(function)));
+    stages_.back()->draining_ = &draining_;
+    return {stages_.size() - 1};
+}
+
+
+//=============================================================================
+template <typename I, typename O>
+inline auto bcpp::system::pipeline::add_stage
+(
+    // function is called with each batch of input and pushes zero or more elements to its output
+    stage_handle<I> upstream,
+    stage_configuration const & config,
+    std::function<void(std::span<I>, output<O> &)> function
+) -> stage_handle<O>
+{
+    auto input = connect(upstream, config);
+    stages_.push_back(std::make_unique<transform_stage<I, O>>(config, std::move(input), std::move(function)));
+    stages_.back()->upstream_ = upstream.index_;
+    return {stages_.size() - 1};
+}
+
+
+//=============================================================================
+template <typename I>
+inline void bcpp::system::pipeline::add_sink
+(
+    stage_handle<I> upstream,
+    stage_configuration const & config,
+    std::function<void(std::span<I>)> function
+)
+{
+    auto input = connect(upstream, config);
+    stages_.push_back(std::make_unique<sink_stage<I>>(config, std::move(input), std::move(function)));
+    stages_.back()->upstream_ = upstream.index_;
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <library/system/cache_aligned.h>
+#include <include/non_copyable.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#include <sched.h>
+#include <sys/sysinfo.h>
+
+
+namespace bcpp::system
+{
+
+    enum class shard_policy
+    {
+        per_cpu,    // shard by the cpu the caller is running on (sched_getcpu)
+        per_thread  // shard by a per thread index assigned on first use
+    };
+
+
+    //=========================================================================
+    // sharded_counter
+    //
+    // a counter split into cache line sized shards so that concurrent
+    // updates from different cpus (or threads) do not contend for one line.
+    // updates are a relaxed fetch_add on the caller's shard.  load() sums the
+    // shards and so is as expensive as the shard count; it is intended for
+    // periodic aggregation (ie: by a monitor) rather than for the hot path.
+    //
+    // per_cpu suits counters updated from many (possibly migrating) threads.
+    // per_thread avoids the sched_getcpu call and suits a fixed set of
+    // (usually pinned) workers.  in either case a shard may be shared so the
+    // update is still atomic but it is, in practice, uncontended.
+    //=========================================================================
+    template <typename T = std::uint64_t>
+    class sharded_counter :
+        non_copyable
+    {
+    public:
+
+        static_assert(std::is_integral_v<T>, "sharded_counter requires an integral type");
+
+        using value_type = T;
+
+        struct configuration
+        {
+            shard_policy    shardPolicy_{shard_policy::per_cpu};
+            std::size_t     shardCount_{0};     // zero for the number of configured cpus
+        };
+
+        sharded_counter();
+
+        explicit sharded_counter
+        (
+            configuration const &
+        );
+
+        void add
+        (
+            T
+        ) noexcept;
+
+        void subtract
+        (
+            T
+        ) noexcept;
+
+        sharded_counter & operator += (T value) noexcept {add(value); return *this;}
+        sharded_counter & operator -= (T value) noexcept {subtract(value); return *this;}
+        sharded_counter & operator ++ () noexcept {add(1); return *this;}
+        sharded_counter & operator -- () noexcept {subtract(1); return *this;}
+
+        T load() const noexcept;
+
+        // returns the total and zeroes the counter.  updates made concurrently
+        // are counted either in the returned total or in the next
+        T exchange() noexcept;
+
+        std::size_t shard_count() const noexcept;
+
+    private:
+
+        std::atomic<T> & shard() noexcept;
+
+        static std::size_t thread_index() noexcept;
+
+        shard_policy                                        shardPolicy_;
+
+        std::size_t                                         mask_;
+
+        std::unique_ptr<cache_aligned<std::atomic<T>>[]>    shards_;
+
+    }; // class sharded_counter
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename T>
+inline bcpp::system::sharded_counter<T>::sharded_counter
+(
+):
+    sharded_counter(configuration{})
+{
+}
+
+
+//=============================================================================
+template <typename T>
+inline bcpp::system::sharded_counter<T>::sharded_counter
+(
+    configuration const & config
+):
+    shardPolicy_(config.shardPolicy_),
+    mask_(std::bit_ceil(std::max<std::size_t>((config.shardCount_ != 0) ? config.shardCount_ : ::get_nprocs_conf(), 1)) - 1),
+    shards_(std::make_unique<cache_aligned<std::atomic<T>>[]>(mask_ + 1))
+{
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t bcpp::system::sharded_counter<T>::thread_index
+(
+    // a small index unique to the calling thread (until the index wraps)
+) noexcept
+{
+    static std::atomic<std::size_t> nextThreadIndex{0};
+    thread_local auto const threadIndex = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+    return threadIndex;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::sharded_counter<T>::shard
+(
+) noexcept -> std::atomic<T> &
+{
+    std::size_t index = 0;
+    if (shardPolicy_ == shard_policy::per_cpu)
+    {
+        // sched_getcpu is a vdso call and fails (-1) only if unsupported
+        if (auto cpu = ::sched_getcpu(); cpu >= 0)
+            index = static_cast<std::size_t>(cpu);
+        else
+            index = thread_index();
+    }
+    else
+    {
+        index = thread_index();
+    }
+    return shards_[index & mask_].get();
+}
+
+
+//=============================================================================
+template <typename T>
+inline void bcpp::system::sharded_counter<T>::add
+(
+    T value
+) noexcept
+{
+    shard().fetch_add(value, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+template <typename T>
+inline void bcpp::system::sharded_counter<T>::subtract
+(
+    T value
+) noexcept
+{
+    shard().fetch_sub(value, std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+template <typename T>
+inline T bcpp::system::sharded_counter<T>::load
+(
+) const noexcept
+{
+    T total{0};
+    for (std::size_t i = 0; i <= mask_; ++i)
+        total += shards_[i]->load(std::memory_order_relaxed);
+    return total;
+}
+
+
+//=============================================================================
+template <typename T>
+inline T bcpp::system::sharded_counter<T>::exchange
+(
+) noexcept
+{
+    T total{0};
+    for (std::size_t i = 0; i <= mask_; ++i)
+        total += shards_[i]->exchange(0, std::memory_order_relaxed);
+    return total;
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t bcpp::system::sharded_counter<T>::shard_count
+(
+) const noexcept
+{
+    return (mask_ + 1);
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <library/system/cache_line.h>
+#include <include/non_copyable.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <utility>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // spsc_queue
+    //
+    // bounded single producer single consumer ring.  the producer and consumer
+    // indices live on separate cache lines, each side keeps a cached copy of
+    // the other side's index so that the shared line is only read when the
+    // queue appears full (producer) or empty (consumer).  batch operations
+    // publish once per batch rather than once per element.
+    //=========================================================================
+    template <typename T>
+    class spsc_queue :
+        non_copyable
+    {
+    public:
+
+        using value_type = T;
+
+        explicit spsc_queue
+        (
+            std::size_t
+        );
+
+        ~spsc_queue();
+
+        template <typename U>
+        bool try_push
+        (
+            U &&
+        );
+
+        template <typename I>
+        std::size_t push
+        (
+            I,
+            I
+        );
+
+        std::optional<T> try_pop();
+
+        template <typename F>
+        std::size_t consume
+        (
+            F &&,
+            std::size_t = ~std::size_t(0)
+        );
+
+        std::size_t size() const noexcept;
+
+        std::size_t capacity() const noexcept;
+
+        bool empty() const noexcept;
+
+    private:
+
+        struct alignas(T) slot
+        {
+            std::byte   bytes_[sizeof(T)];
+        };
+
+        T * at
+        (
+            std::size_t
+        ) noexcept;
+
+        // producer side
+        alignas(cache_line_size) std::atomic<std::size_t>   tail_{0};
+        std::size_t                                         cachedHead_{0};
+
+        // consumer side
+        alignas(cache_line_size) std::atomic<std::size_t>   head_{0};
+        std::size_t                                         cachedTail_{0};
+
+        // read only after construction
+        alignas(cache_line_size) std::size_t                mask_;
+        std::unique_ptr<slot[]>                             slots_;
+
+    }; // class spsc_queue
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename T>
+inline bcpp::system::spsc_queue<T>::spsc_queue
+(
+    // capacity is rounded up to a power of two
+    std::size_t capacity
+):
+    mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+    slots_(std::make_unique<slot[]>(mask_ + 1))
+{
+}
+
+
+//=============================================================================
+template <typename T>
+inline bcpp::system::spsc_queue<T>::~spsc_queue
+(
+)
+{
+    for (auto head = head_.load(); head != tail_.load(); ++head)
+        std::destroy_at(at(head));
+}
+
+
+//=============================================================================
+template <typename T>
+inline T * bcpp::system::spsc_queue<T>::at
+(
+    std::size_t index
+) noexcept
+{
+    return std::launder(reinterpret_cast<T *>(slots_[index & mask_].bytes_));
+}
+
+
+//=============================================================================
+template <typename T>
+template <typename U>
+inline bool bcpp::system::spsc_queue<T>::try_push
+(
+    // producer only
+    U && value
+)
+{
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if ((tail - cachedHead_) > mask_)
+    {
+        cachedHead_ = head_.load(std::memory_order_acquire);
+        if ((tail - cachedHead_) > mask_)
+            return false;
+    }
+    std::construct_at(at(tail), std::forward<U>(value));
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+
+//=============================================================================
+template <typename T>
+template <typename I>
+inline std::size_t bcpp::system::spsc_queue<T>::push
+(
+    // producer only.  moves as many elements of [first, last) as fit and
+    // returns the number pushed
+    I first,
+    I last
+)
+{
+    auto tail = tail_.load(std::memory_order_relaxed);
+    auto available = (mask_ + 1) - (tail - cachedHead_);
+    if (available < static_cast<std::size_t>(std::distance(first, last)))
+    {
+        cachedHead_ = head_.load(std::memory_order_acquire);
+        available = (mask_ + 1) - (tail - cachedHead_);
+    }
+    std::size_t count = 0;
+    for (; (first != last) && (count < available); ++first, ++count)
+        std::construct_at(at(tail + count), std::move(*first));
+    if (count > 0)
+        tail_.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+
+//=============================================================================
+template <typename T>
+inline auto bcpp::system::spsc_queue<T>::try_pop
+(
+    // consumer only
+) -> std::optional<T>
+{
+    std::optional<T> result;
+    consume([&](T & value){result.emplace(std::move(value));}, 1);
+    return result;
+}
+
+
+//=============================================================================
+template <typename T>
+template <typename F>
+inline std::size_t bcpp::system::spsc_queue<T>::consume
+(
+    // consumer only.  invokes function(T &) for up to maximum elements and
+    // returns the number consumed.  the slots are released once at the end,
+    // or when function throws, in which case the element which raised the
+    // exception counts as consumed
+    F && function,
+    std::size_t maximum
+)
+{
+    struct release
+    {
+        ~release()
+        {
+            if (pending_)
+            {
+                std::destroy_at(queue_.at(head_));
+                ++head_;
+            }
+            queue_.head_.store(head_, std::memory_order_release);
+        }
+        spsc_queue &    queue_;
+        std::size_t     head_;
+        bool            pending_{false};
+    };
+
+    auto head = head_.load(std::memory_order_relaxed);
+    if (cachedTail_ == head)
+    {
+        cachedTail_ = tail_.load(std::memory_order_acquire);
+        if (cachedTail_ == head)
+            return 0;
+    }
+    auto count = std::min(cachedTail_ - head, maximum);
+    release guard{*this, head};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto value = at(guard.head_);
+        guard.pending_ = true;
+        function(*value);
+        guard.pending_ = false;
+        std::destroy_at(value);
+        ++guard.head_;
+    }
+    return count;
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t bcpp::system::spsc_queue<T>::size
+(
+    // approximate when called concurrently with push or consume
+) const noexcept
+{
+    auto head = head_.load(std::memory_order_acquire);
+    auto tail = tail_.load(std::memory_order_acquire);
+    return ((tail > head) ? (tail - head) : 0);
+}
+
+
+//=============================================================================
+template <typename T>
+inline std::size_t bcpp::system::spsc_queue<T>::capacity
+(
+) const noexcept
+{
+    return (mask_ + 1);
+}
+
+
+//=============================================================================
+template <typename T>
+inline bool bcpp::system::spsc_queue<T>::empty
+(
+) const noexcept
+{
+    return (size() == 0);
+}
@@ -0,0 +1,19 @@
+#include "./static_thread_pool.h"
+
+#include <library/system.h>
+
+#include <pthread.h>
+
+
+//=============================================================================
+void bcpp::system::detail::configure_static_worker
+(
+    cpu_id cpuId,
+    char const * name
+)
+{
+    if (cpuId != static_worker_configuration::no_cpu)
+        set_cpu_affinity(cpuId);
+    if (name[0] != '\0')
+        ::pthread_setname_np(::pthread_self(), name);
+}
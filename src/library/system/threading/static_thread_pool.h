@@ -0,0 +1,267 @@
+#pragma once
+
+#include <library/system/cpu_id.h>
+#include <library/system/cache_aligned.h>
+#include <include/non_copyable.h>
+
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <stop_token>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // static_worker_configuration
+    //
+    // the compile time configuration of a static_worker.  a structural type
+    // so that it can be given as a template argument:
+    //
+    //      static_worker<consumer, {.cpuId_ = 3, .name_ = "consumer"}>
+    //=========================================================================
+    struct static_worker_configuration
+    {
+        static cpu_id constexpr no_cpu = ~cpu_id(0);
+
+        cpu_id      cpuId_{no_cpu};
+        char        name_[16]{};    // at most 15 characters
+    };
+
+
+    //=========================================================================
+    // static_worker
+    //
+    // a worker of a static_thread_pool.  F is the worker's callable (and its
+    // per thread state) and is invoked as F::operator()(std::stop_token
+    // const &).  F may also have any of the hooks:
+    //
+    //      void initialize();                      // before operator ()
+    //      void terminate();                       // after operator () returns
+    //      void on_exception(std::exception_ptr);  // if any of the above throws
+    //
+    // which are found at compile time.  an exception with no on_exception
+    // hook terminates the process (as does a thread_pool worker with no
+    // exceptionHandler_).
+    //=========================================================================
+    template <typename F, static_worker_configuration C = static_worker_configuration{}>
+    struct static_worker
+    {
+        using function_type = F;
+
+        static auto constexpr configuration = C;
+    };
+
+
+    namespace detail
+    {
+        // name and pin the calling worker thread
+        void configure_static_worker
+        (
+            cpu_id,
+            char const *
+        );
+    }
+
+
+    //=========================================================================
+    // static_thread_pool
+    //
+    // a thread_pool for topologies which are fixed at build time.  each worker
+    // is a static_worker whose callable type, hooks and pinning are known to
+    // the compiler, so the worker loop is a direct (and inlinable) call with
+    // no std::function, no copy of a configuration into the thread and no
+    // allocation beyond the threads themselves.  each worker's callable is
+    // held in its own cache line(s) so that the state of one worker never
+    // shares a line with another's.
+    //
+    //      static_thread_pool<static_worker<producer, {.cpuId_ = 2}>,
+    //              static_worker<consumer, {.cpuId_ = 3}>> pool(queue, queue);
+    //
+    // the workers start when the pool is constructed and are stopped (stop
+    // requested and joined, in order) by stop() or by the destructor.  unlike
+    // thread_pool there is no restart policy and workers can not be added or
+    // removed.
+    //=========================================================================
+    template <typename ... Workers>
+    class static_thread_pool :
+        non_copyable
+    {
+    public:
+
+        static std::size_t constexpr worker_count = sizeof...(Workers);
+
+        static std::array<cpu_id, worker_count> constexpr cpu_ids{Workers::configuration.cpuId_ ...};
+
+        static_thread_pool()
+        requires (std::is_default_constructible_v<typename Workers::function_type> && ...);
+
+        // the callable of each worker is constructed from the corresponding argument
+        template <typename ... Args>
+        requires ((sizeof...(Args) == sizeof...(Workers)) && (std::is_constructible_v<typename Workers::function_type, Args> && ...))
+        explicit static_thread_pool
+        (
+            Args && ...
+        );
+
+        ~static_thread_pool();
+
+        void stop();
+
+        static constexpr std::size_t size() noexcept;
+
+        // the callable (state) of worker I
+        template <std::size_t I>
+        auto & get() noexcept;
+
+        template <std::size_t I>
+        auto const & get() const noexcept;
+
+    private:
+
+        void start();
+
+        template <std::size_t I>
+        void run
+        (
+            std::stop_token const &
+        );
+
+        std::tuple<cache_aligned<typename Workers::function_type> ...>  functions_;
+
+        std::array<std::jthread, worker_count>                          threads_;
+
+    }; // class static_thread_pool
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename ... Workers>
+inline bcpp::system::static_thread_pool<Workers ...>::static_thread_pool
+(
+)
+requires (std::is_default_constructible_v<typename Workers::function_type> && ...)
+{
+    start();
+}
+
+
+//=============================================================================
+template <typename ... Workers>
+template <typename ... Args>
+requires ((sizeof...(Args) == sizeof...(Workers)) && (std::is_constructible_v<typename Workers::function_type, Args> && ...))
+inline bcpp::system::static_thread_pool<Workers ...>::static_thread_pool
+(
+    Args && ... args
+):
+    functions_(std::forward<Args>(args) ...)
+{
+    start();
+}
+
+
+//=============================================================================
+template <typename ... Workers>
+inline bcpp::system::static_thread_pool<Workers ...>::~static_thread_pool
+(
+)
+{
+    stop();
+}
+
+
+//=============================================================================
+template <typename ... Workers>
+inline void bcpp::system::static_thread_pool<Workers ...>::start
+(
+    // each thread runs run<I> directly.  the callables are constructed before
+    // any thread starts
+)
+{
+    [this]<std::size_t ... I>(std::index_sequence<I ...>)
+    {
+        ((threads_[I] = std::jthread([this](std::stop_token const & stopToken){run<I>(stopToken);})), ...);
+    }(std::make_index_sequence<worker_count>{});
+}
+
+
+//=============================================================================
+template <typename ... Workers>
+template <std::size_t I>
+inline void bcpp::system::static_thread_pool<Workers ...>::run
+(
+    std::stop_token const & stopToken
+)
+{
+    using worker = std::tuple_element_t<I, std::tuple<Workers ...>>;
+    auto & function = get<I>();
+
+    detail::configure_static_worker(worker::configuration.cpuId_, worker::configuration.name_);
+    try
+    {
+        if constexpr (requires {function.initialize();})
+            function.initialize();
+        function(stopToken);
+        if constexpr (requires {function.terminate();})
+            function.terminate();
+    }
+    catch (...)
+    {
+        if constexpr (requires {function.on_exception(std::current_exception());})
+            function.on_exception(std::current_exception());
+        else
+            throw;
+    }
+}
+
+
+//=============================================================================
+template <typename ... Workers>
+inline void bcpp::system::static_thread_pool<Workers ...>::stop
+(
+)
+{
+    for (auto & thread : threads_)
+        thread.request_stop();
+    for (auto & thread : threads_)
+        if (thread.joinable())
+            thread.join();
+}
+
+
+//=============================================================================
+template <typename ... Workers>
+inline constexpr std::size_t bcpp::system::static_thread_pool<Workers ...>::size
+(
+) noexcept
+{
+    return worker_count;
+}
+
+
+//=============================================================================
+template <typename ... Workers>
+template <std::size_t I>
+inline auto & bcpp::system::static_thread_pool<Workers ...>::get
+(
+) noexcept
+{
+    return std::get<I>(functions_).get();
+}
+
+
+//=============================================================================
+template <typename ... Workers>
+template <std::size_t I>
+inline auto const & bcpp::system::static_thread_pool<Workers ...>::get
+(
+) const noexcept
+{
+    return std::get<I>(functions_).get();
+}
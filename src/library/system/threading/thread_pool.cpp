@@ -2,14 +2,45 @@
 
 #include <library/system.h>
 
+#include <algorithm>
+#include <set>
+#include <system_error>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
 
 namespace 
 {
+
+    using thread_count = bcpp::system::thread_pool::thread_count;
+
+
+    //=========================================================================
+    void release_thread_count
+    (
+        // wakes wait_stop_complete() when the last thread is released
+        thread_count & counter,
+        std::mutex & mutex,
+        std::condition_variable & conditionVariable
+    )
+    {
+        if (--counter.get() == 0)
+        {
+            std::lock_guard lockGuard(mutex);
+            conditionVariable.notify_all();
+        }
+    }
+
+
+    //=========================================================================
     struct thread_counter
     {
         thread_counter
         (
-            std::shared_ptr<std::atomic<std::size_t>> counter,
+            std::shared_ptr<thread_count> counter,
             std::shared_ptr<std::mutex> mutex,
             std::shared_ptr<std::condition_variable> conditionVariable
         ):
@@ -17,23 +48,100 @@ namespace
             mutex_(mutex), 
             conditionVariable_(conditionVariable)
         {
-            ++(*counter_);
         }
 
 
         ~thread_counter()
         {
-            if (--(*counter_) == 0)
-            {
-                std::lock_guard lockGuard(*mutex_);
-                conditionVariable_->notify_all();
-            }
+            release_thread_count(*counter_, *mutex_, *conditionVariable_);
         }
 
-        std::shared_ptr<std::atomic<std::size_t>> counter_;
+        std::shared_ptr<thread_count> counter_;
         std::shared_ptr<std::mutex> mutex_;
         std::shared_ptr<std::condition_variable> conditionVariable_;
     };
+
+
+    //=========================================================================
+    // records when a worker exits so that a retired worker can be joined
+    // without blocking and so that ordered_stop can report stop durations
+    struct exit_recorder
+    {
+        exit_recorder
+        (
+            std::shared_ptr<std::atomic<std::int64_t>> exitTime
+        ):
+            exitTime_(exitTime)
+        {
+        }
+
+
+        ~exit_recorder()
+        {
+            *exitTime_ = std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        std::shared_ptr<std::atomic<std::int64_t>> exitTime_;
+    };
+
+
+    //=========================================================================
+    void apply_thread_configuration
+    (
+        // configure the calling (worker) thread
+        bcpp::system::thread_pool::thread_configuration const & config
+    )
+    {
+        using scheduling_policy = bcpp::system::thread_pool::scheduling_policy;
+
+        if (!config.name_.empty())
+            ::pthread_setname_np(::pthread_self(), config.name_.substr(0, 15).c_str());
+
+        if (config.schedulingPolicy_.has_value())
+        {
+            std::int32_t policy = SCHED_OTHER;
+            switch (*config.schedulingPolicy_)
+            {
+                case scheduling_policy::other: policy = SCHED_OTHER; break;
+                case scheduling_policy::batch: policy = SCHED_BATCH; break;
+                case scheduling_policy::idle: policy = SCHED_IDLE; break;
+                case scheduling_policy::fifo: policy = SCHED_FIFO; break;
+                case scheduling_policy::round_robin: policy = SCHED_RR; break;
+            }
+            auto realTime = ((policy == SCHED_FIFO) || (policy == SCHED_RR));
+            sched_param schedParam{};
+            schedParam.sched_priority = realTime ? config.priority_ : 0;
+            if (auto error = ::pthread_setschedparam(::pthread_self(), policy, &schedParam); error != 0)
+                throw std::system_error(error, std::system_category(), "pthread_setschedparam");
+            if ((!realTime) && (policy != SCHED_IDLE))
+                if (::setpriority(PRIO_PROCESS, ::gettid(), config.priority_) != 0)
+                    throw std::system_error(errno, std::system_category(), "setpriority");
+        }
+
+        if (config.prefaultStack_)
+        {
+            // touch every page of the stack below the current frame so that
+            // the worker does not take page faults as its stack grows
+            pthread_attr_t attributes;
+            if (::pthread_getattr_np(::pthread_self(), &attributes) == 0)
+            {
+                void * stackAddress = nullptr;
+                std::size_t stackSize = 0;
+                ::pthread_attr_getstack(&attributes, &stackAddress, &stackSize);
+                ::pthread_attr_destroy(&attributes);
+
+                auto pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+                auto bottom = reinterpret_cast<std::size_t>(stackAddress) + pageSize;
+                auto current = reinterpret_cast<std::size_t>(__builtin_frame_address(0)) & ~(pageSize - 1);
+                for (auto page = current - pageSize; page >= bottom; page -= pageSize)
+                {
+                    auto volatile * address = reinterpret_cast<char volatile *>(page);
+                    *address = *address;
+                }
+            }
+        }
+    }
+
 }
 
 
@@ -53,51 +161,264 @@ bcpp::system::thread_pool::thread_pool
 bcpp::system::thread_pool::thread_pool
 (
     std::vector<thread_configuration> const & threadConfigurations
-):
-    threads_(threadConfigurations.size()),
-    threadCount_(std::make_shared<std::atomic<std::size_t>>(0)),
-    mutex_(std::make_shared<std::mutex>()),
-    conditionVariable_(std::make_shared<std::condition_variable>())
+)
+{
+    for (auto const & threadConfiguration : threadConfigurations)
+        add_thread(threadConfiguration);
+}
+
+
+//=============================================================================
+bcpp::system::thread_pool::~thread_pool
+(
+)
 {
-    auto index = 0;
-    for (auto & thread : threads_)
+    stop();
+}
+
+
+//=============================================================================
+auto bcpp::system::thread_pool::start_worker
+(
+    thread_id threadId,
+    thread_configuration const & threadConfiguration
+) -> std::unique_ptr<worker>
+{
+    auto newWorker = std::make_unique<worker>();
+    newWorker->id_ = threadId;
+    newWorker->cpuId_ = threadConfiguration.cpuId_;
+    newWorker->restartCount_ = std::make_shared<std::atomic<std::size_t>>(0);
+    newWorker->exitTime_ = std::make_shared<std::atomic<std::int64_t>>(0);
+    newWorker->name_ = threadConfiguration.name_;
+    newWorker->stopGroup_ = threadConfiguration.stopGroup_;
+    newWorker->isDrained_ = threadConfiguration.isDrained_;
+
+    // counted before the thread starts so that wait_stop_complete can not
+    // observe zero running threads before the thread has begun
+    ++threadCount_->get();
+    try
     {
-        thread = std::jthread([config = threadConfigurations[index], threadCount = threadCount_, mutex = mutex_, conditionVariable = conditionVariable_]
+        newWorker->thread_.start(threadConfiguration.stackSize_, threadConfiguration.guardPage_, [config = threadConfiguration, threadCount = threadCount_, mutex = mutex_,
+                conditionVariable = conditionVariable_, restartCount = newWorker->restartCount_, exitTime = newWorker->exitTime_]
                 (
                     std::stop_token const & stopToken
                 )
                 {
                     thread_counter threadCounter(threadCount, mutex, conditionVariable);
-                    try
+                    exit_recorder exitRecorder(exitTime);
+                    auto configured = false;
+                    while (true)
                     {
-                        if (config.cpuId_.has_value())
-                            set_cpu_affinity(config.cpuId_.value());
-                        if (config.initializeHandler_)
-                            config.initializeHandler_();
-                        config.function_(stopToken);
-                        if (config.terminateHandler_)
-                            config.terminateHandler_();
-                    }
-                    catch (...)
-                    {
-                        auto currentException = std::current_exception();
-                        if (config.exceptionHandler_)
-                            config.exceptionHandler_(currentException);
-                        else
-                            std::rethrow_exception(currentException);
+                        try
+                        {
+                            if (!configured)
+                            {
+                                if (config.cpuId_.has_value())
+                                    set_cpu_affinity(config.cpuId_.value());
+                                apply_thread_configuration(config);
+                                configured = true;
+                            }
+                            if (config.initializeHandler_)
+                                config.initializeHandler_();
+                            config.function_(stopToken);
+                            if (config.terminateHandler_)
+                                config.terminateHandler_();
+                            if (config.restartPolicy_.mode_ != restart_mode::always)
+                                return;
+                        }
+                        catch (...)
+                        {
+                            auto currentException = std::current_exception();
+                            if (config.exceptionHandler_)
+                                config.exceptionHandler_(currentException);
+                            else if ((!configured) || (config.restartPolicy_.mode_ == restart_mode::never))
+                                std::rethrow_exception(currentException);
+                            if ((!configured) || (config.restartPolicy_.mode_ == restart_mode::never))
+                                return;
+                        }
+
+                        if ((stopToken.stop_requested()) || (restartCount->load() >= config.restartPolicy_.maximumRestarts_))
+                            return;
+                        ++(*restartCount);
+
+                        // back off before restarting.  wakes early if stop is requested
+                        std::mutex delayMutex;
+                        std::condition_variable_any delayConditionVariable;
+                        std::unique_lock uniqueLock(delayMutex);
+                        if (delayConditionVariable.wait_for(uniqueLock, stopToken, config.restartPolicy_.delay_, [&](){return stopToken.stop_requested();}))
+                            return;
                     }
                 });
-        ++index;
     }
+    catch (...)
+    {
+        // the thread never started so take back its count
+        release_thread_count(*threadCount_, *mutex_, *conditionVariable_);
+        throw;
+    }
+    return newWorker;
 }
 
 
 //=============================================================================
-bcpp::system::thread_pool::~thread_pool
+auto bcpp::system::thread_pool::add_thread
 (
+    // start a new worker.  may be called at any time, including from within
+    // a worker of this pool.  returns the id of the new worker or empty if
+    // the pool has been stopped (in which case no worker is started)
+    thread_configuration const & threadConfiguration
+) -> std::optional<thread_id>
+{
+    std::lock_guard lockGuard(workersMutex_);
+    reap_retired_workers();
+    if (stopped_)
+        return std::nullopt;
+    auto threadId = nextThreadId_++;
+    workers_.push_back(start_worker(threadId, threadConfiguration));
+    return threadId;
+}
+
+
+//=============================================================================
+bool bcpp::system::thread_pool::remove_thread
+(
+    // request the worker to stop and remove it from the pool.  if blocking
+    // waits for the worker to exit, otherwise the worker is joined later.
+    // a worker can remove itself (non blocking only).
+    thread_id threadId,
+    synchronization_mode stopMode
 )
 {
-    stop();
+    std::unique_ptr<worker> removedWorker;
+    {
+        std::lock_guard lockGuard(workersMutex_);
+        auto iter = std::find_if(workers_.begin(), workers_.end(), [threadId](auto const & w){return (w->id_ == threadId);});
+        if (iter == workers_.end())
+            return false;
+        removedWorker = std::move(*iter);
+        workers_.erase(iter);
+        removedWorker->thread_.request_stop();
+        if ((stopMode != synchronization_mode::blocking) || (removedWorker->thread_.is_current()))
+        {
+            retiredWorkers_.push_back(std::move(removedWorker));
+            return true;
+        }
+    }
+    if (removedWorker->thread_.joinable())
+        removedWorker->thread_.join();
+    return true;
+}
+
+
+//=============================================================================
+void bcpp::system::thread_pool::reap_retired_workers
+(
+    // join retired workers which have already exited.  workersMutex_ must be held
+)
+{
+    std::erase_if(retiredWorkers_, [](auto const & retiredWorker)
+            {
+                auto & thread = retiredWorker->thread_;
+                if ((retiredWorker->exitTime_->load() == 0) || (thread.is_current()))
+                    return false;
+                if (thread.joinable())
+                    thread.join();  // has exited (or is about to) so does not block
+                return true;
+            });
+}
+
+
+//=============================================================================
+auto bcpp::system::thread_pool::get_thread_ids
+(
+) const -> std::vector<thread_id>
+{
+    std::lock_guard lockGuard(workersMutex_);
+    std::vector<thread_id> threadIds;
+    for (auto const & w : workers_)
+        threadIds.push_back(w->id_);
+    return threadIds;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::thread_pool::size
+(
+) const
+{
+    std::lock_guard lockGuard(workersMutex_);
+    return workers_.size();
+}
+
+
+//=============================================================================
+auto bcpp::system::thread_pool::get_pinned_cpus
+(
+    // the cpus to which workers of this pool are pinned
+) const -> std::vector<cpu_id>
+{
+    std::lock_guard lockGuard(workersMutex_);
+    std::vector<cpu_id> cpus;
+    for (auto const & w : workers_)
+        if ((w->cpuId_.has_value()) && (std::find(cpus.begin(), cpus.end(), *w->cpuId_) == cpus.end()))
+            cpus.push_back(*w->cpuId_);
+    return cpus;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::thread_pool::get_restart_count
+(
+    thread_id threadId
+) const
+{
+    std::lock_guard lockGuard(workersMutex_);
+    for (auto const & w : workers_)
+        if (w->id_ == threadId)
+            return w->restartCount_->load();
+    return 0;
+}
+
+
+//=============================================================================
+auto bcpp::system::thread_pool::wrap_handlers
+(
+    // attach runs before the initialize handler and detach after the terminate
+    // handler.  without an exception handler the pool applies its restart
+    // policy itself so detach is not called on an exception: attach must
+    // replace whatever a previous run left and a thread_local must clean up
+    // after a worker which exits.  with one, detach runs before it.
+    thread_configuration config,
+    std::function<void()> attach,
+    std::function<void()> detach
+) -> thread_configuration
+{
+    config.initializeHandler_ = [attach, handler = std::move(config.initializeHandler_)]
+            (
+            )
+            {
+                attach();
+                if (handler)
+                    handler();
+            };
+    config.terminateHandler_ = [detach, handler = std::move(config.terminateHandler_)]
+            (
+            )
+            {
+                if (handler)
+                    handler();
+                detach();
+            };
+    if (config.exceptionHandler_)
+        config.exceptionHandler_ = [detach, handler = std::move(config.exceptionHandler_)]
+                (
+                    std::exception_ptr exception
+                )
+                {
+                    detach();
+                    handler(exception);
+                };
+    return config;
 }
 
 
@@ -119,13 +440,155 @@ void bcpp::system::thread_pool::stop
     synchronization_mode stopMode
 )
 {       
-    for (auto & thread : threads_)
-        thread.request_stop();
+    std::vector<std::unique_ptr<worker>> workers;
+    {
+        std::lock_guard lockGuard(workersMutex_);
+        stopped_ = true;
+        for (auto & w : workers_)
+            w->thread_.request_stop();
+        if (stopMode != synchronization_mode::blocking)
+            return;
+        // joined outside of the lock so that workers which add or remove
+        // workers while stopping do not deadlock
+        workers = std::move(workers_);
+        workers_.clear();
+        for (auto & w : retiredWorkers_)
+            workers.push_back(std::move(w));
+        retiredWorkers_.clear();
+    }
 
-    if (stopMode == synchronization_mode::blocking)
-        for (auto & thread : threads_)
-            if (thread.joinable())
-                thread.join();
+    for (auto & w : workers)
+        if ((w->thread_.joinable()) && (!w->thread_.is_current()))
+            w->thread_.join();
+}
+
+
+//=============================================================================
+auto bcpp::system::thread_pool::ordered_stop
+(
+    // stop the pool one group at a time.  a group is stopped only once every
+    // group listed in its after_ has been stopped.  each group is first given
+    // up to drainTimeout_ for all of its threads' isDrained_ to return true
+    // and then up to stopTimeout_ to exit after stop is requested.  threads
+    // whose stopGroup_ is not listed are stopped last as a single group.
+    // never blocks beyond the timeouts.  threads which failed to exit are
+    // kept and joined when the pool is destroyed.
+    std::vector<stop_group> const & stopGroups
+) -> stop_report
+{
+    static auto constexpr poll_interval = std::chrono::microseconds(100);
+    using clock = std::chrono::steady_clock;
+
+    std::vector<std::unique_ptr<worker>> workers;
+    {
+        std::lock_guard lockGuard(workersMutex_);
+        stopped_ = true;
+        workers = std::move(workers_);
+        workers_.clear();
+    }
+
+    // order the groups so that each follows the groups it must stop after
+    std::vector<stop_group> remaining(stopGroups);
+    std::vector<stop_group> order;
+    std::set<std::string> stoppedGroups;
+    while (!remaining.empty())
+    {
+        auto ready = std::find_if(remaining.begin(), remaining.end(), [&](auto const & group)
+                {
+                    return std::all_of(group.after_.begin(), group.after_.end(), [&](auto const & name)
+                            {
+                                return ((stoppedGroups.contains(name)) || (std::none_of(remaining.begin(), remaining.end(), 
+                                        [&](auto const & other){return (other.name_ == name);})));
+                            });
+                });
+        if (ready == remaining.end())
+            ready = remaining.begin();  // dependency cycle.  fall back to declaration order
+        stoppedGroups.insert(ready->name_);
+        order.push_back(*ready);
+        remaining.erase(ready);
+    }
+    std::set<std::string> listedGroups;
+    for (auto const & group : order)
+        listedGroups.insert(group.name_);
+    order.push_back({});    // threads in unlisted groups
+
+    stop_report report{.complete_ = true};
+    for (auto const & group : order)
+    {
+        auto isInGroup = [&](auto const & w)
+                {
+                    return (w) && ((group.name_ == w->stopGroup_) || 
+                            ((&group == &order.back()) && (!listedGroups.contains(w->stopGroup_))));
+                };
+        std::vector<worker *> members;
+        for (auto & w : workers)
+            if (isInGroup(w))
+                members.push_back(w.get());
+        if (members.empty())
+            continue;
+
+        auto firstReport = report.threads_.size();
+        for (auto w : members)
+            report.threads_.push_back({.id_ = w->id_, .name_ = w->name_, .stopGroup_ = w->stopGroup_});
+
+        // drain.  the group is drained once every thread reports drained in the same pass
+        auto drainStart = clock::now();
+        while (true)
+        {
+            auto allDrained = true;
+            for (std::size_t i = 0; i < members.size(); ++i)
+            {
+                auto & threadReport = report.threads_[firstReport + i];
+                auto drained = ((!members[i]->isDrained_) || (members[i]->exitTime_->load() != 0) || (members[i]->isDrained_()));
+                if ((drained) && (!threadReport.drained_))
+                    threadReport.drainDuration_ = (clock::now() - drainStart);
+                threadReport.drained_ = drained;
+                allDrained &= drained;
+            }
+            if ((allDrained) || ((clock::now() - drainStart) >= group.drainTimeout_))
+                break;
+            std::this_thread::sleep_for(poll_interval);
+        }
+        for (std::size_t i = 0; i < members.size(); ++i)
+            if (!report.threads_[firstReport + i].drained_)
+                report.threads_[firstReport + i].drainDuration_ = (clock::now() - drainStart);
+
+        // stop
+        auto stopStart = clock::now();
+        for (auto w : members)
+            w->thread_.request_stop();
+        while (true)
+        {
+            auto allStopped = std::all_of(members.begin(), members.end(), [](auto w){return (w->exitTime_->load() != 0);});
+            if ((allStopped) || ((clock::now() - stopStart) >= group.stopTimeout_))
+                break;
+            std::this_thread::sleep_for(poll_interval);
+        }
+        for (std::size_t i = 0; i < members.size(); ++i)
+        {
+            auto & threadReport = report.threads_[firstReport + i];
+            auto exitTime = members[i]->exitTime_->load();
+            threadReport.stopped_ = (exitTime != 0);
+            threadReport.stopDuration_ = threadReport.stopped_ ? 
+                    std::max(clock::time_point(clock::duration(exitTime)) - stopStart, clock::duration(0)) : (clock::now() - stopStart);
+            report.complete_ &= ((threadReport.drained_) && (threadReport.stopped_));
+        }
+        for (auto & w : workers)
+        {
+            if ((!isInGroup(w)) || (w->exitTime_->load() == 0) || (w->thread_.is_current()))
+                continue;
+            if (w->thread_.joinable())
+                w->thread_.join();
+            w.reset();
+        }
+    }
+
+    // threads which did not stop in time remain retired
+    std::lock_guard lockGuard(workersMutex_);
+    for (auto & w : workers)
+        if (w)
+            retiredWorkers_.push_back(std::move(w));
+    return report;
 }
 
 
@@ -136,7 +599,7 @@ bool bcpp::system::thread_pool::wait_stop_complete
 ) const
 {
     std::unique_lock uniqueLock(*mutex_);
-    return conditionVariable_->wait_for(uniqueLock, duration, [this](){return ((*threadCount_) == 0);});
+    return conditionVariable_->wait_for(uniqueLock, duration, [this](){return (threadCount_->get() == 0);});
 }
 
 
@@ -146,5 +609,97 @@ void bcpp::system::thread_pool::wait_stop_complete
 ) const
 {
     std::unique_lock uniqueLock(*mutex_);
-    return conditionVariable_->wait(uniqueLock, [this](){return ((*threadCount_) == 0);});
+    return conditionVariable_->wait(uniqueLock, [this](){return (threadCount_->get() == 0);});
+}
+
+
+//=============================================================================
+bcpp::system::thread_pool::native_thread::~native_thread
+(
+)
+{
+    if (!joinable_)
+        return;
+    request_stop();
+    if (is_current())
+        ::pthread_detach(handle_);
+    else
+        ::pthread_join(handle_, nullptr);
+}
+
+
+//=============================================================================
+void bcpp::system::thread_pool::native_thread::start
+(
+    // a stack size of zero (and a guard page) means the process default
+    std::size_t stackSize,
+    bool guardPage,
+    std::function<void(std::stop_token)> function
+)
+{
+    struct start_state
+    {
+        std::function<void(std::stop_token)>    function_;
+        std::stop_token                         stopToken_;
+    };
+
+    pthread_attr_t attributes;
+    ::pthread_attr_init(&attributes);
+    if (stackSize != 0)
+        ::pthread_attr_setstacksize(&attributes, std::max<std::size_t>(stackSize, PTHREAD_STACK_MIN));
+    if (!guardPage)
+        ::pthread_attr_setguardsize(&attributes, 0);
+
+    auto state = std::make_unique<start_state>(std::move(function), stopSource_.get_token());
+    auto error = ::pthread_create(&handle_, &attributes, [](void * argument) noexcept -> void *
+            {
+                // an exception which escapes the function terminates, as it does for std::thread
+                std::unique_ptr<start_state> state(static_cast<start_state *>(argument));
+                state->function_(state->stopToken_);
+                return nullptr;
+            }, state.get());
+    ::pthread_attr_destroy(&attributes);
+    if (error != 0)
+        throw std::system_error(error, std::system_category(), "pthread_create");
+    state.release();
+    joinable_ = true;
+}
+
+
+//=============================================================================
+void bcpp::system::thread_pool::native_thread::request_stop
+(
+)
+{
+    stopSource_.request_stop();
+}
+
+
+//=============================================================================
+bool bcpp::system::thread_pool::native_thread::joinable
+(
+) const
+{
+    return joinable_;
+}
+
+
+//=============================================================================
+void bcpp::system::thread_pool::native_thread::join
+(
+)
+{
+    if (!joinable_)
+        return;
+    ::pthread_join(handle_, nullptr);
+    joinable_ = false;
+}
+
+
+//=============================================================================
+bool bcpp::system::thread_pool::native_thread::is_current
+(
+) const
+{
+    return ((joinable_) && (::pthread_equal(handle_, ::pthread_self()) != 0));
 }
@@ -2,6 +2,7 @@
 
 #include <include/non_copyable.h>
 #include <library/system/cpu_id.h>
+#include <library/system/cache_aligned.h>
 #include <include/synchronization_mode.h>
 
 #include <exception>
@@ -16,6 +17,11 @@
 #include <chrono>
 #include <memory>
 #include <atomic>
+#include <limits>
+#include <string>
+#include <stop_token>
+
+#include <pthread.h>
 
 
 namespace bcpp::system 
@@ -26,6 +32,33 @@ namespace bcpp::system
     {
     public:
 
+        enum class scheduling_policy
+        {
+            other,          // SCHED_OTHER - priority is the nice value
+            batch,          // SCHED_BATCH - priority is the nice value
+            idle,           // SCHED_IDLE
+            fifo,           // SCHED_FIFO - priority is the real time priority
+            round_robin     // SCHED_RR - priority is the real time priority
+        };
+
+        enum class restart_mode
+        {
+            never,
+            on_exception,   // re-run the worker if it exits with an exception
+            always          // re-run the worker whenever it exits before stop is requested
+        };
+
+        struct restart_policy
+        {
+            restart_mode                mode_{restart_mode::never};
+            std::size_t                 maximumRestarts_{std::numeric_limits<std::size_t>::max()};
+            std::chrono::nanoseconds    delay_{std::chrono::milliseconds(10)};
+        };
+
+        using thread_id = std::uint64_t;
+
+        using thread_count = cache_aligned<std::atomic<std::size_t>>;
+
         struct thread_configuration
         {
             std::function<void()>                           initializeHandler_;
@@ -33,6 +66,48 @@ namespace bcpp::system
             std::function<void(std::exception_ptr)>         exceptionHandler_; 
             std::function<void(std::stop_token const &)>    function_;
             std::optional<cpu_id>                           cpuId_;
+            // applied within the thread before initializeHandler_ is invoked.
+            // failure to apply the scheduling policy is reported to the
+            // exceptionHandler_ as a std::system_error
+            std::string                                     name_;
+            std::optional<scheduling_policy>                schedulingPolicy_;
+            std::int32_t                                    priority_{0};
+            // applied when the thread is created.  zero means the default
+            std::size_t                                     stackSize_{0};
+            bool                                            guardPage_{true};
+            bool                                            prefaultStack_{false};
+            // a restarted worker stays on its thread (and cpu) and runs
+            // initializeHandler_, function_ and terminateHandler_ again
+            restart_policy                                  restartPolicy_;
+            // used by ordered_stop.  isDrained_ is called from the stopping
+            // thread and returns true once the worker has no work in flight
+            std::string                                     stopGroup_;
+            std::function<bool()>                           isDrained_;
+        };
+
+        struct stop_group
+        {
+            std::string                 name_;
+            std::vector<std::string>    after_;         // groups which must be stopped before this one
+            std::chrono::nanoseconds    drainTimeout_{0};
+            std::chrono::nanoseconds    stopTimeout_{std::chrono::seconds(5)};
+        };
+
+        struct thread_stop_report
+        {
+            thread_id                   id_;
+            std::string                 name_;
+            std::string                 stopGroup_;
+            bool                        drained_;
+            bool                        stopped_;
+            std::chrono::nanoseconds    drainDuration_;
+            std::chrono::nanoseconds    stopDuration_;  // from stop requested until the thread exited
+        };
+
+        struct stop_report
+        {
+            std::vector<thread_stop_report> threads_;   // in the order in which they were stopped
+            bool                            complete_;  // every thread drained and stopped within its timeouts
         };
 
         thread_pool() = default;
@@ -54,6 +129,11 @@ namespace bcpp::system
 
         void stop(synchronization_mode);
 
+        stop_report ordered_stop
+        (
+            std::vector<stop_group> const &
+        );
+
         bool wait_stop_complete
         (
             std::chrono::nanoseconds
@@ -61,17 +141,115 @@ namespace bcpp::system
 
         void wait_stop_complete() const;
 
+        std::optional<thread_id> add_thread
+        (
+            thread_configuration const &
+        );
+
+        bool remove_thread
+        (
+            thread_id,
+            synchronization_mode = synchronization_mode::blocking
+        );
+
+        std::vector<thread_id> get_thread_ids() const;
+
+        std::size_t size() const;
+
+        std::vector<cpu_id> get_pinned_cpus() const;
+
+        std::size_t get_restart_count
+        (
+            thread_id
+        ) const;
+
+        // per thread state for the worker (ie: stats_segment::instrument)
+        static thread_configuration wrap_handlers
+        (
+            thread_configuration,
+            std::function<void()> attach,
+            std::function<void()> detach
+        );
+
     private:
+
+        // a thread with the stop_token semantics of std::jthread but created
+        // (pthread_create) with its own attributes, so that the stack size and
+        // guard page of one worker never change the process defaults
+        class native_thread :
+            non_copyable
+        {
+        public:
+
+            native_thread() = default;
+
+            // requests stop and joins (or detaches if called by the thread itself)
+            ~native_thread();
+
+            // throws std::system_error if the thread can not be created
+            void start
+            (
+                std::size_t,
+                bool,
+                std::function<void(std::stop_token)>
+            );
+
+            void request_stop();
+
+            bool joinable() const;
+
+            void join();
+
+            // true if called by the thread itself
+            bool is_current() const;
+
+        private:
+
+            pthread_t           handle_{};
+
+            bool                joinable_{false};
+
+            std::stop_source    stopSource_;
+        };
+
+        struct worker
+        {
+            thread_id                                   id_;
+            std::optional<cpu_id>                       cpuId_;
+            std::shared_ptr<std::atomic<std::size_t>>   restartCount_;
+            std::shared_ptr<std::atomic<std::int64_t>>  exitTime_;    // steady_clock.  zero while running
+            std::string                                 name_;
+            std::string                                 stopGroup_;
+            std::function<bool()>                       isDrained_;
+            native_thread                               thread_;
+        };
+
+        std::unique_ptr<worker> start_worker
+        (
+            thread_id,
+            thread_configuration const &
+        );
+
+        void reap_retired_workers();
     
         synchronization_mode                        stopMode_{synchronization_mode::blocking};
 
-        std::vector<std::jthread>                   threads_;
+        mutable std::mutex                          workersMutex_;
+
+        std::vector<std::unique_ptr<worker>>        workers_;
+
+        std::vector<std::unique_ptr<worker>>        retiredWorkers_;
+
+        thread_id                                   nextThreadId_{0};
+
+        bool                                        stopped_{false};
 
-        std::shared_ptr<std::atomic<std::size_t>>   threadCount_;
+        // written by every worker as it exits so kept off the lines of the shared_ptr control blocks
+        std::shared_ptr<thread_count>               threadCount_{std::make_shared<thread_count>()};
 
-        std::shared_ptr<std::mutex>                 mutex_;
+        std::shared_ptr<std::mutex>                 mutex_{std::make_shared<std::mutex>()};
         
-        std::shared_ptr<std::condition_variable>    conditionVariable_;
+        std::shared_ptr<std::condition_variable>    conditionVariable_{std::make_shared<std::condition_variable>()};
     };
     
 } // namespace bcpp::system 
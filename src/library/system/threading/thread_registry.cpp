@@ -0,0 +1,103 @@
+#include "./thread_registry.h"
+
+#include <algorithm>
+
+
+namespace
+{
+
+    using unregister_handler = std::function<void(void *)>;
+
+    std::mutex ownersMutex;
+    std::vector<std::pair<std::uint64_t, unregister_handler>> owners;
+    std::uint64_t nextOwnerId = 1;
+
+
+    //=========================================================================
+    // the calling thread's record of each owner which it is registered with.
+    // unregisters the thread from those owners which remain as it exits
+    struct registrations
+    {
+        ~registrations()
+        {
+            std::lock_guard lockGuard(ownersMutex);
+            for (auto const & [id, record] : std::exchange(records_, {}))
+                for (auto const & [ownerId, unregisterHandler] : owners)
+                    if (ownerId == id)
+                        unregisterHandler(record);
+        }
+
+        std::vector<std::pair<std::uint64_t, void *>> records_;
+    };
+
+    thread_local registrations threadRegistrations;
+
+} // namespace
+
+
+//=============================================================================
+std::uint64_t bcpp::system::detail::thread_registration::add_owner
+(
+    unregister_handler unregisterHandler
+)
+{
+    std::lock_guard lockGuard(ownersMutex);
+    owners.emplace_back(nextOwnerId, std::move(unregisterHandler));
+    return nextOwnerId++;
+}
+
+
+//=============================================================================
+void bcpp::system::detail::thread_registration::remove_owner
+(
+    // the owner's records may be freed once this returns.  ids are never
+    // reused so the registrations of other threads which remain are ignored
+    std::uint64_t id
+)
+{
+    {
+        std::lock_guard lockGuard(ownersMutex);
+        std::erase_if(owners, [id](auto const & owner){return (owner.first == id);});
+    }
+    std::erase_if(threadRegistrations.records_, [id](auto const & record){return (record.first == id);});
+}
+
+
+//=============================================================================
+void * bcpp::system::detail::thread_registration::find
+(
+    std::uint64_t id
+)
+{
+    for (auto const & [ownerId, record] : threadRegistrations.records_)
+        if (ownerId == id)
+            return record;
+    return nullptr;
+}
+
+
+//=============================================================================
+void bcpp::system::detail::thread_registration::add
+(
+    std::uint64_t id,
+    void * record
+)
+{
+    threadRegistrations.records_.emplace_back(id, record);
+}
+
+
+//=============================================================================
+void * bcpp::system::detail::thread_registration::remove
+(
+    std::uint64_t id
+)
+{
+    auto & records = threadRegistrations.records_;
+    auto iter = std::find_if(records.begin(), records.end(), [id](auto const & record){return (record.first == id);});
+    if (iter == records.end())
+        return nullptr;
+    auto * record = iter->second;
+    records.erase(iter);
+    return record;
+}
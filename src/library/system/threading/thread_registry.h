@@ -0,0 +1,309 @@
+#pragma once
+
+#include "./thread_pool.h"
+
+#include <include/non_copyable.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    namespace detail
+    {
+
+        //=====================================================================
+        // the registrations of the calling thread, by owner id.  an owner
+        // is listed (with the handler which unregisters a thread from it)
+        // until it is destroyed so that a thread which exits while still
+        // registered is unregistered from every owner which remains
+        class thread_registration
+        {
+        public:
+
+            static std::uint64_t add_owner
+            (
+                std::function<void(void *)>
+            );
+
+            static void remove_owner
+            (
+                std::uint64_t
+            );
+
+            static void * find
+            (
+                std::uint64_t
+            );
+
+            static void add
+            (
+                std::uint64_t,
+                void *
+            );
+
+            static void * remove
+            (
+                std::uint64_t
+            );
+        };
+
+    } // namespace detail
+
+
+    //=========================================================================
+    // thread_registry
+    //
+    // the per thread records of a reclaimer (ie: epoch_reclaimer and
+    // hazard_pointer_domain).  a thread registers on first use and takes a
+    // record - reusing one released by an exited thread where possible.
+    // records are never removed (only reused) so may be scanned without a
+    // lock.  the nodes retired by a thread which unregisters become orphans
+    // to be reclaimed by the other threads.  a thread which exits while
+    // registered (ie: one which registered implicitly) is unregistered as it
+    // exits.
+    //
+    // R has inUse_ (std::atomic<bool>), next_ (R *) and retired_ (a vector
+    // of N).  N has node_ (void *) and deleter_ (void(*)(void *)).
+    //=========================================================================
+    template <typename R, typename N>
+    class thread_registry :
+        non_copyable
+    {
+    public:
+
+        struct configuration
+        {
+            std::function<R *()>        create_;    // a new record
+            std::function<void(R &)>    release_;   // clears the state of a record as its thread unregisters
+        };
+
+        explicit thread_registry
+        (
+            configuration
+        );
+
+        // deletes every node still retired
+        ~thread_registry();
+
+        // the calling thread's record.  registers the thread if required
+        R & get();
+
+        void unregister_thread();
+
+        // the worker with registration added to its handlers
+        thread_pool::thread_configuration attach
+        (
+            thread_pool::thread_configuration
+        );
+
+        R * front() const;
+
+        std::size_t size() const;
+
+        bool has_orphans() const;
+
+        // reclaim(std::vector<N> &) deletes what it can and leaves the rest
+        template <typename F>
+        std::size_t reclaim_orphans
+        (
+            F
+        );
+
+    private:
+
+        void release
+        (
+            R &
+        );
+
+        configuration                   configuration_;
+
+        std::atomic<R *>                records_{nullptr};
+
+        std::atomic<std::size_t>        recordCount_{0};
+
+        std::mutex                      orphanMutex_;
+
+        std::vector<N>                  orphans_;           // retired by threads which have exited
+
+        std::atomic<bool>               hasOrphans_{false};
+
+        // last so that it is listed once the rest is constructed
+        std::uint64_t                   id_;
+
+    }; // class thread_registry
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+template <typename R, typename N>
+bcpp::system::thread_registry<R, N>::thread_registry
+(
+    configuration config
+):
+    configuration_(std::move(config)),
+    id_(detail::thread_registration::add_owner([this](void * record){release(*static_cast<R *>(record));}))
+{
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+bcpp::system::thread_registry<R, N>::~thread_registry
+(
+)
+{
+    // no exiting thread uses the records once the owner is removed
+    detail::thread_registration::remove_owner(id_);
+    auto * record = records_.load(std::memory_order_acquire);
+    while (record != nullptr)
+    {
+        for (auto & retiredNode : record->retired_)
+            retiredNode.deleter_(retiredNode.node_);
+        delete std::exchange(record, record->next_);
+    }
+    for (auto & retiredNode : orphans_)
+        retiredNode.deleter_(retiredNode.node_);
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+inline R & bcpp::system::thread_registry<R, N>::get
+(
+)
+{
+    if (auto * record = detail::thread_registration::find(id_); record != nullptr)
+        return *static_cast<R *>(record);
+
+    // reuse the record of an exited thread or else add a record
+    R * record = records_.load(std::memory_order_acquire);
+    for (; record != nullptr; record = record->next_)
+    {
+        auto inUse = false;
+        if ((!record->inUse_.load(std::memory_order_relaxed)) &&
+                (record->inUse_.compare_exchange_strong(inUse, true, std::memory_order_acq_rel)))
+            break;
+    }
+    if (record == nullptr)
+    {
+        record = configuration_.create_();
+        record->inUse_.store(true, std::memory_order_relaxed);
+        record->next_ = records_.load(std::memory_order_relaxed);
+        while (!records_.compare_exchange_weak(record->next_, record, std::memory_order_release, std::memory_order_relaxed))
+            ;
+        ++recordCount_;
+    }
+    detail::thread_registration::add(id_, record);
+    return *record;
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+void bcpp::system::thread_registry<R, N>::unregister_thread
+(
+)
+{
+    if (auto * record = detail::thread_registration::remove(id_); record != nullptr)
+        release(*static_cast<R *>(record));
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+void bcpp::system::thread_registry<R, N>::release
+(
+    // hand the thread's retired nodes to the other threads and release its record
+    R & record
+)
+{
+    if (!record.retired_.empty())
+    {
+        std::lock_guard lockGuard(orphanMutex_);
+        orphans_.insert(orphans_.end(), record.retired_.begin(), record.retired_.end());
+        hasOrphans_.store(true, std::memory_order_release);
+    }
+    record.retired_ = {};
+    if (configuration_.release_)
+        configuration_.release_(record);
+    record.inUse_.store(false, std::memory_order_release);
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+auto bcpp::system::thread_registry<R, N>::attach
+(
+    thread_pool::thread_configuration threadConfiguration
+) -> thread_pool::thread_configuration
+{
+    return thread_pool::wrap_handlers(std::move(threadConfiguration), [this](){get();}, [this](){unregister_thread();});
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+inline R * bcpp::system::thread_registry<R, N>::front
+(
+) const
+{
+    return records_.load(std::memory_order_acquire);
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+inline std::size_t bcpp::system::thread_registry<R, N>::size
+(
+) const
+{
+    return recordCount_.load(std::memory_order_relaxed);
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+inline bool bcpp::system::thread_registry<R, N>::has_orphans
+(
+) const
+{
+    return hasOrphans_.load(std::memory_order_acquire);
+}
+
+
+//=============================================================================
+template <typename R, typename N>
+template <typename F>
+std::size_t bcpp::system::thread_registry<R, N>::reclaim_orphans
+(
+    // the orphans are reclaimed outside of the lock as deleters may retire nodes too
+    F reclaim
+)
+{
+    if (!has_orphans())
+        return 0;
+    std::vector<N> orphans;
+    {
+        std::lock_guard lockGuard(orphanMutex_);
+        std::swap(orphans, orphans_);
+        hasOrphans_.store(false, std::memory_order_relaxed);
+    }
+    auto reclaimed = reclaim(orphans);
+    if (!orphans.empty())
+    {
+        std::lock_guard lockGuard(orphanMutex_);
+        orphans_.insert(orphans_.end(), orphans.begin(), orphans.end());
+        hasOrphans_.store(true, std::memory_order_release);
+    }
+    return reclaimed;
+}
@@ -0,0 +1,242 @@
+#include "./tsc_clock.h"
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+#endif
+
+#include <pthread.h>
+
+
+bcpp::system::tsc_clock::state bcpp::system::tsc_clock::state_;
+
+
+namespace
+{
+
+    struct sample
+    {
+        std::uint64_t   tsc_;
+        std::int64_t    nanoseconds_;
+    };
+
+
+    //=========================================================================
+    sample take_sample
+    (
+        // pair a tsc reading with a CLOCK_MONOTONIC reading.  the narrowest
+        // of several attempts is used to minimize the effect of preemption.
+    )
+    {
+        sample result{};
+        auto narrowest = std::numeric_limits<std::uint64_t>::max();
+        for (auto i = 0; i < 16; ++i)
+        {
+            auto before = bcpp::system::tsc_clock::ticks();
+            auto nanoseconds = bcpp::system::tsc_clock::read_clock(CLOCK_MONOTONIC);
+            auto after = bcpp::system::tsc_clock::ticks();
+            if ((after - before) < narrowest)
+            {
+                narrowest = (after - before);
+                result = {before + ((after - before) / 2), nanoseconds};
+            }
+        }
+        return result;
+    }
+
+
+    //=========================================================================
+    struct calibrator
+    {
+        std::mutex                      mutex_;
+        sample                          origin_{};
+        std::chrono::nanoseconds        interval_{bcpp::system::tsc_clock::default_resynchronization_interval};
+        std::condition_variable_any     conditionVariable_;
+        std::jthread                    thread_;
+    };
+
+    calibrator & get_calibrator()
+    {
+        static calibrator instance;
+        return instance;
+    }
+
+} // namespace
+
+
+//=============================================================================
+std::int64_t bcpp::system::tsc_clock::read_clock
+(
+    clockid_t clockId
+) noexcept
+{
+    timespec ts;
+    ::clock_gettime(clockId, &ts);
+    return ((static_cast<std::int64_t>(ts.tv_sec) * 1'000'000'000) + ts.tv_nsec);
+}
+
+
+//=============================================================================
+bool bcpp::system::tsc_clock::is_invariant
+(
+)
+{
+    #if defined(__x86_64__) || defined(__i386__)
+        std::uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) && (eax >= 0x80000007))
+            if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+                return ((edx & (1 << 8)) != 0);
+    #endif
+    return false;
+}
+
+
+//=============================================================================
+void bcpp::system::tsc_clock::initialize
+(
+    // first calibration.  measures the tick rate over a short interval
+    // and anchors the clock to CLOCK_REALTIME
+) noexcept
+{
+    auto & calibrator = get_calibrator();
+    {
+        std::lock_guard lockGuard(calibrator.mutex_);
+        if (state_.sequence_.load(std::memory_order_acquire) != 0)
+            return;
+
+        auto realtimeOffset = read_clock(CLOCK_REALTIME) - read_clock(CLOCK_MONOTONIC);
+        auto origin = take_sample();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        auto current = take_sample();
+        auto nanosecondsPerTick = static_cast<double>(current.nanoseconds_ - origin.nanoseconds_) / (current.tsc_ - origin.tsc_);
+
+        calibrator.origin_ = origin;
+        state_.tscBase_.store(origin.tsc_, std::memory_order_relaxed);
+        state_.nanosecondBase_.store(origin.nanoseconds_ + realtimeOffset, std::memory_order_relaxed);
+        state_.multiplier_.store(static_cast<std::uint64_t>(nanosecondsPerTick * (1ull << 32)), std::memory_order_relaxed);
+        state_.realtimeOffset_.store(realtimeOffset, std::memory_order_relaxed);
+        state_.invariant_.store(is_invariant(), std::memory_order_relaxed);
+        state_.sequence_.store(2, std::memory_order_release);
+    }
+    if (state_.invariant_.load(std::memory_order_relaxed))
+    {
+        try
+        {
+            start_resynchronization(calibrator.interval_);
+        }
+        catch (...)
+        {
+            // calibrated but not refined (ie: the thread could not be created)
+        }
+    }
+}
+
+
+//=============================================================================
+void bcpp::system::tsc_clock::resynchronize
+(
+    // re-measure the tick rate against CLOCK_MONOTONIC and slew the clock
+    // so that it converges on CLOCK_MONOTONIC over the next interval.  the
+    // new calibration starts where the old one currently is so that the
+    // clock never steps backwards.
+)
+{
+    if (state_.sequence_.load(std::memory_order_acquire) == 0)
+        initialize();
+
+    auto & calibrator = get_calibrator();
+    std::lock_guard lockGuard(calibrator.mutex_);
+
+    auto current = take_sample();
+    auto const & origin = calibrator.origin_;
+    if (current.tsc_ <= origin.tsc_)
+        return;
+
+    auto nanosecondsPerTick = static_cast<double>(current.nanoseconds_ - origin.nanoseconds_) / (current.tsc_ - origin.tsc_);
+    auto target = current.nanoseconds_ + state_.realtimeOffset_.load(std::memory_order_relaxed);
+    auto predicted = from_ticks(current.tsc_).time_since_epoch().count();
+    auto error = target - predicted;
+    auto interval = std::max<std::int64_t>(calibrator.interval_.count(), 1'000'000);
+
+    if (error > interval)
+    {
+        // too far behind to slew (suspend, large clock adjustment) - step forward
+        predicted = target;
+        error = 0;
+    }
+    auto correction = std::clamp(static_cast<double>(error) / interval, -0.5, 0.5);
+    auto multiplier = static_cast<std::uint64_t>(nanosecondsPerTick * (1.0 + correction) * (1ull << 32));
+
+    auto sequence = state_.sequence_.load(std::memory_order_relaxed);
+    state_.sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    state_.tscBase_.store(current.tsc_, std::memory_order_relaxed);
+    state_.nanosecondBase_.store(predicted, std::memory_order_relaxed);
+    state_.multiplier_.store(multiplier, std::memory_order_relaxed);
+    state_.sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+
+//=============================================================================
+double bcpp::system::tsc_clock::ticks_per_nanosecond
+(
+)
+{
+    if (state_.sequence_.load(std::memory_order_acquire) == 0)
+        initialize();
+    return (static_cast<double>(1ull << 32) / state_.multiplier_.load(std::memory_order_relaxed));
+}
+
+
+//=============================================================================
+void bcpp::system::tsc_clock::start_resynchronization
+(
+    std::chrono::nanoseconds interval
+)
+{
+    stop_resynchronization();
+    auto & calibrator = get_calibrator();
+    std::lock_guard lockGuard(calibrator.mutex_);
+    calibrator.interval_ = interval;
+    if (interval.count() <= 0)
+        return;
+    calibrator.thread_ = std::jthread([&calibrator, interval]
+            (
+                std::stop_token stopToken
+            )
+            {
+                #ifdef __linux__
+                    ::pthread_setname_np(::pthread_self(), "tsc_clock");
+                #endif
+                std::mutex mutex;
+                std::unique_lock uniqueLock(mutex);
+                while (!calibrator.conditionVariable_.wait_for(uniqueLock, stopToken, interval, [](){return false;}))
+                {
+                    if (stopToken.stop_requested())
+                        break;
+                    resynchronize();
+                }
+            });
+}
+
+
+//=============================================================================
+void bcpp::system::tsc_clock::stop_resynchronization
+(
+)
+{
+    auto & calibrator = get_calibrator();
+    std::jthread thread;
+    {
+        std::lock_guard lockGuard(calibrator.mutex_);
+        thread = std::move(calibrator.thread_);
+    }
+    thread.request_stop();
+    if (thread.joinable())
+        thread.join();
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+#include <ratio>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+#include <time.h>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // tsc_clock
+    //
+    // a std::chrono compatible clock which reads the time stamp counter and
+    // converts ticks to nanoseconds since the CLOCK_REALTIME epoch using a
+    // calibration taken against CLOCK_MONOTONIC.  the calibration is refined
+    // periodically by a background thread without ever moving the clock
+    // backwards.  time points are comparable across threads and across
+    // processes on the same host.  if the cpu does not have an invariant tsc
+    // the clock falls back to clock_gettime.
+    //
+    // the clock is calibrated (which takes ~10ms) on first use.  call
+    // initialize() beforehand (ie: at the start of main()) to keep that
+    // cost off the hot path.
+    //=========================================================================
+    class tsc_clock
+    {
+    public:
+
+        using rep = std::int64_t;
+        using period = std::nano;
+        using duration = std::chrono::duration<rep, period>;
+        using time_point = std::chrono::time_point<tsc_clock>;
+
+        static bool constexpr is_steady = true;
+
+        static auto constexpr default_resynchronization_interval = std::chrono::seconds(1);
+
+        static time_point now() noexcept;
+
+        static std::uint64_t ticks() noexcept;
+
+        static time_point from_ticks
+        (
+            std::uint64_t
+        ) noexcept;
+
+        static std::chrono::system_clock::time_point to_system_clock
+        (
+            time_point
+        ) noexcept;
+
+        static bool is_invariant();
+
+        // calibrate the clock if it is not already.  blocks for the
+        // calibration interval and starts the resynchronization thread (the
+        // clock is still calibrated, just not refined, if it can not start)
+        static void initialize() noexcept;
+
+        // clock_gettime in nanoseconds
+        static std::int64_t read_clock
+        (
+            clockid_t
+        ) noexcept;
+
+        static double ticks_per_nanosecond();
+
+        static void resynchronize();
+
+        static void start_resynchronization
+        (
+            std::chrono::nanoseconds = default_resynchronization_interval
+        );
+
+        static void stop_resynchronization();
+
+    private:
+
+        struct alignas(64) state
+        {
+            // seqlock protected calibration. sequence_ is zero until the first
+            // calibration, odd while a writer is updating the calibration.
+            std::atomic<std::uint64_t>  sequence_{0};
+            std::atomic<std::uint64_t>  tscBase_{0};
+            std::atomic<std::int64_t>   nanosecondBase_{0};
+            std::atomic<std::uint64_t>  multiplier_{0};     // nanoseconds per tick (32.32 fixed point)
+            std::atomic<std::int64_t>   realtimeOffset_{0}; // CLOCK_REALTIME - CLOCK_MONOTONIC at calibration
+            std::atomic<bool>           invariant_{false};
+        };
+
+        static state state_;
+    }; // class tsc_clock
+
+} // namespace bcpp::system
+
+
+//=============================================================================
+inline std::uint64_t bcpp::system::tsc_clock::ticks
+(
+) noexcept
+{
+    #if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+    #else
+        return static_cast<std::uint64_t>(read_clock(CLOCK_MONOTONIC));
+    #endif
+}
+
+
+//=============================================================================
+inline auto bcpp::system::tsc_clock::from_ticks
+(
+    std::uint64_t ticks
+) noexcept -> time_point
+{
+    while (true)
+    {
+        auto sequence = state_.sequence_.load(std::memory_order_acquire);
+        if (sequence == 0) [[unlikely]]
+        {
+            initialize();
+            continue;
+        }
+        if (sequence & 1)
+            continue;
+        auto tscBase = state_.tscBase_.load(std::memory_order_relaxed);
+        auto nanosecondBase = state_.nanosecondBase_.load(std::memory_order_relaxed);
+        auto multiplier = state_.multiplier_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (state_.sequence_.load(std::memory_order_relaxed) != sequence)
+            continue;
+        // ticks taken before the current base (by another thread) convert backwards
+        auto delta = static_cast<std::int64_t>(ticks - tscBase);
+        auto magnitude = static_cast<unsigned __int128>(delta < 0 ? -delta : delta);
+        auto nanoseconds = static_cast<std::int64_t>((magnitude * multiplier) >> 32);
+        return time_point(duration(nanosecondBase + ((delta < 0) ? -nanoseconds : nanoseconds)));
+    }
+}
+
+
+//=============================================================================
+inline auto bcpp::system::tsc_clock::now
+(
+) noexcept -> time_point
+{
+    if (!state_.invariant_.load(std::memory_order_relaxed)) [[unlikely]]
+    {
+        if (state_.sequence_.load(std::memory_order_acquire) == 0)
+            initialize();
+        if (!state_.invariant_.load(std::memory_order_relaxed))
+            return time_point(duration(read_clock(CLOCK_MONOTONIC) + state_.realtimeOffset_.load(std::memory_order_relaxed)));
+    }
+    return from_ticks(ticks());
+}
+
+
+//=============================================================================
+inline auto bcpp::system::tsc_clock::to_system_clock
+(
+    time_point timePoint
+) noexcept -> std::chrono::system_clock::time_point
+{
+    return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(timePoint.time_since_epoch()));
+}
@@ -0,0 +1,296 @@
+#include "./cpu_topology.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+
+namespace
+{
+
+    //=========================================================================
+    std::string read_line
+    (
+        std::filesystem::path const & path
+    )
+    {
+        std::string line;
+        if (std::ifstream stream(path); stream)
+            std::getline(stream, line);
+        return line;
+    }
+
+
+    //=========================================================================
+    std::int64_t read_integer
+    (
+        std::filesystem::path const & path,
+        std::int64_t defaultValue
+    )
+    {
+        auto line = read_line(path);
+        try
+        {
+            return line.empty() ? defaultValue : std::stoll(line);
+        }
+        catch (...)
+        {
+            return defaultValue;
+        }
+    }
+
+
+    //=========================================================================
+    std::size_t parse_size
+    (
+        // sysfs cache sizes are of the form "48K", "2048K", "32M"
+        std::string const & value
+    )
+    {
+        if (value.empty())
+            return 0;
+        std::size_t multiplier = 1;
+        switch (value.back())
+        {
+            case 'K': multiplier = (1ull << 10); break;
+            case 'M': multiplier = (1ull << 20); break;
+            case 'G': multiplier = (1ull << 30); break;
+            default: break;
+        }
+        try
+        {
+            return std::stoull(value) * multiplier;
+        }
+        catch (...)
+        {
+            return 0;
+        }
+    }
+
+} // namespace
+
+
+//=============================================================================
+auto bcpp::system::cpu_topology::get
+(
+) -> cpu_topology const &
+{
+    static cpu_topology const instance;
+    return instance;
+}
+
+
+//=============================================================================
+bcpp::system::cpu_topology::cpu_topology
+(
+)
+{
+    std::filesystem::path const cpuRoot("/sys/devices/system/cpu");
+    auto onlineCpus = parse_cpu_list(read_line(cpuRoot / "online"));
+    if (onlineCpus.empty())
+        for (cpu_id i = 0; i < static_cast<cpu_id>(::sysconf(_SC_NPROCESSORS_ONLN)); ++i)
+            onlineCpus.push_back(i);
+
+    std::int32_t maxNumaNode = 0;
+    for (auto cpuId : onlineCpus)
+    {
+        auto cpuPath = cpuRoot / ("cpu" + std::to_string(cpuId));
+        cpu entry{.cpuId_ = cpuId};
+        entry.coreId_ = static_cast<std::int32_t>(read_integer(cpuPath / "topology" / "core_id", -1));
+        entry.packageId_ = static_cast<std::int32_t>(read_integer(cpuPath / "topology" / "physical_package_id", -1));
+        entry.threadSiblings_ = parse_cpu_list(read_line(cpuPath / "topology" / "thread_siblings_list"));
+
+        std::error_code errorCode;
+        for (auto const & directoryEntry : std::filesystem::directory_iterator(cpuPath, errorCode))
+        {
+            auto name = directoryEntry.path().filename().string();
+            if (name.starts_with("node"))
+            {
+                try
+                {
+                    entry.numaNode_ = std::stoi(name.substr(4));
+                }
+                catch (...)
+                {
+                }
+            }
+        }
+        maxNumaNode = std::max(maxNumaNode, entry.numaNode_);
+
+        for (auto index = 0; ; ++index)
+        {
+            auto cachePath = cpuPath / "cache" / ("index" + std::to_string(index));
+            if (!std::filesystem::exists(cachePath, errorCode))
+                break;
+            auto type = read_line(cachePath / "type");
+            entry.caches_.push_back(
+                    {
+                        .level_ = static_cast<std::uint32_t>(read_integer(cachePath / "level", 0)),
+                        .type_ = (type == "Data") ? cache::cache_type::data :
+                                (type == "Instruction") ? cache::cache_type::instruction : cache::cache_type::unified,
+                        .size_ = parse_size(read_line(cachePath / "size")),
+                        .lineSize_ = static_cast<std::size_t>(read_integer(cachePath / "coherency_line_size", 64)),
+                        .sharedCpus_ = parse_cpu_list(read_line(cachePath / "shared_cpu_list"))
+                    });
+        }
+        cpus_.push_back(std::move(entry));
+    }
+    numaNodeCount_ = static_cast<std::size_t>(maxNumaNode) + 1;
+    isolatedCpus_ = parse_cpu_list(read_line(cpuRoot / "isolated"));
+    nohzFullCpus_ = parse_cpu_list(read_line(cpuRoot / "nohz_full"));
+}
+
+
+//=============================================================================
+auto bcpp::system::cpu_topology::parse_cpu_list
+(
+    // parse sysfs cpu list format.  ie: "0-3,8,10-11"
+    std::string const & cpuList
+) -> std::vector<cpu_id>
+{
+    std::vector<cpu_id> result;
+    std::istringstream stream(cpuList);
+    for (std::string range; std::getline(stream, range, ','); )
+    {
+        try
+        {
+            if (auto dash = range.find('-'); dash != std::string::npos)
+            {
+                auto first = std::stoull(range.substr(0, dash));
+                auto last = std::stoull(range.substr(dash + 1));
+                for (auto i = first; i <= last; ++i)
+                    result.push_back(static_cast<cpu_id>(i));
+            }
+            else if (!range.empty())
+            {
+                result.push_back(static_cast<cpu_id>(std::stoull(range)));
+            }
+        }
+        catch (...)
+        {
+        }
+    }
+    return result;
+}
+
+
+//=============================================================================
+auto bcpp::system::cpu_topology::cpus
+(
+) const -> std::vector<cpu> const &
+{
+    return cpus_;
+}
+
+
+//=============================================================================
+auto bcpp::system::cpu_topology::isolated_cpus
+(
+) const -> std::vector<cpu_id> const &
+{
+    return isolatedCpus_;
+}
+
+
+//=============================================================================
+auto bcpp::system::cpu_topology::nohz_full_cpus
+(
+) const -> std::vector<cpu_id> const &
+{
+    return nohzFullCpus_;
+}
+
+
+//=============================================================================
+auto bcpp::system::cpu_topology::find
+(
+    cpu_id cpuId
+) const -> cpu const *
+{
+    auto iter = std::find_if(cpus_.begin(), cpus_.end(), [cpuId](auto const & entry){return (entry.cpuId_ == cpuId);});
+    return (iter == cpus_.end()) ? nullptr : &*iter;
+}
+
+
+//=============================================================================
+std::int32_t bcpp::system::cpu_topology::numa_node
+(
+    cpu_id cpuId
+) const
+{
+    auto entry = find(cpuId);
+    return (entry == nullptr) ? 0 : entry->numaNode_;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::cpu_topology::numa_node_count
+(
+) const
+{
+    return numaNodeCount_;
+}
+
+
+//=============================================================================
+auto bcpp::system::cpu_topology::cpus_on_numa_node
+(
+    std::int32_t numaNode
+) const -> std::vector<cpu_id>
+{
+    std::vector<cpu_id> result;
+    for (auto const & entry : cpus_)
+        if (entry.numaNode_ == numaNode)
+            result.push_back(entry.cpuId_);
+    return result;
+}
+
+
+//=============================================================================
+std::size_t bcpp::system::cpu_topology::cache_size
+(
+    // size of the data (or unified) cache at the given level as seen by the
+    // cpu (or by the first cpu if none specified).  zero if unknown.
+    std::uint32_t level,
+    std::optional<cpu_id> cpuId
+) const
+{
+    auto entry = cpuId.has_value() ? find(*cpuId) : (cpus_.empty() ? nullptr : &cpus_.front());
+    if (entry != nullptr)
+        for (auto const & cache : entry->caches_)
+            if ((cache.level_ == level) && (cache.type_ != cache::cache_type::instruction))
+                return cache.size_;
+    return 0;
+}
+
+
+//=============================================================================
+bool bcpp::system::cpu_topology::are_thread_siblings
+(
+    cpu_id first,
+    cpu_id second
+) const
+{
+    auto entry = find(first);
+    return ((first != second) && (entry != nullptr) &&
+            (std::find(entry->threadSiblings_.begin(), entry->threadSiblings_.end(), second) != entry->threadSiblings_.end()));
+}
+
+
+//=============================================================================
+bool bcpp::system::cpu_topology::share_cache
+(
+    cpu_id first,
+    cpu_id second,
+    std::uint32_t level
+) const
+{
+    if (auto entry = find(first); entry != nullptr)
+        for (auto const & cache : entry->caches_)
+            if ((cache.level_ == level) && (cache.type_ != cache::cache_type::instruction))
+                return (std::find(cache.sharedCpus_.begin(), cache.sharedCpus_.end(), second) != cache.sharedCpus_.end());
+    return false;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <library/system/cpu_id.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace bcpp::system
+{
+
+    //=========================================================================
+    // cpu_topology
+    //
+    // snapshot of the cpu, cache and numa layout read from sysfs once per
+    // process.
+    //=========================================================================
+    class cpu_topology
+    {
+    public:
+
+        struct cache
+        {
+            enum class cache_type
+            {
+                data,
+                instruction,
+                unified
+            };
+
+            std::uint32_t           level_;
+            cache_type              type_;
+            std::size_t             size_;
+            std::size_t             lineSize_;
+            std::vector<cpu_id>     sharedCpus_;
+        };
+
+        struct cpu
+        {
+            cpu_id                  cpuId_;
+            std::int32_t            coreId_{-1};
+            std::int32_t            packageId_{-1};
+            std::int32_t            numaNode_{0};
+            std::vector<cpu_id>     threadSiblings_;
+            std::vector<cache>      caches_;
+        };
+
+        static cpu_topology const & get();
+
+        std::vector<cpu> const & cpus() const;
+
+        cpu const * find
+        (
+            cpu_id
+        ) const;
+
+        std::int32_t numa_node
+        (
+            cpu_id
+        ) const;
+
+        std::size_t numa_node_count() const;
+
+        std::vector<cpu_id> cpus_on_numa_node
+        (
+            std::int32_t
+        ) const;
+
+        std::size_t cache_size
+        (
+            std::uint32_t,
+            std::optional<cpu_id> = std::nullopt
+        ) const;
+
+        bool are_thread_siblings
+        (
+            cpu_id,
+            cpu_id
+        ) const;
+
+        bool share_cache
+        (
+            cpu_id,
+            cpu_id,
+            std::uint32_t
+        ) const;
+
+        std::vector<cpu_id> const & isolated_cpus() const;
+
+        std::vector<cpu_id> const & nohz_full_cpus() const;
+
+        static std::vector<cpu_id> parse_cpu_list
+        (
+            std::string const &
+        );
+
+    private:
+
+        cpu_topology();
+
+        std::vector<cpu>        cpus_;
+
+        std::size_t             numaNodeCount_{1};
+
+        std::vector<cpu_id>     isolatedCpus_;      // isolcpus= kernel parameter
+
+        std::vector<cpu_id>     nohzFullCpus_;      // nohz_full= kernel parameter
+
+    }; // class cpu_topology
+
+} // namespace bcpp::system